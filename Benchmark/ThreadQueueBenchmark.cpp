@@ -0,0 +1,162 @@
+// Thread message queue contention benchmark. Producer threads post delegates to a
+// single consumer thread, the same as many threads generating external events for one
+// AsyncStateMachine. Each queue mode is measured with an increasing producer count. The
+// queue is bounded so every mode, including QueueMode::RING, runs with the same limit;
+// producers wait for space when the consumer falls behind. The MUTEX and RING modes are
+// also measured draining up to DRAIN_BATCH_SIZE messages per lock acquisition. Last, the
+// handoff latency to an idle thread is measured for each wait strategy.
+//
+// Usage: ThreadQueueBenchmark [messages per producer]
+
+#include "DelegateMQ.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+using namespace dmq;
+using namespace dmq::os;
+using namespace std::chrono;
+
+static std::atomic<size_t> g_received(0);
+
+static const size_t MAX_QUEUE_SIZE = 1024;
+static const size_t DRAIN_BATCH_SIZE = 32;
+
+static void Receive(int)
+{
+    g_received.fetch_add(1, std::memory_order_relaxed);
+}
+
+static std::atomic<int64_t> g_latencyNs(-1);
+
+static int64_t NowNs()
+{
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void Stamp(int64_t postedNs)
+{
+    g_latencyNs.store(NowNs() - postedNs);
+}
+
+/// Post single messages to an idle consumer thread, pausing between messages so the
+/// consumer runs out of work each time.
+/// @return The median latency from post to execution in microseconds.
+static double Handoff(QueueMode mode, size_t spinCount, size_t yieldCount, int samples)
+{
+    Thread consumer("Consumer", MAX_QUEUE_SIZE, FullPolicy::TIMEOUT, std::chrono::seconds(10), "", mode);
+    consumer.SetWaitStrategy(spinCount, yieldCount);
+    consumer.CreateThread();
+    auto delegate = MakeDelegate(&Stamp, consumer);
+
+    std::vector<int64_t> latencies;
+    for (int i = 0; i < samples; i++)
+    {
+        std::this_thread::sleep_for(microseconds(200));
+        g_latencyNs = -1;
+        delegate(NowNs());
+        int64_t latency;
+        while ((latency = g_latencyNs.load()) < 0)
+            std::this_thread::yield();
+        latencies.push_back(latency);
+    }
+
+    consumer.ExitThread();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[latencies.size() / 2] / 1000.0;
+}
+
+/// Post messages from producer threads to one consumer thread.
+/// @param[out] batchStats - receives the consumer batch statistics, if not null.
+/// @return The total throughput in messages per second.
+static double Run(QueueMode mode, size_t maxBatchSize, int producers, size_t messages, 
+    Thread::BatchStats* batchStats = nullptr)
+{
+    Thread consumer("Consumer", MAX_QUEUE_SIZE, FullPolicy::TIMEOUT, std::chrono::seconds(10), "", mode);
+    consumer.SetMaxBatchSize(maxBatchSize);
+    consumer.CreateThread();
+    g_received = 0;
+
+    const size_t total = producers * messages;
+    std::atomic<int> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&]() {
+            auto delegate = MakeDelegate(&Receive, consumer);
+            ready++;
+            while (!start.load())
+                std::this_thread::yield();
+            for (size_t i = 0; i < messages; i++)
+                delegate(0);
+        });
+    }
+    while (ready.load() < producers)
+        std::this_thread::yield();
+
+    auto begin = steady_clock::now();
+    start = true;
+    for (auto& thread : threads)
+        thread.join();
+    while (g_received.load() < total)
+        std::this_thread::yield();
+    auto end = steady_clock::now();
+
+    consumer.ExitThread();
+    if (batchStats)
+        *batchStats = consumer.GetBatchStats();
+    return total / duration<double>(end - begin).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t messages = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    const int producerCounts[] = { 1, 2, 4, 8, 16 };
+
+    printf("%zu messages per producer, %u hardware threads\n", messages, std::thread::hardware_concurrency());
+    printf("%10s %14s %14s %14s %14s %14s %10s\n", "producers", "MUTEX", "MUTEX batch", 
+        "LOCK_FREE", "RING", "RING batch", "avg batch");
+    Thread::BatchStats busiest = {};
+    for (int producers : producerCounts)
+    {
+        Thread::BatchStats stats;
+        double locked = Run(QueueMode::MUTEX, 1, producers, messages);
+        double lockedBatch = Run(QueueMode::MUTEX, DRAIN_BATCH_SIZE, producers, messages, &stats);
+        double lockFree = Run(QueueMode::LOCK_FREE, 1, producers, messages);
+        double ring = Run(QueueMode::RING, 1, producers, messages);
+        double ringBatch = Run(QueueMode::RING, DRAIN_BATCH_SIZE, producers, messages);
+        printf("%10d %14.0f %14.0f %14.0f %14.0f %14.0f %10.2f\n", producers, locked, lockedBatch, 
+            lockFree, ring, ringBatch, stats.batches ? double(stats.messages) / stats.batches : 0.0);
+        busiest = stats;
+    }
+    printf("(msg/s; batch columns drain up to %zu messages per lock)\n", DRAIN_BATCH_SIZE);
+
+    // Batch size distribution of the MUTEX batch run with the most producers
+    printf("\nMUTEX batch size distribution, %d producers (largest %zu):\n", 
+        producerCounts[sizeof(producerCounts) / sizeof(producerCounts[0]) - 1], busiest.maxBatch);
+    for (size_t i = 0; i < Thread::BatchStats::BUCKETS; i++)
+    {
+        if (busiest.histogram[i] > 0)
+            printf("%6zu-%-6zu %10llu batches\n", size_t(1) << i, (size_t(2) << i) - 1, 
+                (unsigned long long)busiest.histogram[i]);
+    }
+
+    // Handoff latency to an idle thread
+    printf("\nIdle handoff latency, median us:\n");
+    printf("%10s %14s %14s %14s\n", "mode", "park", "yield", "spin");
+    const QueueMode modes[] = { QueueMode::MUTEX, QueueMode::LOCK_FREE, QueueMode::RING };
+    const char* modeNames[] = { "MUTEX", "LOCK_FREE", "RING" };
+    for (int m = 0; m < 3; m++)
+    {
+        double park = Handoff(modes[m], 0, 0, 1000);
+        double yield = Handoff(modes[m], 0, 1000000, 1000);
+        double spin = Handoff(modes[m], 10000000, 0, 1000);
+        printf("%10s %14.2f %14.2f %14.2f\n", modeNames[m], park, yield, spin);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Coroutine state example. The Centrifuge accelerating state runs a coroutine that 
+// ramps the speed using co_await Delay() instead of a polling state timeout, then 
+// waits for the EV_STOP event using co_await WaitEvent(). Built only when the 
+// compiler supports C++20.
+//
+// Usage: CoroutineExample
+
+#include "AsyncStateMachine.h"
+#include "StateCoroutine.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+class Centrifuge : public AsyncStateMachine
+{
+public:
+    enum Events
+    {
+        EV_START,
+        EV_STOP,
+        EV_MAX_EVENTS
+    };
+
+    Centrifuge() : AsyncStateMachine(ST_MAX_STATES)
+    {
+        CreateThread("Centrifuge");
+
+        // Coroutine delays and events are delivered through the event queue
+        CreateEventQueue(8);
+    }
+
+    std::atomic<bool> Stopped{false};
+
+private:
+    INT m_speed = 0;
+
+    enum States
+    {
+        ST_IDLE,
+        ST_ACCELERATE,
+        ST_STOPPED,
+        ST_MAX_STATES
+    };
+
+    /// Ramp up to speed, then run until EV_STOP
+    StateTask Accelerate();
+
+    STATE_DECLARE(Centrifuge, Idle, NoEventData)
+    STATE_DECLARE(Centrifuge, AccelerateState, NoEventData)
+    STATE_DECLARE(Centrifuge, StoppedState, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&AccelerateState)
+        STATE_MAP_ENTRY(&StoppedState)
+    END_STATE_MAP
+
+    BEGIN_EVENT_MAP
+        EVENT_MAP_ROW(EV_START)                             // - Current State -
+            TRANSITION_MAP_ENTRY(ST_ACCELERATE)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_ACCELERATE
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_STOPPED
+        EVENT_MAP_ROW(EV_STOP)
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_STOPPED)                // ST_ACCELERATE
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_STOPPED
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+STATE_DEFINE(Centrifuge, Idle, NoEventData)
+{
+    cout << "Centrifuge::ST_Idle" << endl;
+}
+
+STATE_DEFINE(Centrifuge, AccelerateState, NoEventData)
+{
+    cout << "Centrifuge::ST_Accelerate" << endl;
+
+    // The coroutine runs after the state action returns
+    Accelerate();
+}
+
+STATE_DEFINE(Centrifuge, StoppedState, NoEventData)
+{
+    cout << "Centrifuge::ST_Stopped : Speed is " << m_speed << endl;
+    Stopped = true;
+}
+
+StateTask Centrifuge::Accelerate()
+{
+    while (m_speed < 5)
+    {
+        co_await Delay(10);
+        cout << "Centrifuge::Accelerate : Speed is " << ++m_speed << endl;
+    }
+
+    // At speed. The coroutine consumes EV_STOP ahead of the event map.
+    co_await WaitEvent(EV_STOP);
+    m_speed = 0;
+    ExternalEvent(ST_STOPPED);
+}
+
+int main(void)
+{
+    std::atomic<bool> exitTimers(false);
+    std::thread timerThread([&exitTimers]() {
+        while (!exitTimers.load())
+        {
+            StateTimerWheel::ProcessTimers();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    Centrifuge centrifuge;
+    centrifuge.PostEvent(Centrifuge::EV_START);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    centrifuge.PostEvent(Centrifuge::EV_STOP);
+
+    for (int i = 0; i < 100 && !centrifuge.Stopped; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    exitTimers.store(true);
+    timerThread.join();
+    return centrifuge.Stopped ? 0 : 1;
+}
@@ -123,6 +123,10 @@
 #if defined(DMQ_THREAD_STDLIB)
     #include "port/os/stdlib/Thread.h"
     #include "port/os/stdlib/ThreadMsg.h"
+    #include "port/os/stdlib/ThreadPool.h"
+    #if defined(__linux__)
+        #include "port/os/linux/LinuxThread.h"
+    #endif
 #elif defined(DMQ_THREAD_WIN32)
     #include "port/os/win32/Thread.h"
     #include "port/os/win32/ThreadMsg.h"
@@ -6,6 +6,14 @@ if (DMQ_THREAD STREQUAL "DMQ_THREAD_STDLIB")
         "${DMQ_ROOT_DIR}/port/os/stdlib/*.c*" 
         "${DMQ_ROOT_DIR}/port/os/stdlib/*.h" 
     )
+    if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+        # Native Linux thread with affinity and realtime priority
+        file(GLOB LINUX_THREAD_SOURCES CONFIGURE_DEPENDS
+            "${DMQ_ROOT_DIR}/port/os/linux/*.c*"
+            "${DMQ_ROOT_DIR}/port/os/linux/*.h"
+        )
+        list(APPEND THREAD_SOURCES ${LINUX_THREAD_SOURCES})
+    endif()
 elseif (DMQ_THREAD STREQUAL "DMQ_THREAD_WIN32")
     add_compile_definitions(DMQ_THREAD_WIN32)
     file(GLOB THREAD_SOURCES CONFIGURE_DEPENDS
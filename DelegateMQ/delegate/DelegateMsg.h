@@ -7,18 +7,36 @@
 #include "IInvoker.h"
 #include "DelegateOpt.h"
 #include "make_tuple_heap.h"
+#include <cstddef>
 #include <tuple>
 #include <memory>
 
 namespace dmq {
 
-// Async delegate message priority
+// Async delegate message priority, lowest to highest. The stdlib Thread and 
+// LinuxThread queue each level separately. Other ports treat HIGH and above as 
+// high priority and the lower levels as normal priority. NORMAL and HIGH keep their
+// original values, 0 and 1, for code that stores or compares the underlying value.
 enum class Priority
 {
-	NORMAL,
-	HIGH
+	LOWEST = -2,
+	LOW = -1,
+	NORMAL = 0,
+	HIGH = 1,
+	HIGHEST = 2
 };
 
+/// The number of Priority levels
+constexpr size_t PRIORITY_LEVELS = 5;
+
+/// Get a priority as a level index, 0 (LOWEST) to PRIORITY_LEVELS - 1 (HIGHEST).
+constexpr size_t GetPriorityLevel(Priority priority)
+{
+	return static_cast<size_t>(static_cast<int>(priority) - static_cast<int>(Priority::LOWEST));
+}
+
+static_assert(GetPriorityLevel(Priority::HIGHEST) == PRIORITY_LEVELS - 1, "Priority levels must be contiguous.");
+
 /// @brief Base class for all delegate inter-thread messages
 class DelegateMsg
 {
@@ -38,6 +38,41 @@ public:
 	/// @return true if the message was successfully enqueued, false otherwise.
 	virtual bool DispatchDelegate(std::shared_ptr<DelegateMsg> msg) = 0;
 
+	/// @brief Enqueues a delegate message without waiting for queue space.
+	///
+	/// @details
+	/// Called by a source thread that must never block, such as a timer thread. A full
+	/// queue returns false immediately instead of applying the queue full policy. The
+	/// default implementation calls `DispatchDelegate()`, which is correct for an
+	/// unbounded queue; an implementation with a bounded queue must override.
+	///
+	/// @param[in] msg A shared pointer to the delegate message.
+	/// @return true if the message was enqueued, false otherwise.
+	virtual bool TryDispatchDelegate(std::shared_ptr<DelegateMsg> msg)
+	{
+		return DispatchDelegate(msg);
+	}
+
+	/// @brief Enqueues a batch of delegate messages for execution on this thread.
+	///
+	/// @details
+	/// Called by the *source* thread when many messages are ready at once. Messages are
+	/// enqueued in order. The default implementation calls `DispatchDelegate()` for each
+	/// message; an implementation may override to enqueue the whole batch using one lock
+	/// acquisition and one consumer wakeup.
+	///
+	/// @param[in] msgs The delegate messages.
+	/// @param[in] count The number of messages.
+	/// @return The number of messages enqueued. Enqueuing stops at the first message
+	/// not enqueued.
+	virtual size_t DispatchDelegates(const std::shared_ptr<DelegateMsg>* msgs, size_t count)
+	{
+		size_t dispatched = 0;
+		while (dispatched < count && DispatchDelegate(msgs[dispatched]))
+			dispatched++;
+		return dispatched;
+	}
+
 	/// @brief Returns true if the calling thread is this thread.
 	/// Used to decide whether to marshal an event or execute inline.
 	virtual bool IsCurrentThread() = 0;
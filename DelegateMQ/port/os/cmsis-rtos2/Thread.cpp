@@ -261,7 +261,7 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
         timeout = 0;  // DROP and FAULT: non-blocking
 
     // Option #2: Implement High priority using msg_prio.
-    uint8_t msg_prio = (msg->GetPriority() == Priority::HIGH) ? 1 : 0;
+    uint8_t msg_prio = (msg->GetPriority() >= Priority::HIGH) ? 1 : 0;
 
     osStatus_t ret = osMessageQueuePut(m_msgq, &threadMsg, msg_prio, timeout);
     if (ret != osOK)
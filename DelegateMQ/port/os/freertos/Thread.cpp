@@ -277,7 +277,7 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
 
     // High priority uses xQueueSendToFront; all others use FIFO SendToBack.
     BaseType_t status;
-    if (msg->GetPriority() == Priority::HIGH)
+    if (msg->GetPriority() >= Priority::HIGH)
         status = xQueueSendToFront(m_queue, &threadMsg, timeout);
     else
         status = xQueueSendToBack(m_queue, &threadMsg, timeout);
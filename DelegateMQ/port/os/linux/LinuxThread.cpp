@@ -0,0 +1,446 @@
+#ifndef DMQ_THREAD_STDLIB
+#error "port/os/linux/LinuxThread.cpp requires DMQ_THREAD_STDLIB. Remove this file from your build configuration or define DMQ_THREAD_STDLIB."
+#endif
+
+#include "DelegateMQ.h"
+#include "LinuxThread.h"
+#include "extras/util/Fault.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+    "A futex word must be a lock-free 32-bit atomic.");
+
+// Thread-local pointer into Process()'s stack frame. ExitThread() writes true
+// through it when the thread destroys its own owning object. See stdlib Thread.cpp.
+static thread_local bool* t_self_exit = nullptr;
+
+namespace dmq::os {
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+// LinuxThread
+//----------------------------------------------------------------------------
+LinuxThread::LinuxThread(const std::string& threadName, const ThreadAttributes& attributes,
+    size_t maxQueueSize, FullPolicy fullPolicy, dmq::Duration dispatchTimeout)
+    : m_thread()
+    , m_exitMsg(std::make_shared<dmq::DelegateMsg>(nullptr, dmq::Priority::LOWEST))
+    , THREAD_NAME(threadName.c_str())
+    , ATTRIBUTES(attributes)
+    , MAX_QUEUE_SIZE(maxQueueSize)
+    , FULL_POLICY(fullPolicy)
+    , m_dispatchTimeout(dispatchTimeout)
+{
+}
+
+//----------------------------------------------------------------------------
+// ~LinuxThread
+//----------------------------------------------------------------------------
+LinuxThread::~LinuxThread()
+{
+    ExitThread();
+}
+
+//----------------------------------------------------------------------------
+// CreateThread
+//----------------------------------------------------------------------------
+bool LinuxThread::CreateThread()
+{
+    if (m_created)
+        return true;
+
+    pthread_attr_t attr;
+    int err = pthread_attr_init(&attr);
+    if (err != 0)
+    {
+        m_createError = err;
+        return false;
+    }
+
+    if (ATTRIBUTES.stackSize > 0)
+        err = pthread_attr_setstacksize(&attr, std::max<size_t>(ATTRIBUTES.stackSize, PTHREAD_STACK_MIN));
+
+    // Without PTHREAD_EXPLICIT_SCHED the policy is inherited from the creator
+    if (err == 0 && ATTRIBUTES.policy != SCHED_OTHER)
+    {
+        sched_param param{};
+        param.sched_priority = ATTRIBUTES.priority;
+        err = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        if (err == 0)
+            err = pthread_attr_setschedpolicy(&attr, ATTRIBUTES.policy);
+        if (err == 0)
+            err = pthread_attr_setschedparam(&attr, &param);
+    }
+
+    if (err == 0 && !ATTRIBUTES.cpus.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : ATTRIBUTES.cpus)
+        {
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
+            {
+                err = EINVAL;
+                break;
+            }
+            CPU_SET(cpu, &cpus);
+        }
+        if (err == 0)
+            err = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_exit = false;
+    }
+
+    if (err == 0)
+        err = pthread_create(&m_thread, &attr, &LinuxThread::ThreadEntry, this);
+    pthread_attr_destroy(&attr);
+
+    m_createError = err;
+    if (err != 0)
+    {
+        printf("[LinuxThread] ERROR: Cannot create thread '%s': %s\n", THREAD_NAME.c_str(), strerror(err));
+        return false;
+    }
+
+    m_created = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// ExitThread
+//----------------------------------------------------------------------------
+void LinuxThread::ExitThread()
+{
+    if (!m_created)
+        return;
+
+    bool wakeConsumer;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_exit = true;
+
+        // The exit message bypasses MAX_QUEUE_SIZE and queues at LOWEST, so every
+        // message queued before the call is invoked first
+        EnqueueLocked(m_exitMsg);
+        wakeConsumer = TakeConsumerWakeLocked();
+        m_notFullSeq.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (wakeConsumer)
+        FutexWake(m_consumerSeq, 1);
+    FutexWake(m_notFullSeq, INT_MAX);
+
+    if (pthread_equal(m_thread, pthread_self()))
+    {
+        // We are killing ourselves. Detach so the thread cleans up naturally, and
+        // signal Process() to exit without touching 'this' again.
+        pthread_detach(m_thread);
+        if (t_self_exit) *t_self_exit = true;
+    }
+    else
+    {
+        pthread_join(m_thread, nullptr);
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (auto& queue : m_queues)
+            queue.clear();
+    }
+    m_created = false;
+    m_tid.store(0);
+}
+
+//----------------------------------------------------------------------------
+// IsCurrentThread
+//----------------------------------------------------------------------------
+bool LinuxThread::IsCurrentThread()
+{
+    return m_created && pthread_equal(m_thread, pthread_self());
+}
+
+//----------------------------------------------------------------------------
+// GetQueueSize
+//----------------------------------------------------------------------------
+size_t LinuxThread::GetQueueSize()
+{
+    lock_guard<mutex> lock(m_mutex);
+    return QueueSizeLocked();
+}
+
+//----------------------------------------------------------------------------
+// QueueSizeLocked
+//----------------------------------------------------------------------------
+size_t LinuxThread::QueueSizeLocked() const
+{
+    size_t size = 0;
+    for (const auto& queue : m_queues)
+        size += queue.size();
+    return size;
+}
+
+//----------------------------------------------------------------------------
+// DispatchDelegate
+//----------------------------------------------------------------------------
+bool LinuxThread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
+{
+    return Dispatch(msg, true);
+}
+
+//----------------------------------------------------------------------------
+// TryDispatchDelegate
+//----------------------------------------------------------------------------
+bool LinuxThread::TryDispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
+{
+    return Dispatch(msg, false);
+}
+
+//----------------------------------------------------------------------------
+// Dispatch
+//----------------------------------------------------------------------------
+bool LinuxThread::Dispatch(const std::shared_ptr<dmq::DelegateMsg>& msg, bool wait)
+{
+    if (!m_created)
+        throw std::invalid_argument("Thread pointer is null");
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (!WaitNotFull(lk, wait))
+        return false;
+
+    EnqueueLocked(msg);
+    bool wake = TakeConsumerWakeLocked();
+    lk.unlock();
+
+    if (wake)
+        FutexWake(m_consumerSeq, 1);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// DispatchDelegates
+//----------------------------------------------------------------------------
+size_t LinuxThread::DispatchDelegates(const std::shared_ptr<dmq::DelegateMsg>* msgs, size_t count)
+{
+    if (count == 0)
+        return 0;
+
+    if (!m_created)
+        throw std::invalid_argument("Thread pointer is null");
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    size_t dispatched = 0;
+    for (; dispatched < count; dispatched++)
+    {
+        if (!WaitNotFull(lk))
+            break;
+        EnqueueLocked(msgs[dispatched]);
+    }
+
+    // One wakeup for the whole batch
+    bool wake = dispatched > 0 && TakeConsumerWakeLocked();
+    lk.unlock();
+
+    if (wake)
+        FutexWake(m_consumerSeq, 1);
+    return dispatched;
+}
+
+//----------------------------------------------------------------------------
+// WaitNotFull
+//----------------------------------------------------------------------------
+bool LinuxThread::WaitNotFull(std::unique_lock<std::mutex>& lk, bool wait)
+{
+    if (m_exit)
+        return false;
+
+    if (MAX_QUEUE_SIZE == 0 || QueueSizeLocked() < MAX_QUEUE_SIZE)
+        return true;
+
+    if (!wait || FULL_POLICY == FullPolicy::DROP)
+        return false;
+
+    if (FULL_POLICY == FullPolicy::FAULT)
+    {
+        printf("[LinuxThread] CRITICAL: Queue full on thread '%s'! TRIGGERING FAULT.\n", THREAD_NAME.c_str());
+        ASSERT_TRUE(false);
+        return false;
+    }
+
+    // FullPolicy::TIMEOUT
+    auto deadline = std::chrono::steady_clock::now() + m_dispatchTimeout;
+    while (QueueSizeLocked() >= MAX_QUEUE_SIZE && !m_exit)
+    {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+        {
+            printf("[LinuxThread] WARNING: Queue post timed out on '%s' — possible deadlock. Message dropped.\n", THREAD_NAME.c_str());
+            return false;
+        }
+
+        // Let the consumer drain messages this caller already enqueued
+        if (TakeConsumerWakeLocked())
+            FutexWake(m_consumerSeq, 1);
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+        timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+
+        m_producersWaiting++;
+        uint32_t seq = m_notFullSeq.load(std::memory_order_relaxed);
+        lk.unlock();
+        FutexWait(m_notFullSeq, seq, &timeout);
+        lk.lock();
+        m_producersWaiting--;
+    }
+    return !m_exit;
+}
+
+//----------------------------------------------------------------------------
+// EnqueueLocked
+//----------------------------------------------------------------------------
+void LinuxThread::EnqueueLocked(const std::shared_ptr<dmq::DelegateMsg>& msg)
+{
+    m_queues[dmq::GetPriorityLevel(msg ? msg->GetPriority() : dmq::Priority::NORMAL)].push_back(msg);
+}
+
+//----------------------------------------------------------------------------
+// TakeConsumerWakeLocked
+//----------------------------------------------------------------------------
+bool LinuxThread::TakeConsumerWakeLocked()
+{
+    if (!m_consumerWaiting)
+        return false;
+
+    // The consumer read m_consumerSeq under the lock before parking, so the
+    // increment makes its FUTEX_WAIT return even if it has not slept yet
+    m_consumerWaiting = false;
+    m_consumerSeq.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// FutexWait
+//----------------------------------------------------------------------------
+void LinuxThread::FutexWait(std::atomic<uint32_t>& word, uint32_t expected, const struct timespec* timeout)
+{
+    // Returns on a wakeup, a timeout, a signal, or at once if the word changed.
+    // Callers recheck their condition under the lock.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+
+//----------------------------------------------------------------------------
+// FutexWake
+//----------------------------------------------------------------------------
+void LinuxThread::FutexWake(std::atomic<uint32_t>& word, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+//----------------------------------------------------------------------------
+// ThreadEntry
+//----------------------------------------------------------------------------
+void* LinuxThread::ThreadEntry(void* arg)
+{
+    static_cast<LinuxThread*>(arg)->Process();
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+// Process
+//----------------------------------------------------------------------------
+void LinuxThread::Process()
+{
+    bool selfExit = false;
+    t_self_exit = &selfExit;
+
+    m_tid.store(static_cast<pid_t>(syscall(SYS_gettid)));
+
+    // The kernel limits thread names to 15 characters
+    char name[16];
+    strncpy(name, THREAD_NAME.c_str(), sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    pthread_setname_np(pthread_self(), name);
+
+    MsgQueue batch[dmq::PRIORITY_LEVELS];
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (QueueSizeLocked() == 0)
+        {
+            // Park until a producer increments m_consumerSeq
+            m_consumerWaiting = true;
+            uint32_t seq = m_consumerSeq.load(std::memory_order_relaxed);
+            lk.unlock();
+            FutexWait(m_consumerSeq, seq, nullptr);
+            continue;
+        }
+
+        // Take every queued message under one lock acquisition
+        m_consumerWaiting = false;
+        for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+            batch[level].swap(m_queues[level]);
+        bool wakeProducers = m_producersWaiting > 0;
+        if (wakeProducers)
+            m_notFullSeq.fetch_add(1, std::memory_order_relaxed);
+        lk.unlock();
+
+        if (wakeProducers)
+            FutexWake(m_notFullSeq, INT_MAX);
+
+        // Highest priority level first. The exit message, at LOWEST, ends the batch.
+        for (size_t level = dmq::PRIORITY_LEVELS; level-- > 0;)
+        {
+            for (auto& msg : batch[level])
+            {
+                if (msg == m_exitMsg || !InvokeMsg(msg, selfExit)) { t_self_exit = nullptr; return; }
+            }
+            batch[level].clear();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// InvokeMsg
+//----------------------------------------------------------------------------
+bool LinuxThread::InvokeMsg(const std::shared_ptr<dmq::DelegateMsg>& msg, bool& selfExit)
+{
+    if (!msg)
+        return true;
+
+    auto invoker = msg->GetInvoker();
+    if (!invoker)
+        return true;
+
+#if defined(__cpp_exceptions) && !defined(DMQ_ASSERTS)
+    try {
+        bool success = invoker->Invoke(msg);
+        if (!selfExit) ASSERT_TRUE(success);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[LinuxThread:" << THREAD_NAME << "] Unhandled exception in delegate callback: " << e.what() << std::endl;
+        ASSERT();
+    }
+    catch (...) {
+        std::cerr << "[LinuxThread:" << THREAD_NAME << "] Unhandled unknown exception in delegate callback." << std::endl;
+        ASSERT();
+    }
+#else
+    bool success = invoker->Invoke(msg);
+    if (!selfExit) ASSERT_TRUE(success);
+#endif
+    return !selfExit;
+}
+
+} // namespace dmq::os
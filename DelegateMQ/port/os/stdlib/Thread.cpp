@@ -9,6 +9,19 @@
 #ifdef _WIN32
 #include <Windows.h>
 #endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Hint to the CPU that the caller is busy-spinning
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
 
 // Thread-local pointer into Process()'s stack frame. Set non-null only while
 // Process() is running on a given thread. ExitThread() writes true through it
@@ -27,15 +40,25 @@ using namespace dmq::util;
 //----------------------------------------------------------------------------
 // Thread
 //----------------------------------------------------------------------------
-Thread::Thread(const char* threadName, size_t maxQueueSize, FullPolicy fullPolicy, dmq::Duration dispatchTimeout, const char* cpuName)
+Thread::Thread(const char* threadName, size_t maxQueueSize, FullPolicy fullPolicy, dmq::Duration dispatchTimeout, const char* cpuName, QueueMode queueMode)
     : m_thread(std::nullopt)
     , m_exit(false)
     , THREAD_NAME(threadName)
     , CPU_NAME(cpuName)
     , MAX_QUEUE_SIZE(maxQueueSize)
     , FULL_POLICY(fullPolicy)
+    , QUEUE_MODE(queueMode)
     , m_dispatchTimeout(dispatchTimeout)
 {
+    if (QUEUE_MODE == QueueMode::RING)
+    {
+        // A ring is bounded by definition
+        ASSERT_TRUE(MAX_QUEUE_SIZE > 0);
+
+        // One extra LOWEST slot for the exit message, which bypasses the limit
+        for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+            m_rings[level].Create(level == dmq::GetPriorityLevel(dmq::Priority::LOWEST) ? MAX_QUEUE_SIZE + 1 : MAX_QUEUE_SIZE);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -145,8 +168,123 @@ bool Thread::IsCurrentThread()
 //----------------------------------------------------------------------------
 size_t Thread::GetQueueSize()
 {
+    if (QUEUE_MODE == QueueMode::LOCK_FREE)
+        return m_queueSize.load();
+
     lock_guard<mutex> lock(m_mutex);
-    return (m_highQueue.size() + m_normalQueue.size());
+    return QueueSizeLocked();
+}
+
+//----------------------------------------------------------------------------
+// QueueSizeLocked
+//----------------------------------------------------------------------------
+size_t Thread::QueueSizeLocked() const
+{
+    size_t size = 0;
+    for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+        size += QUEUE_MODE == QueueMode::RING ? m_rings[level].Size() : m_queues[level].size();
+    return size;
+}
+
+//----------------------------------------------------------------------------
+// GetEnqueueTime
+//----------------------------------------------------------------------------
+dmq::TimePoint Thread::GetEnqueueTime() const
+{
+#if defined(DMQ_DATABUS_TOOLS)
+    return Timer::GetNow();
+#else
+    return m_agingInterval.count() > 0 ? Timer::GetNow() : dmq::TimePoint();
+#endif
+}
+
+//----------------------------------------------------------------------------
+// PeekLevel
+//----------------------------------------------------------------------------
+bool Thread::PeekLevel(size_t level, dmq::TimePoint& enqueueTime) const
+{
+    if (QUEUE_MODE == QueueMode::RING)
+    {
+        if (m_rings[level].Empty())
+            return false;
+        enqueueTime = m_rings[level].Front().enqueueTime;
+    }
+    else if (QUEUE_MODE == QueueMode::LOCK_FREE)
+    {
+        ThreadMsg* msg = m_lockFreeMsgs[level].Peek();
+        if (msg == nullptr)
+            return false;
+        enqueueTime = msg->GetEnqueueTime();
+    }
+    else
+    {
+        if (m_queues[level].empty())
+            return false;
+        enqueueTime = m_queues[level].front()->GetEnqueueTime();
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// SelectLevel
+//----------------------------------------------------------------------------
+bool Thread::SelectLevel(dmq::TimePoint now, size_t& level) const
+{
+    bool found = false;
+    size_t bestAged = 0;
+    for (size_t i = dmq::PRIORITY_LEVELS; i-- > 0;)
+    {
+        dmq::TimePoint enqueueTime;
+        if (!PeekLevel(i, enqueueTime))
+            continue;
+
+        // Strict priority
+        if (m_agingInterval.count() <= 0)
+        {
+            level = i;
+            return true;
+        }
+
+        // Promote the oldest message one level per aging interval waited. Ties keep 
+        // the higher level, visited first.
+        dmq::Duration waited = now - enqueueTime;
+        size_t aged = i;
+        if (waited >= m_agingInterval)
+            aged += static_cast<size_t>(waited / m_agingInterval);
+        if (!found || aged > bestAged)
+        {
+            found = true;
+            bestAged = aged;
+            level = i;
+        }
+    }
+    return found;
+}
+
+//----------------------------------------------------------------------------
+// EnqueueLocked
+//----------------------------------------------------------------------------
+void Thread::EnqueueLocked(int id, const std::shared_ptr<dmq::DelegateMsg>& msg)
+{
+    // The exit message has no data and is queued behind every delegate message
+    size_t level = dmq::GetPriorityLevel(msg ? msg->GetPriority() : dmq::Priority::LOWEST);
+    m_queueSize.fetch_add(1, std::memory_order_relaxed);
+#if defined(DMQ_DATABUS_TOOLS)
+    if (id == MSG_DISPATCH_DELEGATE)
+        m_levelDepth[level].fetch_add(1, std::memory_order_relaxed);
+#endif
+
+    if (QUEUE_MODE == QueueMode::RING)
+    {
+        bool pushed = m_rings[level].Push(id, msg, GetEnqueueTime());
+        ASSERT_TRUE(pushed);
+        return;
+    }
+
+    // If using XALLOCATOR explicit operator new required. See xallocator.h.
+    auto threadMsg = xmake_shared<ThreadMsg>(id, msg);
+    threadMsg->SetEnqueueTime(GetEnqueueTime());
+    m_queues[level].push_back(threadMsg);
 }
 
 void Thread::Sleep(dmq::Duration timeout) {
@@ -179,9 +317,6 @@ void Thread::ExitThread()
     if (!m_thread)
         return;
 
-    // Create a new ThreadMsg
-    auto threadMsg = xmake_shared<ThreadMsg>(MSG_EXIT_THREAD, nullptr);
-
     {
         lock_guard<mutex> lock(m_mutex);
 
@@ -191,10 +326,13 @@ void Thread::ExitThread()
 
         // Explicitly allow Exit message to bypass the MAX_QUEUE_SIZE limit.
         // We do not wait on m_cvNotFull here to prevent deadlock during shutdown.
-        if (threadMsg->GetPriority() == dmq::Priority::HIGH)
-            m_highQueue.push_back(threadMsg);
+        if (QUEUE_MODE == QueueMode::LOCK_FREE)
+        {
+            m_queueSize.fetch_add(1);
+            m_lockFreeMsgs[dmq::GetPriorityLevel(dmq::Priority::LOWEST)].Push(new ThreadMsg(MSG_EXIT_THREAD, nullptr));
+        }
         else
-            m_normalQueue.push_back(threadMsg);
+            EnqueueLocked(MSG_EXIT_THREAD, nullptr);
 
         // Wake up consumers
         m_cv.notify_one();
@@ -222,8 +360,16 @@ void Thread::ExitThread()
     {
         lock_guard<mutex> lock(m_mutex);
         m_thread.reset();
-        m_highQueue.clear();
-        m_normalQueue.clear();
+        for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+        {
+            m_queues[level].clear();
+            m_rings[level].Clear();
+            m_lockFreeMsgs[level].Clear();
+#if defined(DMQ_DATABUS_TOOLS)
+            m_levelDepth[level].store(0);
+#endif
+        }
+        m_queueSize.store(0);
 
         // Final cleanup notification
         m_cvNotFull.notify_all();
@@ -234,6 +380,22 @@ void Thread::ExitThread()
 // DispatchDelegate
 //----------------------------------------------------------------------------
 bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
+{
+    return Dispatch(msg, true);
+}
+
+//----------------------------------------------------------------------------
+// TryDispatchDelegate
+//----------------------------------------------------------------------------
+bool Thread::TryDispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
+{
+    return Dispatch(msg, false);
+}
+
+//----------------------------------------------------------------------------
+// Dispatch
+//----------------------------------------------------------------------------
+bool Thread::Dispatch(const std::shared_ptr<dmq::DelegateMsg>& msg, bool wait)
 {
     // Early check, though we re-check inside lock for safety
     if (m_exit.load())
@@ -242,12 +404,20 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
     if (!m_thread.has_value())
         throw std::invalid_argument("Thread pointer is null");
 
+    if (QUEUE_MODE == QueueMode::LOCK_FREE)
+    {
+        if (!PushLockFree(msg, wait))
+            return false;
+        WakeLockFree();
+        return true;
+    }
+
     std::unique_lock<std::mutex> lk(m_mutex);
 
     // [BACK PRESSURE / DROP / FAULT / TIMEOUT LOGIC]
-    if (MAX_QUEUE_SIZE > 0 && (m_highQueue.size() + m_normalQueue.size()) >= MAX_QUEUE_SIZE)
+    if (MAX_QUEUE_SIZE > 0 && QueueSizeLocked() >= MAX_QUEUE_SIZE)
     {
-        if (FULL_POLICY == FullPolicy::DROP)
+        if (!wait || FULL_POLICY == FullPolicy::DROP)
             return false;  // silently discard — caller is not stalled, no allocation wasted
 
         if (FULL_POLICY == FullPolicy::FAULT)
@@ -260,7 +430,7 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
         if (FULL_POLICY == FullPolicy::TIMEOUT)
         {
             bool hasSpace = m_cvNotFull.wait_for(lk, m_dispatchTimeout, [this]() {
-                return (m_highQueue.size() + m_normalQueue.size()) < MAX_QUEUE_SIZE || m_exit.load();
+                return QueueSizeLocked() < MAX_QUEUE_SIZE || m_exit.load();
             });
             if (!hasSpace) {
                 printf("[Thread] WARNING: Queue post timed out on '%s' — possible deadlock. Message dropped.\n", THREAD_NAME.c_str());
@@ -271,41 +441,284 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
 
     }
 
-    // If using XALLOCATOR explicit operator new required. See xallocator.h.
-    auto threadMsg = xmake_shared<ThreadMsg>(MSG_DISPATCH_DELEGATE, msg);
-#if defined(DMQ_DATABUS_TOOLS)
-    threadMsg->SetEnqueueTime(Timer::GetNow());
-#endif
-
     // If we woke up because of exit (or exit happened while waiting), abort
     if (m_exit.load())
         return false;
 
-    if (threadMsg->GetPriority() == dmq::Priority::HIGH)
-        m_highQueue.push_back(threadMsg);
-    else
-        m_normalQueue.push_back(threadMsg);
+    EnqueueLocked(MSG_DISPATCH_DELEGATE, msg);
 
 #if defined(DMQ_DATABUS_TOOLS)
     // Snapshot size while holding m_mutex
-    size_t currentDepth = (m_highQueue.size() + m_normalQueue.size());
+    size_t currentDepth = QueueSizeLocked();
 #endif
 
-    m_cv.notify_one();
+    // A spinning consumer needs no wakeup
+    if (m_consumerWaiting.load(std::memory_order_relaxed))
+        m_cv.notify_one();
     lk.unlock(); // Release producer-blocking lock early
 
 #if defined(DMQ_DATABUS_TOOLS)
     // Update monitoring stats under the separate stats mutex
+    RecordQueueDepth(currentDepth);
+#endif
+
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// DispatchDelegates
+//----------------------------------------------------------------------------
+size_t Thread::DispatchDelegates(const std::shared_ptr<dmq::DelegateMsg>* msgs, size_t count)
+{
+    if (m_exit.load() || count == 0)
+        return 0;
+
+    if (!m_thread.has_value())
+        throw std::invalid_argument("Thread pointer is null");
+
+    if (QUEUE_MODE == QueueMode::LOCK_FREE)
     {
-        lock_guard<mutex> lock(m_statsMutex);
-        if (currentDepth > m_queueDepthMaxWindow) m_queueDepthMaxWindow = currentDepth;
-        if (currentDepth > m_queueDepthMaxAll) m_queueDepthMaxAll = currentDepth;
+        size_t linked = 0;
+        while (linked < count && PushLockFree(msgs[linked]))
+            linked++;
+        if (linked > 0)
+            WakeLockFree();
+        return linked;
     }
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+
+    size_t dispatched = 0;
+    for (; dispatched < count; dispatched++)
+    {
+        // [BACK PRESSURE / DROP / FAULT / TIMEOUT LOGIC] applied per message
+        if (MAX_QUEUE_SIZE > 0 && QueueSizeLocked() >= MAX_QUEUE_SIZE)
+        {
+            if (FULL_POLICY == FullPolicy::DROP)
+                break;
+
+            if (FULL_POLICY == FullPolicy::FAULT)
+            {
+                printf("[Thread] CRITICAL: Queue full on thread '%s'! TRIGGERING FAULT.\n", THREAD_NAME.c_str());
+                ASSERT_TRUE(false);
+                break;
+            }
+
+            if (FULL_POLICY == FullPolicy::TIMEOUT)
+            {
+                // Let the consumer drain the messages already enqueued
+                if (dispatched > 0 && m_consumerWaiting.load(std::memory_order_relaxed))
+                    m_cv.notify_one();
+
+                bool hasSpace = m_cvNotFull.wait_for(lk, m_dispatchTimeout, [this]() {
+                    return QueueSizeLocked() < MAX_QUEUE_SIZE || m_exit.load();
+                });
+                if (!hasSpace) {
+                    printf("[Thread] WARNING: Queue post timed out on '%s' — possible deadlock. Message dropped.\n", THREAD_NAME.c_str());
+                    break;
+                }
+            }
+        }
+
+        if (m_exit.load())
+            break;
+
+        EnqueueLocked(MSG_DISPATCH_DELEGATE, msgs[dispatched]);
+    }
+
+#if defined(DMQ_DATABUS_TOOLS)
+    // Snapshot size while holding m_mutex
+    size_t currentDepth = QueueSizeLocked();
+#endif
+
+    // One wakeup for the whole batch, unless the consumer is spinning
+    if (dispatched > 0 && m_consumerWaiting.load(std::memory_order_relaxed))
+        m_cv.notify_one();
+    lk.unlock();
+
+#if defined(DMQ_DATABUS_TOOLS)
+    RecordQueueDepth(currentDepth);
+#endif
+
+    return dispatched;
+}
+
+//----------------------------------------------------------------------------
+// PushLockFree
+//----------------------------------------------------------------------------
+bool Thread::PushLockFree(const std::shared_ptr<dmq::DelegateMsg>& msg, bool wait)
+{
+    if (!ReserveLockFree(wait))
+        return false;
+
+    // If we woke up because of exit (or exit happened while waiting), abort
+    if (m_exit.load())
+    {
+        m_queueSize.fetch_sub(1);
+        return false;
+    }
+
+    // If using XALLOCATOR explicit operator new required. See xallocator.h.
+    ThreadMsg* threadMsg = new ThreadMsg(MSG_DISPATCH_DELEGATE, msg);
+    threadMsg->SetEnqueueTime(GetEnqueueTime());
+    size_t level = threadMsg->GetPriorityLevel();
+#if defined(DMQ_DATABUS_TOOLS)
+    m_levelDepth[level].fetch_add(1, std::memory_order_relaxed);
 #endif
+    m_lockFreeMsgs[level].Push(threadMsg);
 
+#if defined(DMQ_DATABUS_TOOLS)
+    RecordQueueDepth(m_queueSize.load(std::memory_order_relaxed));
+#endif
     return true;
 }
 
+//----------------------------------------------------------------------------
+// TryReserveLockFree
+//----------------------------------------------------------------------------
+bool Thread::TryReserveLockFree()
+{
+    size_t size = m_queueSize.load(std::memory_order_relaxed);
+    while (size < MAX_QUEUE_SIZE)
+    {
+        if (m_queueSize.compare_exchange_weak(size, size + 1))
+            return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// ReserveLockFree
+//----------------------------------------------------------------------------
+bool Thread::ReserveLockFree(bool wait)
+{
+    if (MAX_QUEUE_SIZE == 0)
+    {
+        m_queueSize.fetch_add(1);
+        return true;
+    }
+
+    if (TryReserveLockFree())
+        return true;
+
+    // [BACK PRESSURE / DROP / FAULT / TIMEOUT LOGIC]
+    if (!wait || FULL_POLICY == FullPolicy::DROP)
+        return false;
+
+    if (FULL_POLICY == FullPolicy::FAULT)
+    {
+        printf("[Thread] CRITICAL: Queue full on thread '%s'! TRIGGERING FAULT.\n", THREAD_NAME.c_str());
+        ASSERT_TRUE(false);
+        return false;
+    }
+
+    // TIMEOUT. The consumer only takes the mutex to notify while a producer waits.
+    bool reserved = false;
+    {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_producersWaiting.fetch_add(1);
+        m_cvNotFull.wait_for(lk, m_dispatchTimeout, [this, &reserved]() {
+            if (m_exit.load())
+                return true;
+            reserved = TryReserveLockFree();
+            return reserved;
+        });
+        m_producersWaiting.fetch_sub(1);
+    }
+    if (!reserved && !m_exit.load())
+        printf("[Thread] WARNING: Queue post timed out on '%s' — possible deadlock. Message dropped.\n", THREAD_NAME.c_str());
+    else if (reserved && m_exit.load())
+    {
+        m_queueSize.fetch_sub(1);
+        reserved = false;
+    }
+    return reserved;
+}
+
+//----------------------------------------------------------------------------
+// WakeLockFree
+//----------------------------------------------------------------------------
+void Thread::WakeLockFree()
+{
+    // Pairs with the consumer storing m_consumerWaiting before checking the queue 
+    // size under the mutex: either the consumer sees the new message, or this thread
+    // sees the consumer waiting. The mutex is only taken when a wakeup is needed.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_consumerWaiting.load(std::memory_order_relaxed))
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_cv.notify_one();
+    }
+}
+
+//----------------------------------------------------------------------------
+// PopLockFree
+//----------------------------------------------------------------------------
+ThreadMsg* Thread::PopLockFree(dmq::Duration watchdogTimeout)
+{
+    for (;;)
+    {
+        // Get highest priority message within queue
+        ThreadMsg* msg = nullptr;
+        size_t level;
+        if (SelectLevel(m_agingInterval.count() > 0 ? Timer::GetNow() : dmq::TimePoint(), level))
+            msg = m_lockFreeMsgs[level].Pop();
+
+        // The selected message may still be linking its successor; take any other
+        for (size_t i = dmq::PRIORITY_LEVELS; msg == nullptr && i-- > 0;)
+            msg = m_lockFreeMsgs[i].Pop();
+
+        if (msg != nullptr)
+        {
+            m_queueSize.fetch_sub(1);
+#if defined(DMQ_DATABUS_TOOLS)
+            if (msg->GetId() == MSG_DISPATCH_DELEGATE)
+                m_levelDepth[msg->GetPriorityLevel()].fetch_sub(1, std::memory_order_relaxed);
+#endif
+
+            // Unblock producers now that space is available
+            if (MAX_QUEUE_SIZE > 0 && m_producersWaiting.load() > 0)
+            {
+                lock_guard<mutex> lock(m_mutex);
+                m_cvNotFull.notify_one();
+            }
+            return msg;
+        }
+
+        // A producer reserved a slot and is still linking its message
+        if (m_queueSize.load() > 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (m_exit.load())
+            return nullptr;
+
+        // Poll before parking, if configured
+        if (SpinWait())
+            continue;
+
+        // Wait for message to be added to the queue
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_consumerWaiting.store(true);
+        auto predicate = [this]() { return m_queueSize.load() > 0 || m_exit.load(); };
+        bool signaled;
+        if (watchdogTimeout.count() > 0)
+            signaled = m_cv.wait_for(lk, watchdogTimeout / 10, predicate);
+        else
+        {
+            m_cv.wait(lk, predicate);
+            signaled = true;
+        }
+        m_consumerWaiting.store(false);
+
+        // Let the caller refresh the watchdog while idle
+        if (!signaled)
+            return nullptr;
+    }
+}
+
 //----------------------------------------------------------------------------
 // WatchdogCheckAll
 //----------------------------------------------------------------------------
@@ -375,6 +788,17 @@ void Thread::Process()
     bool selfExit = false;
     t_self_exit = &selfExit;
 
+    // The messages removed from the queue under one lock acquisition. The batches 
+    // live on this stack frame, so messages not yet invoked are released safely 
+    // even if 'this' is freed.
+    const size_t maxBatchSize = m_maxBatchSize;
+    std::vector<std::shared_ptr<ThreadMsg>> msgBatch;
+    std::vector<ThreadMsgRing::Entry> ringBatch;
+    if (QUEUE_MODE == QueueMode::RING)
+        ringBatch.resize(maxBatchSize);
+    else if (QUEUE_MODE == QueueMode::MUTEX)
+        msgBatch.reserve(maxBatchSize);
+
     // Signal that the thread has started processing to notify CreateThread
     m_threadStartPromise->set_value();
 
@@ -386,14 +810,41 @@ void Thread::Process()
             watchdogTimeout = m_watchdogTimeout.load();
         }
 
-        std::shared_ptr<ThreadMsg> msg;
+        if (QUEUE_MODE == QueueMode::LOCK_FREE)
+        {
+            // Messages are removed without the mutex; no batching required
+            std::unique_ptr<ThreadMsg> msg(PopLockFree(watchdogTimeout));
+
+            // Always update alive time immediately after waking up
+            m_lastAliveTime.store(Timer::GetNow());
+
+            if (!msg)
+            {
+                if (m_exit.load() && m_queueSize.load() == 0) { t_self_exit = nullptr; return; }
+                continue;
+            }
+
+            RecordBatch(1);
+            if (!InvokeMsg(*msg, selfExit)) { t_self_exit = nullptr; return; }
+
+            // msg goes out of scope here — may trigger self-destruction of 'this'.
+            // After this point do not access any member; check selfExit in while().
+            continue;
+        }
+
+        // Poll before parking, if configured
+        if (m_queueSize.load(std::memory_order_relaxed) == 0)
+            SpinWait();
+
+        size_t batchSize = 0;
         {
             std::unique_lock<std::mutex> lk(m_mutex);
 
             // Wait for message to be added to the queue.
             // If watchdog active, use a finite timeout so we can periodically update 
             // m_lastAliveTime while idle. Otherwise, block forever.
-            auto predicate = [this]() { return !(m_highQueue.empty() && m_normalQueue.empty()) || m_exit.load(); };
+            auto predicate = [this]() { return QueueSizeLocked() > 0 || m_exit.load(); };
+            m_consumerWaiting.store(true, std::memory_order_relaxed);
             if (watchdogTimeout.count() > 0)
             {
                 // Wake up frequently to ensure heartbeat is updated while idle
@@ -403,119 +854,221 @@ void Thread::Process()
             {
                 m_cv.wait(lk, predicate);
             }
+            m_consumerWaiting.store(false, std::memory_order_relaxed);
 
             // Always update alive time immediately after waking up
             m_lastAliveTime.store(Timer::GetNow());
 
             // If empty and exit is true, we should exit.
-            if ((m_highQueue.empty() && m_normalQueue.empty()))
+            if (QueueSizeLocked() == 0)
             {
                 if (m_exit.load()) { t_self_exit = nullptr; return; }
                 continue;
             }
 
-            // Get highest priority message within queue
-            if (!m_highQueue.empty()) {
-                msg = m_highQueue.front();
-                m_highQueue.pop_front();
-            } else {
-                msg = m_normalQueue.front();
-                m_normalQueue.pop_front();
+            // Remove up to maxBatchSize messages, highest (aged) priority first
+            dmq::TimePoint now = m_agingInterval.count() > 0 ? Timer::GetNow() : dmq::TimePoint();
+            size_t level;
+            for (; batchSize < maxBatchSize && SelectLevel(now, level); batchSize++)
+            {
+                int id;
+                if (QUEUE_MODE == QueueMode::RING)
+                {
+                    m_rings[level].Pop(ringBatch[batchSize]);
+                    id = ringBatch[batchSize].id;
+                }
+                else
+                {
+                    msgBatch.push_back(std::move(m_queues[level].front()));
+                    m_queues[level].pop_front();
+                    id = msgBatch.back()->GetId();
+                }
+#if defined(DMQ_DATABUS_TOOLS)
+                if (id == MSG_DISPATCH_DELEGATE)
+                    m_levelDepth[level].fetch_sub(1, std::memory_order_relaxed);
+#else
+                (void)id;
+#endif
             }
 
-            // Unblock producers now that space is available
+            m_queueSize.fetch_sub(batchSize, std::memory_order_relaxed);
+
+            // Unblock producers now that space is available, once per batch
             if (MAX_QUEUE_SIZE > 0)
             {
-                m_cvNotFull.notify_one();
+                if (batchSize > 1)
+                    m_cvNotFull.notify_all();
+                else
+                    m_cvNotFull.notify_one();
             }
         }
 
-        switch (msg->GetId())
+        RecordBatch(batchSize);
+
+        // Invoke the batch without the lock. Messages posted meanwhile, including
+        // high priority messages, wait for the next batch.
+        for (size_t i = 0; i < batchSize; i++)
         {
-            case MSG_DISPATCH_DELEGATE:
+            bool exitThread;
+            if (QUEUE_MODE == QueueMode::RING)
             {
+                ThreadMsgRing::Entry& entry = ringBatch[i];
+                ThreadMsg msg(entry.id, std::move(entry.data));
+                msg.SetEnqueueTime(entry.enqueueTime);
+                exitThread = !InvokeMsg(msg, selfExit);
+            }
+            else
+            {
+                exitThread = !InvokeMsg(*msgBatch[i], selfExit);
+                msgBatch[i].reset();
+            }
+
+            // The message is released here — may trigger self-destruction of 'this'.
+            // After this point do not access any member unless selfExit is false.
+            if (exitThread || selfExit) { t_self_exit = nullptr; return; }
+        }
+        msgBatch.clear();
+    }
+    t_self_exit = nullptr;
+}
+
+//----------------------------------------------------------------------------
+// InvokeMsg
+//----------------------------------------------------------------------------
+bool Thread::InvokeMsg(ThreadMsg& msg, bool& selfExit)
+{
+    switch (msg.GetId())
+    {
+        case MSG_DISPATCH_DELEGATE:
+        {
 #if defined(DMQ_DATABUS_TOOLS)
-                // Update latency stats before invoking
-                dmq::Duration latency = Timer::GetNow() - msg->GetEnqueueTime();
-                {
-                    lock_guard<mutex> lock(m_statsMutex);
-                    m_latencyTotalWindow += latency;
-                    m_latencyCountWindow++;
-                    if (latency > m_latencyMaxWindow) m_latencyMaxWindow = latency;
-                    if (latency > m_latencyMaxAll) m_latencyMaxAll = latency;
-                    m_dispatchCountAll++;
-                }
+            // Update latency stats before invoking
+            dmq::Duration latency = Timer::GetNow() - msg.GetEnqueueTime();
+            size_t level = msg.GetPriorityLevel();
+            {
+                lock_guard<mutex> lock(m_statsMutex);
+                m_latencyTotalWindow += latency;
+                m_latencyCountWindow++;
+                if (latency > m_latencyMaxWindow) m_latencyMaxWindow = latency;
+                if (latency > m_latencyMaxAll) m_latencyMaxAll = latency;
+                m_levelLatencyTotalWindow[level] += latency;
+                m_levelLatencyCountWindow[level]++;
+                if (latency > m_levelLatencyMaxAll[level]) m_levelLatencyMaxAll[level] = latency;
+                m_dispatchCountAll++;
+            }
 #endif
 
-                auto delegateMsg = msg->GetData();
-                if (delegateMsg) {
-                    auto invoker = delegateMsg->GetInvoker();
-                    if (invoker) {
+            auto delegateMsg = msg.GetData();
+            if (delegateMsg) {
+                auto invoker = delegateMsg->GetInvoker();
+                if (invoker) {
 #if defined(DMQ_DATABUS_TOOLS)
-                        dmq::TimePoint start = Timer::GetNow();
+                    dmq::TimePoint start = Timer::GetNow();
 #endif
 #if defined(__cpp_exceptions) && !defined(DMQ_ASSERTS)
-                        try {
-                            bool success = invoker->Invoke(delegateMsg);
-                            if (!selfExit) ASSERT_TRUE(success);
-                        }
-                        catch (const std::bad_alloc& e) {
-                            std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled bad_alloc in delegate callback: " << e.what() << std::endl;
-                            ASSERT();
-                        }
-                        catch (const std::invalid_argument& e) {
-                            std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled invalid_argument in delegate callback: " << e.what() << std::endl;
-                            ASSERT();
-                        }
-                        catch (const std::runtime_error& e) {
-                            std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled runtime_error in delegate callback: " << e.what() << std::endl;
-                            ASSERT();
-                        }
-                        catch (const std::exception& e) {
-                            std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled exception in delegate callback: " << e.what() << std::endl;
-                            ASSERT();
-                        }
-                        catch (...) {
-                            std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled unknown exception in delegate callback." << std::endl;
-                            ASSERT();
-                        }
-#else
+                    try {
                         bool success = invoker->Invoke(delegateMsg);
                         if (!selfExit) ASSERT_TRUE(success);
+                    }
+                    catch (const std::bad_alloc& e) {
+                        std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled bad_alloc in delegate callback: " << e.what() << std::endl;
+                        ASSERT();
+                    }
+                    catch (const std::invalid_argument& e) {
+                        std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled invalid_argument in delegate callback: " << e.what() << std::endl;
+                        ASSERT();
+                    }
+                    catch (const std::runtime_error& e) {
+                        std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled runtime_error in delegate callback: " << e.what() << std::endl;
+                        ASSERT();
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled exception in delegate callback: " << e.what() << std::endl;
+                        ASSERT();
+                    }
+                    catch (...) {
+                        std::cerr << "[Thread:" << THREAD_NAME << "] Unhandled unknown exception in delegate callback." << std::endl;
+                        ASSERT();
+                    }
+#else
+                    bool success = invoker->Invoke(delegateMsg);
+                    if (!selfExit) ASSERT_TRUE(success);
 #endif
-                        if (selfExit) {
-                            t_self_exit = nullptr;
-                            return;
-                        }
+                    if (selfExit)
+                        return false;
 #if defined(DMQ_DATABUS_TOOLS)
-                        dmq::Duration invokeTime = Timer::GetNow() - start;
-                        if (!selfExit) {
-                            lock_guard<mutex> lock(m_statsMutex);
-                            m_invokeTotalWindow += invokeTime;
-                            m_invokeCountWindow++;
-                            if (invokeTime > m_invokeMaxWindow) m_invokeMaxWindow = invokeTime;
-                            if (invokeTime > m_invokeMaxAll) m_invokeMaxAll = invokeTime;
-                        }
-#endif
+                    dmq::Duration invokeTime = Timer::GetNow() - start;
+                    if (!selfExit) {
+                        lock_guard<mutex> lock(m_statsMutex);
+                        m_invokeTotalWindow += invokeTime;
+                        m_invokeCountWindow++;
+                        if (invokeTime > m_invokeMaxWindow) m_invokeMaxWindow = invokeTime;
+                        if (invokeTime > m_invokeMaxAll) m_invokeMaxAll = invokeTime;
                     }
+#endif
                 }
-                break;
             }
+            break;
+        }
 
-            case MSG_EXIT_THREAD:
-            {
-                t_self_exit = nullptr;
-                return;
-            }
+        case MSG_EXIT_THREAD:
+            return false;
 
-            default:
-                ASSERT();
-                break;
-        }
-        // msg goes out of scope here — may trigger self-destruction of 'this'.
-        // After this point do not access any member; check selfExit in while().
+        default:
+            ASSERT();
+            break;
     }
-    t_self_exit = nullptr;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// SpinWait
+//----------------------------------------------------------------------------
+bool Thread::SpinWait()
+{
+    for (size_t i = 0; i < m_spinCount; i++)
+    {
+        if (m_queueSize.load(std::memory_order_relaxed) > 0 || m_exit.load(std::memory_order_relaxed))
+            return true;
+        CpuRelax();
+    }
+    for (size_t i = 0; i < m_yieldCount; i++)
+    {
+        if (m_queueSize.load(std::memory_order_relaxed) > 0 || m_exit.load(std::memory_order_relaxed))
+            return true;
+        std::this_thread::yield();
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// RecordBatch
+//----------------------------------------------------------------------------
+void Thread::RecordBatch(size_t batchSize)
+{
+    // Single writer; relaxed loads and stores avoid atomic read-modify-writes
+    size_t bucket = 0;
+    while (bucket + 1 < BatchStats::BUCKETS && (batchSize >> (bucket + 1)) != 0)
+        bucket++;
+    m_batchHistogram[bucket].store(m_batchHistogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_batchCount.store(m_batchCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_batchMessages.store(m_batchMessages.load(std::memory_order_relaxed) + batchSize, std::memory_order_relaxed);
+    if (batchSize > m_batchMax.load(std::memory_order_relaxed))
+        m_batchMax.store(batchSize, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// GetBatchStats
+//----------------------------------------------------------------------------
+Thread::BatchStats Thread::GetBatchStats() const
+{
+    BatchStats stats;
+    stats.batches = m_batchCount.load(std::memory_order_relaxed);
+    stats.messages = m_batchMessages.load(std::memory_order_relaxed);
+    stats.maxBatch = m_batchMax.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BatchStats::BUCKETS; i++)
+        stats.histogram[i] = m_batchHistogram[i].load(std::memory_order_relaxed);
+    return stats;
 }
 
 #if defined(DMQ_DATABUS_TOOLS)
@@ -524,7 +1077,7 @@ void Thread::Process()
 //----------------------------------------------------------------------------
 Thread::ThreadStats Thread::SnapshotStats()
 {
-    // Need m_mutex only for (m_highQueue.size() + m_normalQueue.size())
+    // Need m_mutex only for the queue size
     size_t currentDepth = GetQueueSize();
 
     lock_guard<mutex> lock(m_statsMutex);
@@ -556,6 +1109,18 @@ Thread::ThreadStats Thread::SnapshotStats()
 
     stats.dispatch_count = m_dispatchCountAll;
 
+    for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+    {
+        stats.level_depth[level] = m_levelDepth[level].load(std::memory_order_relaxed);
+        stats.level_depth_max_all[level] = m_levelDepthMaxAll[level];
+        stats.level_latency_avg_ms[level] = m_levelLatencyCountWindow[level] > 0 ?
+            (float)std::chrono::duration_cast<std::chrono::microseconds>(m_levelLatencyTotalWindow[level]).count() / 
+                (static_cast<float>(m_levelLatencyCountWindow[level]) * 1000.0f) : 0.0f;
+        stats.level_latency_max_all_ms[level] = (float)std::chrono::duration_cast<std::chrono::microseconds>(m_levelLatencyMaxAll[level]).count() / 1000.0f;
+        m_levelLatencyTotalWindow[level] = dmq::Duration(0);
+        m_levelLatencyCountWindow[level] = 0;
+    }
+
     // Reset windowed stats
     m_queueDepthMaxWindow = 0;
     m_latencyTotalWindow = dmq::Duration(0);
@@ -568,6 +1133,21 @@ Thread::ThreadStats Thread::SnapshotStats()
 
     return stats;
 }
+
+//----------------------------------------------------------------------------
+// RecordQueueDepth
+//----------------------------------------------------------------------------
+void Thread::RecordQueueDepth(size_t currentDepth)
+{
+    lock_guard<mutex> lock(m_statsMutex);
+    if (currentDepth > m_queueDepthMaxWindow) m_queueDepthMaxWindow = currentDepth;
+    if (currentDepth > m_queueDepthMaxAll) m_queueDepthMaxAll = currentDepth;
+    for (size_t level = 0; level < dmq::PRIORITY_LEVELS; level++)
+    {
+        size_t depth = m_levelDepth[level].load(std::memory_order_relaxed);
+        if (depth > m_levelDepthMaxAll[level]) m_levelDepthMaxAll[level] = depth;
+    }
+}
 #endif
 
 } // namespace dmq::os
@@ -14,11 +14,19 @@
 /// asynchronous delegates and system messages.
 ///
 /// **Key Features:**
-/// * **Priority Queue:** Uses `std::priority_queue` to ensure high-priority delegate 
-///   messages (e.g., system signals) are processed before lower-priority ones.
+/// * **Priority Levels:** Keeps one queue per `dmq::Priority` level and serves the highest
+///   non-empty level first. `SetPriorityAging()` promotes waiting messages so lower
+///   levels always make progress.
+/// * **Queue Mode:** `QueueMode::MUTEX` (the default) guards the queues with a mutex.
+///   `QueueMode::LOCK_FREE` uses lock-free intrusive MPSC queues for many producer threads.
+///   `QueueMode::RING` stores messages in preallocated slots, so dispatch never allocates.
 /// * **Queue Full Policy:** Configurable `FullPolicy` (DROP or TIMEOUT) when `maxQueueSize > 0`.
 ///   TIMEOUT waits up to `dispatchTimeout` for the consumer before logging and dropping;
 ///   DROP silently discards immediately. FAULT (the default) triggers a system fault.
+/// * **Batch Drain:** `SetMaxBatchSize()` removes up to N messages per lock acquisition,
+///   with batch size statistics from `GetBatchStats()`.
+/// * **Wait Strategy:** `SetWaitStrategy()` spins, then yields, before an idle thread
+///   parks, for low-latency handoff. Producers skip the wakeup while the thread spins.
 /// * **Watchdog Integration:** Includes a built-in heartbeat mechanism. If the thread loop 
 ///   stalls (deadlock or infinite loop), the watchdog timer detects the failure.
 /// * **Synchronized Start:** Uses `std::promise` and `std::future` to ensure the thread 
@@ -29,12 +37,15 @@
 #include "delegate/IThread.h"
 #include "./extras/util/Timer.h"
 #include "ThreadMsg.h"
+#include "ThreadMsgQueue.h"
+#include "ThreadMsgRing.h"
 #include <thread>
 #include <deque>
 #include <atomic>
 #include <condition_variable>
 #include <future>
 #include <optional>
+#include <vector>
 
 namespace dmq::os {
 
@@ -50,6 +61,20 @@ namespace dmq::os {
 /// FAULT is the default.
 enum class FullPolicy { DROP, FAULT, TIMEOUT };
 
+/// @brief The thread message queue implementation.
+/// @details
+///   - MUTEX:     Producers and the consumer share one mutex. Lowest latency for a few
+///                producers.
+///   - LOCK_FREE: Producers link messages into lock-free intrusive MPSC queues and only
+///                take the mutex to wake a sleeping consumer or to wait under the
+///                TIMEOUT policy. Use when many producer threads post to one thread.
+///   - RING:      Same as MUTEX, except messages are stored in fixed-capacity rings 
+///                preallocated from maxQueueSize, which must be > 0, with one ring per
+///                priority level. Dispatching performs no heap allocation. Use for 
+///                latency-critical threads.
+/// All modes preserve message priority, FullPolicy and statistics semantics.
+enum class QueueMode { MUTEX, LOCK_FREE, RING };
+
 /// @brief Cross-platform thread for any system supporting C++11 std::thread (e.g. Windows, Linux).
 /// @details The Thread class creates a worker thread capable of dispatching and
 /// invoking asynchronous delegates.
@@ -73,9 +98,25 @@ public:
         float invoke_max_window_ms;  // Max execution since last snapshot
         float invoke_max_all_ms;     // All-time max execution
         uint64_t dispatch_count;      // Total dispatches (all-time)
+
+        // Per dmq::Priority level, indexed by dmq::GetPriorityLevel()
+        size_t level_depth[dmq::PRIORITY_LEVELS];            // Current depth
+        size_t level_depth_max_all[dmq::PRIORITY_LEVELS];    // All-time max depth
+        float level_latency_avg_ms[dmq::PRIORITY_LEVELS];    // Avg wait in window
+        float level_latency_max_all_ms[dmq::PRIORITY_LEVELS];// All-time max wait
     };
 #endif
 
+    /// @brief The distribution of the number of messages removed from the queue per
+    /// consumer wakeup. See SetMaxBatchSize().
+    struct BatchStats {
+        static const size_t BUCKETS = 16;
+        uint64_t batches;             // Total batches
+        uint64_t messages;            // Total messages in all batches
+        size_t maxBatch;              // Largest batch
+        uint64_t histogram[BUCKETS];  // histogram[i] counts batches of 2^i to 2^(i+1)-1 messages
+    };
+
     /// Constructor
     /// @param threadName The name of the thread for debugging.
     /// @param maxQueueSize The maximum number of messages allowed in the queue.
@@ -84,11 +125,14 @@ public:
     ///                   Only meaningful when maxQueueSize > 0.
     /// @param dispatchTimeout Duration to wait before giving up when policy is TIMEOUT.
     /// @param cpuName Optional CPU/Core name grouping for monitoring tools.
+    /// @param queueMode The message queue implementation: MUTEX (default), LOCK_FREE or RING.
     Thread(const char* threadName, size_t maxQueueSize = 0, FullPolicy fullPolicy = FullPolicy::FAULT,
-           dmq::Duration dispatchTimeout = dmq::DEFAULT_DISPATCH_TIMEOUT, const char* cpuName = "");
+           dmq::Duration dispatchTimeout = dmq::DEFAULT_DISPATCH_TIMEOUT, const char* cpuName = "",
+           QueueMode queueMode = QueueMode::MUTEX);
     Thread(const std::string& threadName, size_t maxQueueSize = 0, FullPolicy fullPolicy = FullPolicy::FAULT,
-           dmq::Duration dispatchTimeout = dmq::DEFAULT_DISPATCH_TIMEOUT, const std::string& cpuName = "")
-        : Thread(threadName.c_str(), maxQueueSize, fullPolicy, dispatchTimeout, cpuName.c_str()) {}
+           dmq::Duration dispatchTimeout = dmq::DEFAULT_DISPATCH_TIMEOUT, const std::string& cpuName = "",
+           QueueMode queueMode = QueueMode::MUTEX)
+        : Thread(threadName.c_str(), maxQueueSize, fullPolicy, dispatchTimeout, cpuName.c_str(), queueMode) {}
 
     /// Destructor
     ~Thread();
@@ -117,6 +161,44 @@ public:
     /// Get size of thread message queue.
     size_t GetQueueSize();
 
+    /// Set the maximum number of messages removed from the queue under one lock 
+    /// acquisition and then invoked without the lock. Producers blocked by a full 
+    /// queue are signalled once per batch. A high priority message posted while a 
+    /// batch is invoked runs after the batch. Default 1. Call before CreateThread().
+    /// QueueMode::LOCK_FREE removes messages without the lock and ignores the setting.
+    /// @param[in] maxBatchSize - the maximum batch size, at least 1.
+    void SetMaxBatchSize(size_t maxBatchSize) { m_maxBatchSize = maxBatchSize > 0 ? maxBatchSize : 1; }
+
+    /// Get the batch size distribution since the thread was created. Callable from 
+    /// any thread.
+    BatchStats GetBatchStats() const;
+
+    /// Set how the idle thread waits for a message. The thread busy-spins polling the
+    /// queue spinCount times, then yields the CPU yieldCount times, and then parks on
+    /// the condition variable. Producers only signal the condition variable while the
+    /// thread is parked, so a message posted while the thread spins or yields costs no
+    /// wakeup system call. Spinning trades a CPU core for a handoff latency of a few
+    /// microseconds instead of a full wakeup. Default 0, 0: park immediately. Call 
+    /// before CreateThread().
+    /// @param[in] spinCount - the number of busy-spin polls.
+    /// @param[in] yieldCount - the number of polls calling std::this_thread::yield().
+    void SetWaitStrategy(size_t spinCount, size_t yieldCount)
+    {
+        m_spinCount = spinCount;
+        m_yieldCount = yieldCount;
+    }
+
+    /// Set priority aging. Without aging the thread always serves the highest priority
+    /// level holding a message, so a steady stream of high priority messages starves
+    /// the lower levels. With aging, each message is promoted one level for every
+    /// agingInterval it waits, and the message with the highest aged priority is served
+    /// next; ties go to the higher priority level. A message waiting 
+    /// dmq::PRIORITY_LEVELS intervals outranks any newly queued message. Order within
+    /// a level stays FIFO. Aging reads the clock once per enqueue and once per batch.
+    /// Default 0: no aging. Call before CreateThread().
+    /// @param[in] agingInterval - the wait promoting a message one level, or 0.
+    void SetPriorityAging(dmq::Duration agingInterval) { m_agingInterval = agingInterval; }
+
     /// Sleep for a duration.
     /// @param[in] timeout - the duration to sleep.
     static void Sleep(dmq::Duration timeout);
@@ -126,6 +208,19 @@ public:
     /// arguments.
     virtual bool DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg) override;
 
+    /// Dispatch a delegate without waiting. A full queue returns false, regardless
+    /// of the FullPolicy.
+    /// @param[in] msg - the delegate message.
+    /// @return true if the message was enqueued.
+    virtual bool TryDispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg) override;
+
+    /// Dispatch a batch of delegates using one lock acquisition and one wakeup.
+    /// The queue full policy applies to each message.
+    /// @param[in] msgs - the delegate messages, enqueued in order.
+    /// @param[in] count - the number of messages.
+    /// @return The number of messages enqueued.
+    virtual size_t DispatchDelegates(const std::shared_ptr<dmq::DelegateMsg>* msgs, size_t count) override;
+
     /// @brief Manually update the watchdog alive timestamp.
     /// @details The Process() loop refreshes the timestamp automatically on every iteration.
     /// Call this from inside long-running message handlers to prevent a false watchdog
@@ -147,8 +242,76 @@ private:
     /// Entry point for the thread
     void Process();
 
+    /// Invoke a message removed from the queue.
+    /// @param[in] msg - the message.
+    /// @param[in] selfExit - set if the invoked target destroyed this thread.
+    /// @return false if Process() must return without accessing any member.
+    bool InvokeMsg(ThreadMsg& msg, bool& selfExit);
+
+    /// Add a batch to the batch statistics. Consumer thread only.
+    void RecordBatch(size_t batchSize);
+
+    /// Poll for a message using the wait strategy before parking.
+    /// @return true if a message is queued or the thread is exiting.
+    bool SpinWait();
+
+    /// QueueMode::MUTEX and RING: get the number of queued messages. Called with
+    /// m_mutex held.
+    size_t QueueSizeLocked() const;
+
+    /// Get the enqueue time for a new message. A default time point unless priority
+    /// aging or DMQ_DATABUS_TOOLS needs it.
+    dmq::TimePoint GetEnqueueTime() const;
+
+    /// Get the enqueue time of the oldest message in a priority level. QueueMode::MUTEX
+    /// and RING call it with m_mutex held; LOCK_FREE on the consumer thread.
+    /// @return false if the level is empty.
+    bool PeekLevel(size_t level, dmq::TimePoint& enqueueTime) const;
+
+    /// Select the priority level to serve next: the highest non-empty level, or with
+    /// aging, the level whose oldest message has the highest aged priority. Same
+    /// calling rules as PeekLevel().
+    /// @param[in] now - the current time, used by aging only.
+    /// @param[out] level - the selected level.
+    /// @return false if every level is empty.
+    bool SelectLevel(dmq::TimePoint now, size_t& level) const;
+
+    /// QueueMode::MUTEX and RING: append a message to the queue selected by its 
+    /// priority. Called with m_mutex held, once the full policy made room.
+    void EnqueueLocked(int id, const std::shared_ptr<dmq::DelegateMsg>& msg);
+
+    /// Enqueue a message for DispatchDelegate() and TryDispatchDelegate().
+    /// @param[in] msg - the delegate message.
+    /// @param[in] wait - apply the FullPolicy if the queue is full, else fail.
+    /// @return true if the message was enqueued.
+    bool Dispatch(const std::shared_ptr<dmq::DelegateMsg>& msg, bool wait);
+
+    /// QueueMode::LOCK_FREE: reserve a queue slot and link a message.
+    /// @return false if the message was not enqueued.
+    bool PushLockFree(const std::shared_ptr<dmq::DelegateMsg>& msg, bool wait = true);
+
+    /// QueueMode::LOCK_FREE: reserve a queue slot, applying the FullPolicy if wait 
+    /// is true, else failing if the queue is full.
+    bool ReserveLockFree(bool wait = true);
+
+    /// QueueMode::LOCK_FREE: claim a free slot without blocking.
+    bool TryReserveLockFree();
+
+    /// QueueMode::LOCK_FREE: wake the consumer if it is waiting.
+    void WakeLockFree();
+
+    /// QueueMode::LOCK_FREE: remove the next message, waiting while the queues are
+    /// empty. Consumer thread only.
+    /// @return The message, or nullptr on exit or on a watchdog wakeup.
+    ThreadMsg* PopLockFree(dmq::Duration watchdogTimeout);
+
     void SetThreadName(std::thread::native_handle_type handle, const dmq::xstring& name);
 
+#if defined(DMQ_DATABUS_TOOLS)
+    /// Update the maximum queue depth statistics after an enqueue.
+    void RecordQueueDepth(size_t currentDepth);
+#endif
+
     /// Check watchdog is expired. This function is called by the thread 
     /// the calls Timer::ProcessTimers(). This function is thread-safe.
     /// In a real-time OS, Timer::ProcessTimers() typically is called by the highest
@@ -164,16 +327,32 @@ private:
     std::optional<std::thread> m_thread;
     std::atomic<bool> m_exit;
 
+    // One queue per priority level, indexed by dmq::GetPriorityLevel()
 #ifdef DMQ_ALLOCATOR
-    std::deque<std::shared_ptr<ThreadMsg>, stl_allocator<std::shared_ptr<ThreadMsg>>> m_highQueue;
-    std::deque<std::shared_ptr<ThreadMsg>, stl_allocator<std::shared_ptr<ThreadMsg>>> m_normalQueue;
+    std::deque<std::shared_ptr<ThreadMsg>, stl_allocator<std::shared_ptr<ThreadMsg>>> m_queues[dmq::PRIORITY_LEVELS];
 #else
-    std::deque<std::shared_ptr<ThreadMsg>> m_highQueue;
-    std::deque<std::shared_ptr<ThreadMsg>> m_normalQueue;
+    std::deque<std::shared_ptr<ThreadMsg>> m_queues[dmq::PRIORITY_LEVELS];
 #endif
     std::mutex m_mutex;
     std::condition_variable m_cv;
 
+    // QueueMode::RING queues per priority level, preallocated by the constructor
+    ThreadMsgRing m_rings[dmq::PRIORITY_LEVELS];
+
+    // QueueMode::LOCK_FREE queues per priority level
+    ThreadMsgQueue m_lockFreeMsgs[dmq::PRIORITY_LEVELS];
+
+    // The number of queued messages, polled without the mutex by a spinning consumer.
+    // QueueMode::LOCK_FREE also counts reserved slots. MUTEX and RING update it with 
+    // m_mutex held.
+    std::atomic<size_t> m_queueSize{0};
+
+    // Set while the consumer is parked on m_cv. Producers skip the notify otherwise.
+    std::atomic<bool> m_consumerWaiting{false};
+
+    // QueueMode::LOCK_FREE: the number of producers waiting on m_cvNotFull
+    std::atomic<size_t> m_producersWaiting{0};
+
     // Condition variable to wake up blocked producers when space is available
     std::condition_variable m_cvNotFull;
 
@@ -186,6 +365,25 @@ private:
     // Policy when queue is full
     const FullPolicy FULL_POLICY;
 
+    // Message queue implementation
+    const QueueMode QUEUE_MODE;
+
+    // Maximum messages removed per lock acquisition
+    size_t m_maxBatchSize = 1;
+
+    // Wait strategy polls before parking
+    size_t m_spinCount = 0;
+    size_t m_yieldCount = 0;
+
+    // The wait promoting a queued message one priority level, or 0 for no aging
+    dmq::Duration m_agingInterval = dmq::Duration(0);
+
+    // Batch statistics. Written by the consumer thread only.
+    std::atomic<uint64_t> m_batchCount{0};
+    std::atomic<uint64_t> m_batchMessages{0};
+    std::atomic<size_t> m_batchMax{0};
+    std::atomic<uint64_t> m_batchHistogram[BatchStats::BUCKETS] = {};
+
     // Timeout duration for TIMEOUT policy
     const dmq::Duration m_dispatchTimeout;
 
@@ -217,6 +415,13 @@ private:
     dmq::Duration m_invokeMaxAll = dmq::Duration(0);
 
     uint64_t m_dispatchCountAll = 0;
+
+    // Per priority level statistics. m_levelDepth counts queued delegate messages.
+    std::atomic<size_t> m_levelDepth[dmq::PRIORITY_LEVELS] = {};
+    size_t m_levelDepthMaxAll[dmq::PRIORITY_LEVELS] = {};
+    dmq::Duration m_levelLatencyTotalWindow[dmq::PRIORITY_LEVELS] = {};
+    uint32_t m_levelLatencyCountWindow[dmq::PRIORITY_LEVELS] = {};
+    dmq::Duration m_levelLatencyMaxAll[dmq::PRIORITY_LEVELS] = {};
 #endif
 };
 
@@ -2,6 +2,7 @@
 #define _THREAD_MSG_H
 
 #include "delegate/DelegateOpt.h"
+#include <atomic>
 
 namespace dmq::os {
 
@@ -27,21 +28,29 @@ public:
 
     std::shared_ptr<dmq::DelegateMsg> GetData() const { return m_data; }
 
+	/// Get the message priority. A system message with no data, such as the exit 
+	/// message, is LOWEST so it is queued behind every delegate message.
 	dmq::Priority GetPriority() const {
-		return m_data ? m_data->GetPriority() : dmq::Priority::NORMAL;
+		return m_data ? m_data->GetPriority() : dmq::Priority::LOWEST;
 	}
 
-#if defined(DMQ_DATABUS_TOOLS)
+	/// Get the message priority level, 0 to dmq::PRIORITY_LEVELS - 1.
+	size_t GetPriorityLevel() const { return dmq::GetPriorityLevel(GetPriority()); }
+
+	/// The time the message was queued. Set when priority aging or DMQ_DATABUS_TOOLS
+	/// needs it.
 	void SetEnqueueTime(dmq::TimePoint time) { m_enqueueTime = time; }
 	dmq::TimePoint GetEnqueueTime() const { return m_enqueueTime; }
-#endif
 
 private:
+	friend class ThreadMsgQueue;
+
 	int m_id;
     std::shared_ptr<dmq::DelegateMsg> m_data;
-#if defined(DMQ_DATABUS_TOOLS)
-	dmq::TimePoint m_enqueueTime;
-#endif
+
+	// Intrusive link used by ThreadMsgQueue
+	std::atomic<ThreadMsg*> m_next{nullptr};
+	dmq::TimePoint m_enqueueTime{};
 
 	// Use fixed-block memory allocator if DMQ_ALLOCATOR set
 	XALLOCATOR
@@ -0,0 +1,117 @@
+#ifndef _THREAD_MSG_QUEUE_H
+#define _THREAD_MSG_QUEUE_H
+
+/// @file ThreadMsgQueue.h
+/// @brief Lock-free intrusive multi-producer single-consumer queue of ThreadMsg.
+///
+/// @details
+/// Used by `Thread` in `QueueMode::LOCK_FREE`. Producers link a message into the queue
+/// with one atomic exchange and never block each other or the consumer. Only the single
+/// consumer thread may call `Pop()`. The producer and consumer fields are padded onto
+/// separate cache lines, so producers posting to a busy consumer do not share a written
+/// line with it.
+///
+/// Based on the intrusive MPSC node-based queue by Dmitry Vyukov. `Pop()` may return
+/// nullptr while a producer is between its exchange and its link store; the message
+/// becomes visible a few instructions later. Callers track the message count separately
+/// to tell this apart from an empty queue.
+
+#include "ThreadMsg.h"
+#include <atomic>
+
+namespace dmq::os {
+
+class ThreadMsgQueue
+{
+public:
+    ThreadMsgQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    /// Destructor. Deletes any messages still queued.
+    ~ThreadMsgQueue() { Clear(); }
+
+    /// Append a message. Callable from any thread. The queue owns the message until
+    /// it is returned by Pop().
+    /// @param[in] msg - a message created with operator new.
+    void Push(ThreadMsg* msg)
+    {
+        msg->m_next.store(nullptr, std::memory_order_relaxed);
+        ThreadMsg* prev = m_tail.exchange(msg, std::memory_order_acq_rel);
+        prev->m_next.store(msg, std::memory_order_release);
+    }
+
+    /// Remove the oldest message. Consumer thread only.
+    /// @return The message, owned by the caller, or nullptr if none is available.
+    ThreadMsg* Pop()
+    {
+        ThreadMsg* head = m_head;
+        ThreadMsg* next = head->m_next.load(std::memory_order_acquire);
+
+        // Skip the stub node
+        if (head == &m_stub)
+        {
+            if (next == nullptr)
+                return nullptr;
+            m_head = next;
+            head = next;
+            next = next->m_next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr)
+        {
+            m_head = next;
+            return head;
+        }
+
+        // A producer is linking a newer message behind head
+        if (head != m_tail.load(std::memory_order_acquire))
+            return nullptr;
+
+        // head is the last message. Requeue the stub so head can be removed.
+        Push(&m_stub);
+        next = head->m_next.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            m_head = next;
+            return head;
+        }
+        return nullptr;
+    }
+
+    /// Get the oldest message without removing it. Consumer thread only.
+    /// @return The message, still owned by the queue, or nullptr if none is linked.
+    ///     Pop() may still return nullptr for it while a newer message is being linked.
+    ThreadMsg* Peek() const
+    {
+        if (m_head != &m_stub)
+            return m_head;
+        return m_head->m_next.load(std::memory_order_acquire);
+    }
+
+    /// Delete all queued messages. Consumer thread only, or once producers stopped.
+    void Clear()
+    {
+        while (ThreadMsg* msg = Pop())
+            delete msg;
+    }
+
+private:
+    ThreadMsgQueue(const ThreadMsgQueue&) = delete;
+    ThreadMsgQueue& operator=(const ThreadMsgQueue&) = delete;
+
+    // Padding keeping the consumer and producer fields on separate cache lines. 
+    // Padding is used instead of alignas so the queue needs no over-aligned allocation.
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    // Consumer side
+    ThreadMsg* m_head;
+    ThreadMsg m_stub{0, nullptr};
+    char m_pad[CACHE_LINE_SIZE];
+
+    // Producer side
+    std::atomic<ThreadMsg*> m_tail;
+    char m_padTail[CACHE_LINE_SIZE - sizeof(std::atomic<ThreadMsg*>)];
+};
+
+} // namespace dmq::os
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef _THREAD_MSG_RING_H
+#define _THREAD_MSG_RING_H
+
+/// @file ThreadMsgRing.h
+/// @brief Fixed-capacity FIFO of thread message slots, preallocated once.
+///
+/// @details
+/// Used by `Thread` in `QueueMode::RING`. Each slot holds the message ID and the 
+/// `DelegateMsg` directly, with no `ThreadMsg` heap allocation or `shared_ptr` wrapper,
+/// so pushing and popping never touch the heap. Not thread-safe; `Thread` guards the
+/// ring with its mutex.
+
+#include "delegate/DelegateOpt.h"
+#include "delegate/DelegateMsg.h"
+#include <memory>
+
+namespace dmq::os {
+
+class ThreadMsgRing
+{
+public:
+    /// A message stored in a slot.
+    struct Entry
+    {
+        int id = 0;
+        std::shared_ptr<dmq::DelegateMsg> data;
+        dmq::TimePoint enqueueTime;
+    };
+
+    ThreadMsgRing() = default;
+
+    /// Allocate the slots. Call once before use.
+    /// @param[in] capacity - the maximum number of queued messages.
+    void Create(size_t capacity)
+    {
+        m_slots.reset(new Entry[capacity]);
+        m_capacity = capacity;
+        m_head = 0;
+        m_count = 0;
+    }
+
+    /// Append a message.
+    /// @return false if the ring is full.
+    bool Push(int id, const std::shared_ptr<dmq::DelegateMsg>& data, dmq::TimePoint enqueueTime)
+    {
+        if (m_count == m_capacity)
+            return false;
+        Entry& slot = m_slots[(m_head + m_count) % m_capacity];
+        slot.id = id;
+        slot.data = data;
+        slot.enqueueTime = enqueueTime;
+        m_count++;
+        return true;
+    }
+
+    /// Remove the oldest message, moving it out of its slot.
+    /// @param[out] entry - receives the message.
+    /// @return false if the ring is empty.
+    bool Pop(Entry& entry)
+    {
+        if (m_count == 0)
+            return false;
+        Entry& slot = m_slots[m_head];
+        entry.id = slot.id;
+        entry.data = std::move(slot.data);
+        entry.enqueueTime = slot.enqueueTime;
+        m_head = (m_head + 1) % m_capacity;
+        m_count--;
+        return true;
+    }
+
+    /// Get the oldest message without removing it. The ring must not be empty.
+    const Entry& Front() const { return m_slots[m_head]; }
+
+    /// Release all queued messages. The slots remain allocated.
+    void Clear()
+    {
+        Entry entry;
+        while (Pop(entry))
+            entry.data.reset();
+    }
+
+    size_t Size() const { return m_count; }
+    bool Empty() const { return m_count == 0; }
+
+private:
+    ThreadMsgRing(const ThreadMsgRing&) = delete;
+    ThreadMsgRing& operator=(const ThreadMsgRing&) = delete;
+
+    std::unique_ptr<Entry[]> m_slots;
+    size_t m_capacity = 0;
+    size_t m_head = 0;
+    size_t m_count = 0;
+};
+
+} // namespace dmq::os
+
+#endif
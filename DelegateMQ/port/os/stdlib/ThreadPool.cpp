@@ -0,0 +1,329 @@
+#ifndef DMQ_THREAD_STDLIB
+#error "port/os/stdlib/ThreadPool.cpp requires DMQ_THREAD_STDLIB. Remove this file from your build configuration or define DMQ_THREAD_STDLIB."
+#endif
+
+#include "DelegateMQ.h"
+#include "ThreadPool.h"
+#include "extras/util/Fault.h"
+
+// The pool and worker index of the calling worker thread, if any
+static thread_local dmq::os::ThreadPool* t_pool = nullptr;
+static thread_local size_t t_workerIndex = 0;
+
+// The strand executing on the calling thread, if any
+static thread_local dmq::os::Strand* t_strand = nullptr;
+
+namespace dmq::os {
+
+using namespace std;
+
+//----------------------------------------------------------------------------
+// DispatchDelegate
+//----------------------------------------------------------------------------
+bool Strand::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
+{
+    if (m_pool.m_exit.load())
+        return false;
+
+    bool schedule = false;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (msg->GetPriority() >= dmq::Priority::HIGH)
+            m_highQueue.push_back(msg);
+        else
+            m_normalQueue.push_back(msg);
+
+        // Only an idle strand is handed to a worker
+        if (!m_scheduled)
+        {
+            m_scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule)
+        m_pool.Schedule(shared_from_this());
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// DispatchDelegates
+//----------------------------------------------------------------------------
+size_t Strand::DispatchDelegates(const std::shared_ptr<dmq::DelegateMsg>* msgs, size_t count)
+{
+    if (m_pool.m_exit.load() || count == 0)
+        return 0;
+
+    bool schedule = false;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (msgs[i]->GetPriority() >= dmq::Priority::HIGH)
+                m_highQueue.push_back(msgs[i]);
+            else
+                m_normalQueue.push_back(msgs[i]);
+        }
+
+        if (!m_scheduled)
+        {
+            m_scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule)
+        m_pool.Schedule(shared_from_this());
+    return count;
+}
+
+//----------------------------------------------------------------------------
+// IsCurrentThread
+//----------------------------------------------------------------------------
+bool Strand::IsCurrentThread()
+{
+    return t_strand == this;
+}
+
+//----------------------------------------------------------------------------
+// GetQueueSize
+//----------------------------------------------------------------------------
+size_t Strand::GetQueueSize()
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_highQueue.size() + m_normalQueue.size();
+}
+
+//----------------------------------------------------------------------------
+// Run
+//----------------------------------------------------------------------------
+void Strand::Run()
+{
+    Strand* previous = t_strand;
+    t_strand = this;
+
+    bool reschedule = false;
+    for (size_t count = 0; ; count++)
+    {
+        std::shared_ptr<dmq::DelegateMsg> msg;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (m_highQueue.empty() && m_normalQueue.empty())
+            {
+                // Drained. The next dispatch schedules the strand again.
+                m_scheduled = false;
+                break;
+            }
+            if (count == STRAND_BATCH_SIZE || m_pool.m_exit.load())
+            {
+                // Yield the worker to other strands
+                reschedule = true;
+                break;
+            }
+            if (!m_highQueue.empty()) {
+                msg = m_highQueue.front();
+                m_highQueue.pop_front();
+            } else {
+                msg = m_normalQueue.front();
+                m_normalQueue.pop_front();
+            }
+        }
+
+        auto invoker = msg->GetInvoker();
+        if (invoker) {
+#if defined(__cpp_exceptions) && !defined(DMQ_ASSERTS)
+            try {
+                bool success = invoker->Invoke(msg);
+                ASSERT_TRUE(success);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[ThreadPool:" << m_pool.POOL_NAME << "] Unhandled exception in delegate callback: " << e.what() << std::endl;
+                ASSERT();
+            }
+            catch (...) {
+                std::cerr << "[ThreadPool:" << m_pool.POOL_NAME << "] Unhandled unknown exception in delegate callback." << std::endl;
+                ASSERT();
+            }
+#else
+            bool success = invoker->Invoke(msg);
+            ASSERT_TRUE(success);
+#endif
+        }
+    }
+
+    t_strand = previous;
+
+    if (reschedule)
+        m_pool.Schedule(shared_from_this());
+}
+
+//----------------------------------------------------------------------------
+// ThreadPool
+//----------------------------------------------------------------------------
+ThreadPool::ThreadPool(const std::string& poolName, size_t threadCount)
+    : POOL_NAME(poolName)
+    , m_exit(false)
+    , m_pending(0)
+    , m_nextWorker(0)
+    , m_idleCount(0)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; i++)
+        m_workers.push_back(std::make_unique<Worker>());
+}
+
+//----------------------------------------------------------------------------
+// ~ThreadPool
+//----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    ExitThreads();
+}
+
+//----------------------------------------------------------------------------
+// CreateThreads
+//----------------------------------------------------------------------------
+bool ThreadPool::CreateThreads()
+{
+    for (size_t i = 0; i < m_workers.size(); i++)
+    {
+        if (!m_workers[i]->thread.joinable())
+            m_workers[i]->thread = std::thread(&ThreadPool::Process, this, i);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// ExitThreads
+//----------------------------------------------------------------------------
+void ThreadPool::ExitThreads()
+{
+    {
+        lock_guard<mutex> lock(m_idleMutex);
+        m_exit.store(true);
+        m_idleCv.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+    {
+        if (worker->thread.joinable())
+        {
+            // Exiting from a worker thread cannot join itself
+            if (worker->thread.get_id() == std::this_thread::get_id())
+                worker->thread.detach();
+            else
+                worker->thread.join();
+        }
+    }
+
+    for (auto& worker : m_workers)
+    {
+        lock_guard<mutex> lock(worker->mutex);
+        worker->queue.clear();
+    }
+    m_pending.store(0);
+}
+
+//----------------------------------------------------------------------------
+// CreateStrand
+//----------------------------------------------------------------------------
+std::shared_ptr<Strand> ThreadPool::CreateStrand()
+{
+    return std::make_shared<Strand>(*this);
+}
+
+//----------------------------------------------------------------------------
+// IsCurrentThread
+//----------------------------------------------------------------------------
+bool ThreadPool::IsCurrentThread() const
+{
+    return t_pool == this;
+}
+
+//----------------------------------------------------------------------------
+// Schedule
+//----------------------------------------------------------------------------
+void ThreadPool::Schedule(std::shared_ptr<Strand> strand)
+{
+    // Keep the strand on the current worker for cache locality, otherwise spread
+    size_t index = (t_pool == this) ? t_workerIndex :
+        m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    // Count the strand before publishing it. A worker may take the strand as soon
+    // as it is queued, and its decrement must never run ahead of this increment.
+    m_pending.fetch_add(1);
+    {
+        Worker& worker = *m_workers[index];
+        lock_guard<mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(strand));
+    }
+
+    // Pairs with the m_idleCount increment in Process() so a parking worker
+    // either sees the new strand or is woken up
+    if (m_idleCount.load() > 0)
+    {
+        lock_guard<mutex> lock(m_idleMutex);
+        m_idleCv.notify_one();
+    }
+}
+
+//----------------------------------------------------------------------------
+// TryGetStrand
+//----------------------------------------------------------------------------
+bool ThreadPool::TryGetStrand(size_t index, std::shared_ptr<Strand>& strand)
+{
+    const size_t count = m_workers.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        Worker& worker = *m_workers[(index + i) % count];
+        lock_guard<mutex> lock(worker.mutex);
+        if (worker.queue.empty())
+            continue;
+
+        if (i == 0) {
+            // Own queue: oldest first
+            strand = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        } else {
+            // Steal the newest from a victim
+            strand = std::move(worker.queue.back());
+            worker.queue.pop_back();
+        }
+        m_pending.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// Process
+//----------------------------------------------------------------------------
+void ThreadPool::Process(size_t index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    while (!m_exit.load())
+    {
+        std::shared_ptr<Strand> strand;
+        if (TryGetStrand(index, strand))
+        {
+            strand->Run();
+            continue;
+        }
+
+        // Nothing to run or steal; park until a strand is scheduled
+        std::unique_lock<std::mutex> lk(m_idleMutex);
+        m_idleCount.fetch_add(1);
+        m_idleCv.wait(lk, [this]() { return m_pending.load() > 0 || m_exit.load(); });
+        m_idleCount.fetch_sub(1);
+    }
+
+    t_pool = nullptr;
+}
+
+} // namespace dmq::os
@@ -0,0 +1,163 @@
+#ifndef _THREAD_POOL_STD_H
+#define _THREAD_POOL_STD_H
+
+/// @file ThreadPool.h
+/// @see https://github.com/DelegateMQ/DelegateMQ
+///
+/// @brief Work-stealing thread pool with serial strands implementing the DelegateMQ
+/// IThread interface.
+///
+/// @details
+/// A `Strand` is a lightweight `IThread`: a message queue without an OS thread.
+/// Delegates dispatched to a strand are invoked one at a time in FIFO order (high
+/// priority first), never concurrently, but on any of the pool's worker threads.
+/// Thousands of strands can share a handful of workers.
+///
+/// **Key Features:**
+/// * **Work Stealing:** Each worker owns a queue of runnable strands. An idle worker
+///   steals from the other workers before parking.
+/// * **Serial Execution:** A strand is queued on at most one worker at a time, so its
+///   delegates are ordered and mutually exclusive.
+/// * **Fairness:** A strand runs at most `STRAND_BATCH_SIZE` delegates per turn and is
+///   then requeued behind the other runnable strands.
+/// * **Locality:** A strand made runnable from a worker thread is queued on that worker.
+
+#include "delegate/IThread.h"
+#include <thread>
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace dmq::os {
+
+class ThreadPool;
+
+/// @brief A serial execution context scheduled onto a ThreadPool.
+/// @details Create with ThreadPool::CreateStrand(). The pool must outlive its strands.
+class Strand : public dmq::IThread, public std::enable_shared_from_this<Strand>
+{
+public:
+    /// Maximum delegates invoked per turn before yielding the worker.
+    static const size_t STRAND_BATCH_SIZE = 32;
+
+    /// Constructor
+    /// @param pool The pool executing this strand.
+    explicit Strand(ThreadPool& pool) : m_pool(pool) {}
+
+    /// Dispatch a delegate to this strand. Callable from any thread.
+    /// @param[in] msg - Delegate message containing target function arguments.
+    /// @return false if the pool is exiting.
+    virtual bool DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg) override;
+
+    /// Dispatch a batch of delegates using one lock acquisition. The strand is
+    /// scheduled at most once for the batch.
+    /// @param[in] msgs - the delegate messages, enqueued in order.
+    /// @param[in] count - the number of messages.
+    /// @return The number of messages enqueued. 0 if the pool is exiting.
+    virtual size_t DispatchDelegates(const std::shared_ptr<dmq::DelegateMsg>* msgs, size_t count) override;
+
+    /// Returns true if the calling thread is currently executing this strand.
+    virtual bool IsCurrentThread() override;
+
+    /// Get the number of queued delegates.
+    size_t GetQueueSize();
+
+private:
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    friend class ThreadPool;
+
+    /// Invoke queued delegates on the calling worker thread.
+    void Run();
+
+    ThreadPool& m_pool;
+
+    std::mutex m_mutex;
+    std::deque<std::shared_ptr<dmq::DelegateMsg>> m_highQueue;
+    std::deque<std::shared_ptr<dmq::DelegateMsg>> m_normalQueue;
+
+    // True while the strand is queued on, or executing on, a worker
+    bool m_scheduled = false;
+};
+
+/// @brief A fixed set of worker threads executing strands with work stealing.
+class ThreadPool
+{
+public:
+    /// Constructor
+    /// @param poolName The pool name for debugging.
+    /// @param threadCount The number of worker threads. 0 uses the hardware concurrency.
+    ThreadPool(const std::string& poolName, size_t threadCount = 0);
+
+    /// Destructor
+    ~ThreadPool();
+
+    /// Called once to create the worker threads.
+    /// @return true if the threads are created.
+    bool CreateThreads();
+
+    /// Called once at program exit to shut down the worker threads. Delegates not
+    /// yet invoked are discarded.
+    void ExitThreads();
+
+    /// Create a new strand executing on this pool.
+    std::shared_ptr<Strand> CreateStrand();
+
+    /// Get the number of worker threads.
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+    /// Returns true if the calling thread is one of this pool's worker threads.
+    bool IsCurrentThread() const;
+
+    /// Get the pool name.
+    const std::string& GetPoolName() const { return POOL_NAME; }
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    friend class Strand;
+
+    /// A worker thread and its queue of runnable strands.
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Strand>> queue;
+        std::thread thread;
+    };
+
+    /// Queue a runnable strand. Callable from any thread.
+    void Schedule(std::shared_ptr<Strand> strand);
+
+    /// Get a runnable strand from the worker's own queue, else steal one.
+    bool TryGetStrand(size_t index, std::shared_ptr<Strand>& strand);
+
+    /// Entry point for each worker thread.
+    void Process(size_t index);
+
+    const std::string POOL_NAME;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::atomic<bool> m_exit;
+
+    // Runnable strands queued across all workers
+    std::atomic<size_t> m_pending;
+
+    // Round robin worker for strands scheduled from non-worker threads
+    std::atomic<size_t> m_nextWorker;
+
+    // Idle workers park on m_idleCv
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCv;
+    std::atomic<size_t> m_idleCount;
+};
+
+} // namespace dmq::os
+
+#endif
@@ -325,7 +325,7 @@ bool Thread::DispatchDelegate(std::shared_ptr<dmq::DelegateMsg> msg)
 
     // Option #2: Implement High priority using tx_queue_front_send.
     UINT ret;
-    if (msg->GetPriority() == Priority::HIGH)
+    if (msg->GetPriority() >= Priority::HIGH)
         ret = tx_queue_front_send(&m_queue, &threadMsg, wait_option);
     else
         ret = tx_queue_send(&m_queue, &threadMsg, wait_option);
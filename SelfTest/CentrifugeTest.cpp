@@ -16,7 +16,7 @@ CentrifugeTest::CentrifugeTest() :
 //------------------------------------------------------------------------------
 void CentrifugeTest::Start(const StartData* data)
 {
-    ASYNC_INVOKE(CentrifugeTest, Start, data);
+    ASYNC_INVOKE_QUEUED(CentrifugeTest, Start, data);
 
     BEGIN_TRANSITION_MAP                                     // - Current State -
         TRANSITION_MAP_ENTRY(ST_START_TEST)                 // ST_IDLE
@@ -30,25 +30,6 @@ void CentrifugeTest::Start(const StartData* data)
     END_TRANSITION_MAP(data)
 }
 
-//------------------------------------------------------------------------------
-// Poll
-//------------------------------------------------------------------------------
-void CentrifugeTest::Poll()
-{
-    ASYNC_INVOKE(CentrifugeTest, Poll);
-
-    BEGIN_TRANSITION_MAP                                     // - Current State -
-        TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_IDLE
-        TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_COMPLETED
-        TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_FAILED
-        TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_START_TEST
-        TRANSITION_MAP_ENTRY(ST_WAIT_FOR_ACCELERATION)      // ST_ACCELERATION
-        TRANSITION_MAP_ENTRY(ST_WAIT_FOR_ACCELERATION)      // ST_WAIT_FOR_ACCELERATION
-        TRANSITION_MAP_ENTRY(ST_WAIT_FOR_DECELERATION)      // ST_DECELERATION
-        TRANSITION_MAP_ENTRY(ST_WAIT_FOR_DECELERATION)      // ST_WAIT_FOR_DECELERATION
-    END_TRANSITION_MAP(NULL)
-}
-
 //------------------------------------------------------------------------------
 // Idle - Idle state here overrides the SelfTest Idle state. 
 //------------------------------------------------------------------------------
@@ -58,10 +39,6 @@ STATE_DEFINE(CentrifugeTest, Idle, NoEventData)
 
     // Call base class Idle state
     SelfTest::ST_Idle(data);
-
-    // Disconnect from timer callbacks and stop the timer
-    m_pollTimerConn.Disconnect();
-    m_pollTimer.Stop();
 }
 
 //------------------------------------------------------------------------------
@@ -71,11 +48,6 @@ STATE_DEFINE(CentrifugeTest, StartTest, StartData)
 {
     SelfTestEngine::InvokeStatusSignal("CentrifugeTest::ST_StartTest");
 
-    // Connect to the timer signal using the ScopedConnection handle.
-    // Ensure the Poll() callback is marshaled to this state machine's thread.
-    m_pollTimerConn = m_pollTimer.OnExpired.Connect(
-        MakeDelegate(this, &CentrifugeTest::Poll, *GetThread()));
-
     InternalEvent(ST_ACCELERATION);
 }
 
@@ -98,8 +70,7 @@ STATE_DEFINE(CentrifugeTest, Acceleration, NoEventData)
 {
     SelfTestEngine::InvokeStatusSignal("CentrifugeTest::ST_Acceleration");
 
-    // Start polling while waiting for centrifuge to ramp up to speed
-    m_pollTimer.Start(std::chrono::milliseconds(10));
+    // The state timeout polls while waiting for centrifuge to ramp up to speed
 }
 
 //------------------------------------------------------------------------------
@@ -122,8 +93,7 @@ EXIT_DEFINE(CentrifugeTest, ExitWaitForAcceleration)
 {
     SelfTestEngine::InvokeStatusSignal("CentrifugeTest::EX_ExitWaitForAcceleration");
 
-    // Acceleration over, stop polling
-    m_pollTimer.Stop();
+    // Acceleration over. Leaving the state stops the polling timeout.
 }
 
 //------------------------------------------------------------------------------
@@ -133,8 +103,7 @@ STATE_DEFINE(CentrifugeTest, Deceleration, NoEventData)
 {
     SelfTestEngine::InvokeStatusSignal("CentrifugeTest::ST_Deceleration");
 
-    // Start polling while waiting for centrifuge to ramp down to 0
-    m_pollTimer.Start(std::chrono::milliseconds(10));
+    // The state timeout polls while waiting for centrifuge to ramp down to 0
 }
 
 //------------------------------------------------------------------------------
@@ -157,6 +126,5 @@ EXIT_DEFINE(CentrifugeTest, ExitWaitForDeceleration)
 {
     SelfTestEngine::InvokeStatusSignal("CentrifugeTest::EX_ExitWaitForDeceleration");
 
-    // Deceleration over, stop polling
-    m_pollTimer.Stop();
+    // Deceleration over. Leaving the state stops the polling timeout.
 }
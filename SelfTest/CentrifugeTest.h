@@ -4,7 +4,8 @@
 #include "SelfTest.h"
 
 // @brief CentrifugeTest shows StateMachine features including state machine
-// inheritance, state function override, and guard/entry/exit actions. 
+// inheritance, state function override, guard/entry/exit actions and state 
+// timeouts. 
 class CentrifugeTest : public SelfTest
 {
 public:
@@ -12,13 +13,11 @@ public:
     virtual void Start(const StartData* data);
 
 private:
-    void Poll();
-
-    dmq::util::Timer m_pollTimer;
-    dmq::ScopedConnection m_pollTimerConn; // RAII connection handle
-
     INT m_speed;
 
+    // Centrifuge speed polling period in milliseconds
+    static const UINT POLL_TIME = 10;
+
     enum States
     {
         ST_START_TEST = SelfTest::ST_MAX_STATES,
@@ -44,10 +43,10 @@ private:
         STATE_MAP_ENTRY_EX(&Completed)
         STATE_MAP_ENTRY_EX(&Failed)
         STATE_MAP_ENTRY_ALL_EX(&StartTest, &GuardStartTest, 0, 0)
-        STATE_MAP_ENTRY_EX(&Acceleration)
-        STATE_MAP_ENTRY_ALL_EX(&WaitForAcceleration, 0, 0, &ExitWaitForAcceleration)
-        STATE_MAP_ENTRY_EX(&Deceleration)
-        STATE_MAP_ENTRY_ALL_EX(&WaitForDeceleration, 0, 0, &ExitWaitForDeceleration)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&Acceleration, 0, 0, 0, POLL_TIME, ST_WAIT_FOR_ACCELERATION)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&WaitForAcceleration, 0, 0, &ExitWaitForAcceleration, POLL_TIME, ST_WAIT_FOR_ACCELERATION)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&Deceleration, 0, 0, 0, POLL_TIME, ST_WAIT_FOR_DECELERATION)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&WaitForDeceleration, 0, 0, &ExitWaitForDeceleration, POLL_TIME, ST_WAIT_FOR_DECELERATION)
         END_STATE_MAP_EX
 };
 
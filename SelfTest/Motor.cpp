@@ -7,23 +7,29 @@ Motor::Motor() :
     AsyncStateMachine(ST_MAX_STATES),
     m_currentSpeed(0)
 {
+    RegisterSnapshotVariable(m_currentSpeed);
     CreateThread("Motor");
+
+    // External events are delivered through the event queue
+    CreateEventQueue(8);
 }
     
 // set motor speed external event
 void Motor::SetSpeed(MotorData* data)
 {
-    /* ASYNC_INVOKE below effectively executes the following code:
+    /* ASYNC_INVOKE_LATEST below effectively executes the following code:
     // Is this function call executing on this state machine thread?
-    if (GetThreadId() != Thread::GetCurrentThreadId())
+    if (!GetThread()->IsCurrentThread())
     {
-        // Asynchronously re-invoke the SetSpeed() event on Motor's thread
-        AsyncInvoke(this, &Motor::SetSpeed, *GetThread(), data);
+        // Copy the event data into the event queue and re-invoke the SetSpeed() 
+        // event on Motor's thread. A SetSpeed() still last in the queue takes the
+        // new speed instead.
+        PostLatestEvent<&Motor::SetSpeed>(CopyEventData(data));
         return;
     }*/
 
     // Asynchronously invoke Motor::SetSpeed on the Motor thread of control
-    ASYNC_INVOKE(Motor, SetSpeed, data);
+    ASYNC_INVOKE_LATEST(Motor, SetSpeed, data);
 
     BEGIN_TRANSITION_MAP                                    // - Current State -
         TRANSITION_MAP_ENTRY(ST_START)                      // ST_IDLE
@@ -33,10 +39,11 @@ void Motor::SetSpeed(MotorData* data)
     END_TRANSITION_MAP(data)
 }
 
-// halt motor external event
+// halt motor external event. Runs ahead of the queued speed changes and discards 
+// them, since they are stale once the motor halts.
 void Motor::Halt()
 {
-    ASYNC_INVOKE(Motor, Halt);
+    ASYNC_INVOKE_PURGE(Motor, Halt);
 
     BEGIN_TRANSITION_MAP                                    // - Current State -
         TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_IDLE
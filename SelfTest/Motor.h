@@ -2,6 +2,7 @@
 #define _MOTOR_H
 
 #include "AsyncStateMachine.h"
+#include <cstring>
 
 class MotorData : public EventData
 {
@@ -18,6 +19,20 @@ public:
             << this->speed << std::endl;
     }
 
+    // Record and replay the speed with a StateJournal
+    virtual UINT Serialize(void* buffer) const override {
+        if (buffer)
+            memcpy(buffer, &speed, sizeof(speed));
+        return sizeof(speed);
+    }
+
+    virtual BOOL Deserialize(const void* buffer, UINT size) override {
+        if (size != sizeof(speed))
+            return FALSE;
+        memcpy(&speed, buffer, sizeof(speed));
+        return TRUE;
+    }
+
     INT speed;
 };
 
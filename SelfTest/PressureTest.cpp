@@ -14,7 +14,7 @@ PressureTest::PressureTest() :
 //------------------------------------------------------------------------------
 void PressureTest::Start(const StartData* data)
 {
-    ASYNC_INVOKE(PressureTest, Start, data);
+    ASYNC_INVOKE_QUEUED(PressureTest, Start, data);
 
     BEGIN_TRANSITION_MAP                                     // - Current State -
         TRANSITION_MAP_ENTRY(ST_START_TEST)                 // ST_IDLE
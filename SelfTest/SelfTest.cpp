@@ -8,6 +8,9 @@ SelfTest::SelfTest(const std::string& name, INT maxStates) :
     AsyncStateMachine(maxStates)
 {
     CreateThread(name);
+
+    // External events and state timeouts are delivered through the event queue
+    CreateEventQueue(4);
 }
 
 //------------------------------------------------------------------------------
@@ -16,6 +19,8 @@ SelfTest::SelfTest(const std::string& name, INT maxStates) :
 SelfTest::SelfTest(INT maxStates) :
     AsyncStateMachine(maxStates)
 {
+    // External events and state timeouts are delivered through the event queue
+    CreateEventQueue(4);
 }
 
 //------------------------------------------------------------------------------
@@ -23,8 +28,11 @@ SelfTest::SelfTest(INT maxStates) :
 //------------------------------------------------------------------------------
 void SelfTest::Cancel()
 {
-    // ASYNC_INVOKE ensures the transition logic runs on this machine's thread
-    ASYNC_INVOKE(SelfTest, Cancel);
+    // ASYNC_INVOKE_PURGE ensures the transition logic runs on this machine's thread,
+    // ahead of and discarding any queued events made pointless by the cancel. The
+    // other external events use ASYNC_INVOKE_QUEUED so they are ordered and purged
+    // by the event queue.
+    ASYNC_INVOKE_PURGE(SelfTest, Cancel);
 
     if (GetCurrentState() != ST_IDLE)
         ExternalEvent(ST_FAILED);
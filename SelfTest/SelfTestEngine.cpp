@@ -50,8 +50,9 @@ void SelfTestEngine::InvokeStatusSignal(std::string msg)
 //------------------------------------------------------------------------------
 void SelfTestEngine::Start(const StartData* data)
 {
-    // Asynchronously invoke on the SelfTestEngine thread of control
-    ASYNC_INVOKE(SelfTestEngine, Start, data);
+    // Queue on the SelfTestEngine thread of control, so a later Cancel() purges
+    // a Start() still waiting to execute
+    ASYNC_INVOKE_QUEUED(SelfTestEngine, Start, data);
 
     BEGIN_TRANSITION_MAP			 			 		// - Current State -
         TRANSITION_MAP_ENTRY(ST_START_CENTRIFUGE_TEST)	// ST_IDLE
@@ -67,7 +68,7 @@ void SelfTestEngine::Start(const StartData* data)
 //------------------------------------------------------------------------------
 void SelfTestEngine::Complete()
 {
-    ASYNC_INVOKE(SelfTestEngine, Complete);
+    ASYNC_INVOKE_QUEUED(SelfTestEngine, Complete);
 
     BEGIN_TRANSITION_MAP			 			 		// - Current State -
         TRANSITION_MAP_ENTRY(EVENT_IGNORED)				// ST_IDLE
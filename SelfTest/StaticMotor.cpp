@@ -0,0 +1,62 @@
+#include "StaticMotor.h"
+#include <iostream>
+
+using namespace std;
+
+StaticMotor::StaticMotor() :
+    StaticStateMachine<StaticMotor>(ST_MAX_STATES),
+    m_currentSpeed(0)
+{
+}
+    
+// set motor speed external event
+void StaticMotor::SetSpeed(const MotorData* data)
+{
+    BEGIN_TRANSITION_MAP                                    // - Current State -
+        TRANSITION_MAP_ENTRY(ST_START)                      // ST_IDLE
+        TRANSITION_MAP_ENTRY(CANNOT_HAPPEN)                 // ST_STOP
+        TRANSITION_MAP_ENTRY(ST_CHANGE_SPEED)               // ST_START
+        TRANSITION_MAP_ENTRY(ST_CHANGE_SPEED)               // ST_CHANGE_SPEED
+    END_TRANSITION_MAP(data)
+}
+
+// halt motor external event
+void StaticMotor::Halt()
+{
+    BEGIN_TRANSITION_MAP                                    // - Current State -
+        TRANSITION_MAP_ENTRY(EVENT_IGNORED)                 // ST_IDLE
+        TRANSITION_MAP_ENTRY(CANNOT_HAPPEN)                 // ST_STOP
+        TRANSITION_MAP_ENTRY(ST_STOP)                       // ST_START
+        TRANSITION_MAP_ENTRY(ST_STOP)                       // ST_CHANGE_SPEED
+    END_TRANSITION_MAP(NULL)
+}
+
+// state machine sits here when motor is not running
+STATE_DEFINE(StaticMotor, Idle, NoEventData)
+{
+    cout << "StaticMotor::ST_Idle" << endl;
+}
+
+// stop the motor 
+STATE_DEFINE(StaticMotor, Stop, NoEventData)
+{
+    cout << "StaticMotor::ST_Stop" << endl;
+    m_currentSpeed = 0; 
+
+    // transition to Idle via an internal event
+    InternalEvent(ST_IDLE);
+}
+
+// start the motor going
+STATE_DEFINE(StaticMotor, Start, MotorData)
+{
+    cout << "StaticMotor::ST_Start : Speed is " << data->speed << endl;
+    m_currentSpeed = data->speed;
+}
+
+// changes the motor speed once the motor is moving
+STATE_DEFINE(StaticMotor, ChangeSpeed, MotorData)
+{
+    cout << "StaticMotor::ST_ChangeSpeed : Speed is " << data->speed << endl;
+    m_currentSpeed = data->speed;
+}
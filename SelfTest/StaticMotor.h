@@ -0,0 +1,50 @@
+#ifndef _STATIC_MOTOR_H
+#define _STATIC_MOTOR_H
+
+#include "StaticStateMachine.h"
+#include "Motor.h"
+
+// StaticMotor is a synchronous Motor on the compile-time StaticStateMachine 
+// engine, with the same states, state map and transition maps. StaticMotor has
+// no thread of control or event queue, so external events execute synchronously
+// on the caller's thread.
+class StaticMotor : public StaticStateMachine<StaticMotor>
+{
+public:
+    StaticMotor();
+
+    // External events taken by this state machine
+    void SetSpeed(const MotorData* data);
+    void Halt();
+
+private:
+    INT m_currentSpeed; 
+
+    // State enumeration order must match the order of state method entries
+    // in the state map.
+    enum States
+    {
+        ST_IDLE,
+        ST_STOP,
+        ST_START,
+        ST_CHANGE_SPEED,
+        ST_MAX_STATES
+    };
+
+    // Define the state machine state functions with event data type
+    STATE_DECLARE(StaticMotor, 	Idle,			NoEventData)
+    STATE_DECLARE(StaticMotor, 	Stop,			NoEventData)
+    STATE_DECLARE(StaticMotor, 	Start,			MotorData)
+    STATE_DECLARE(StaticMotor, 	ChangeSpeed,	MotorData)
+
+    // State map to define state object order. Each state map entry defines a
+    // state object.
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&Stop)
+        STATE_MAP_ENTRY(&Start)
+        STATE_MAP_ENTRY(&ChangeSpeed)
+    END_STATE_MAP	
+};
+
+#endif
@@ -1,35 +1,198 @@
 #include "AsyncStateMachine.h"
+#include <algorithm>
 
 using namespace dmq;
 
-AsyncStateMachine::AsyncStateMachine(BYTE maxStates, BYTE initialState) :
+AsyncStateMachine::AsyncStateMachine(STATE_INDEX maxStates, STATE_INDEX initialState) :
     StateMachine(maxStates, initialState)
 {
+    auto invoker = std::make_shared<DispatchEventsInvoker>(this);
+    m_dispatchEventsMsg = std::make_shared<DelegateMsg>(invoker, Priority::NORMAL);
+    m_dispatchPriorityEventsMsg = std::make_shared<DelegateMsg>(invoker, Priority::HIGH);
 }
 
 AsyncStateMachine::~AsyncStateMachine()
 {
+    // Stop timeout and activity callbacks before the thread is released
+    StopStateTimeout();
+    CancelStateActivity();
 }
 
-void AsyncStateMachine::CreateThread(const std::string& threadName)
+void AsyncStateMachine::CreateThread(const std::string& threadName, dmq::os::QueueMode queueMode, size_t maxQueueSize)
+{
+    ThreadOptions options;
+    options.queueMode = queueMode;
+    options.maxQueueSize = maxQueueSize;
+    CreateThread(threadName, options);
+}
+
+void AsyncStateMachine::CreateThread(const std::string& threadName, const ThreadOptions& options)
+{
+    if (m_thread == nullptr)
+    {
+        auto thread = std::make_shared<dmq::os::Thread>(threadName, options.maxQueueSize, dmq::os::FullPolicy::FAULT,
+            dmq::DEFAULT_DISPATCH_TIMEOUT, "", options.queueMode);
+        thread->SetMaxBatchSize(options.maxBatchSize);
+        thread->SetWaitStrategy(options.spinCount, options.yieldCount);
+        thread->SetPriorityAging(options.agingInterval);
+        thread->CreateThread();
+        m_thread = thread;
+    }
+}
+
+#if defined(__linux__)
+BOOL AsyncStateMachine::CreateThread(const std::string& threadName, const dmq::os::ThreadAttributes& attributes,
+    size_t maxQueueSize)
 {
     if (m_thread == nullptr)
     {
-        m_thread = std::make_shared<dmq::os::Thread>(threadName);
-        m_thread->CreateThread();
+        auto thread = std::make_shared<dmq::os::LinuxThread>(threadName, attributes, maxQueueSize);
+        if (!thread->CreateThread())
+            return FALSE;
+        m_thread = thread;
     }
+    return TRUE;
+}
+#endif
+
+void AsyncStateMachine::CreateStrand(dmq::os::ThreadPool& pool)
+{
+    if (m_thread == nullptr)
+        m_thread = pool.CreateStrand();
 }
 
-void AsyncStateMachine::ExternalEvent(BYTE newState, const EventData* pData)
+void AsyncStateMachine::ExternalEvent(STATE_INDEX newState, const EventData* pData)
 {
     // An asyc state machine external event must only be called on the 
     // GetThread() thread. Typically this means an external event function
     // is missing the ASYNC_INVOKE macro.
-    if (GetThread()->GetThreadId() != dmq::os::Thread::GetCurrentThreadId())
+    if (!GetThread()->IsCurrentThread())
         throw std::runtime_error("External event called on wrong thread.");
 
     StateMachine::ExternalEvent(newState, pData);
 }
 
+void AsyncStateMachine::Dispatch(EVENT_INDEX event, const EventData* pData)
+{
+    // Event data cannot be marshaled by ASYNC_INVOKE as a base class EventData 
+    // pointer; the copy would slice the derived data. Post the event instead.
+    if (!GetThread() || !GetThread()->IsCurrentThread())
+        throw std::runtime_error("Dispatch called on wrong thread. Use PostEvent().");
+
+    StateMachine::Dispatch(event, pData);
+}
+
+void AsyncStateMachine::OnEventsPosted()
+{
+    if (!GetThread())
+        throw std::runtime_error("Thread is not initialized (nullptr).");
+
+    // Drain the event queue on the state machine thread
+    if (!GetThread()->DispatchDelegate(m_dispatchEventsMsg))
+    {
+        // The thread queue dropped the wakeup or timed out. The events stay queued;
+        // let the next post wake up the thread again.
+        ResetEventsPosted();
+        throw std::runtime_error("Thread message queue full. State machine events not dispatched.");
+    }
+}
+
+BOOL AsyncStateMachine::OnEventsPostedNoWait()
+{
+    if (!GetThread() || !GetThread()->TryDispatchDelegate(m_dispatchEventsMsg))
+    {
+        ResetEventsPosted();
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void AsyncStateMachine::OnPriorityEventPosted()
+{
+    if (!GetThread())
+        throw std::runtime_error("Thread is not initialized (nullptr).");
+
+    if (!GetThread()->DispatchDelegate(m_dispatchPriorityEventsMsg))
+    {
+        ResetEventsPosted();
+        throw std::runtime_error("Thread message queue full. State machine events not dispatched.");
+    }
+}
+
+size_t AsyncEventBatch::Post()
+{
+    for (const Entry& entry : m_events)
+    {
+        if (!entry.sm->GetThread())
+            throw std::runtime_error("Thread is not initialized (nullptr).");
+    }
+
+    // Group the events by thread, then by state machine, keeping the order of the
+    // events sent to each state machine
+    std::sort(m_events.begin(), m_events.end(), [](const Entry& a, const Entry& b) {
+        IThread* threadA = a.sm->GetThread().get();
+        IThread* threadB = b.sm->GetThread().get();
+        if (threadA != threadB)
+            return std::less<IThread*>()(threadA, threadB);
+        if (a.sm != b.sm)
+            return std::less<AsyncStateMachine*>()(a.sm, b.sm);
+        return a.order < b.order;
+    });
+
+    size_t posted = 0;
+    bool failed = false;
+    size_t i = 0;
+    while (i < m_events.size())
+    {
+        IThread* thread = m_events[i].sm->GetThread().get();
+
+        // Queue the events of each state machine on this thread under one lock, 
+        // collecting the wakeup messages of the state machines that need one
+        m_threadMsgs.clear();
+        m_threadMachines.clear();
+        while (i < m_events.size() && m_events[i].sm->GetThread().get() == thread)
+        {
+            AsyncStateMachine* sm = m_events[i].sm;
+            m_machineEvents.clear();
+            for (; i < m_events.size() && m_events[i].sm == sm; i++)
+                m_machineEvents.push_back(m_events[i].event);
+
+            BOOL notify = FALSE;
+            posted += sm->QueueEvents(m_machineEvents.data(), (UINT)m_machineEvents.size(), notify);
+            if (notify)
+            {
+                m_threadMsgs.push_back(sm->m_dispatchEventsMsg);
+                m_threadMachines.push_back(sm);
+            }
+        }
 
+        // One lock acquisition and one wakeup for the thread. Messages are enqueued
+        // in order, so the state machines not woken up are the last ones. Their 
+        // events stay queued until the next post wakes them up.
+        if (!m_threadMsgs.empty())
+        {
+            size_t sent = thread->DispatchDelegates(m_threadMsgs.data(), m_threadMsgs.size());
+            for (size_t j = sent; j < m_threadMachines.size(); j++)
+            {
+                m_threadMachines[j]->ResetEventsPosted();
+                failed = true;
+            }
+        }
+    }
+
+    m_events.clear();
+    m_threadMsgs.clear();
+    m_threadMachines.clear();
+
+    // Every thread was sent its wakeups before reporting the failure
+    if (failed)
+        throw std::runtime_error("Thread message queue full. State machine events not dispatched.");
+    return posted;
+}
 
+void AsyncEventBatch::Clear()
+{
+    for (const Entry& entry : m_events)
+        entry.event.Discard();
+    m_events.clear();
+}
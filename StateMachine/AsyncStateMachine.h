@@ -7,6 +7,7 @@
 #include "StateMachine.h"
 #include "DelegateMQ.h"
 #include <string>
+#include <vector>
 
 /// Helper function to simplify asynchronous function invoke
 /// @param[in] obj - a class instance 
@@ -40,12 +41,114 @@ void AsyncInvoke(C obj, F func, T& thread, Args&&... args)
     { \
         if (!GetThread()) \
             throw std::runtime_error("Thread is not initialized (nullptr)."); \
-        if (GetThread()->GetThreadId() != dmq::os::Thread::GetCurrentThreadId()) { \
+        if (!GetThread()->IsCurrentThread()) { \
             AsyncInvoke(this, &stateMachine::stateName, *GetThread(), ##__VA_ARGS__); \
             return; \
         } \
     }
 
+/// Helper function to copy coalescing external event data onto the heap
+/// @param[in] data - the event data, if any
+/// @return A heap copy of data, or nullptr
+inline const EventData* CopyEventData() { return nullptr; }
+
+template <typename Data>
+Data* CopyEventData(const Data* data)
+{
+    return data ? new Data(*data) : nullptr;
+}
+
+// Macro to simplify a coalescing external event. Unlike ASYNC_INVOKE, repeated
+// calls made while an earlier call is the last queued event replace its event 
+// data, so the state machine thread only processes the latest value. The
+// event data is copied using its copy constructor. Requires CreateEventQueue(). 
+// If the event queue is full and the event cannot replace the last queued event, 
+// the event is discarded and an exception thrown.
+// stateMachine - the state machine class name
+// stateName - the state machine external event function name
+// ... - the stateName function argument, if any
+#define ASYNC_INVOKE_LATEST(stateMachine, stateName, ...) \
+    { \
+        if (!GetThread()) \
+            throw std::runtime_error("Thread is not initialized (nullptr)."); \
+        if (!GetThread()->IsCurrentThread()) { \
+            if (!PostLatestEvent<&stateMachine::stateName>(CopyEventData(__VA_ARGS__))) \
+                throw std::runtime_error("Event queue full. Event discarded."); \
+            return; \
+        } \
+    }
+
+// Macro to simplify a queued external event. Same as ASYNC_INVOKE, except the event
+// is inserted into the state machine event queue instead of sending a delegate
+// message per event. The event data is copied using its copy constructor into the
+// event data pool, so posting an event performs no heap allocation. Requires
+// CreateEventQueue(). If the event queue is full, the event is discarded and an 
+// exception thrown.
+// stateMachine - the state machine class name
+// stateName - the state machine external event function name
+// ... - the stateName function argument, if any
+#define ASYNC_INVOKE_QUEUED(stateMachine, stateName, ...) \
+    { \
+        if (!GetThread()) \
+            throw std::runtime_error("Thread is not initialized (nullptr)."); \
+        if (!GetThread()->IsCurrentThread()) { \
+            if (!PostEvent<&stateMachine::stateName>(CopyEventData(__VA_ARGS__))) \
+                throw std::runtime_error("Event queue full. Event discarded."); \
+            return; \
+        } \
+    }
+
+// Macro to simplify an external event taking ownership of its event data. The 
+// external event function takes a std::unique_ptr event data argument, which moves 
+// to the state machine thread through the event queue without a copy. The event data
+// is deleted once the state action completes. Requires CreateEventQueue(). If the 
+// event queue is full, the event data is deleted and an exception thrown.
+// stateMachine - the state machine class name
+// stateName - the state machine external event function name
+// data - the stateName std::unique_ptr function argument
+#define ASYNC_INVOKE_MOVE(stateMachine, stateName, data) \
+    { \
+        if (!GetThread()) \
+            throw std::runtime_error("Thread is not initialized (nullptr)."); \
+        if (!GetThread()->IsCurrentThread()) { \
+            if (!PostEvent<&stateMachine::stateName>(data.release())) \
+                throw std::runtime_error("Event queue full. Event discarded."); \
+            return; \
+        } \
+    }
+
+// Macros to simplify a priority external event. Same as ASYNC_INVOKE_QUEUED, except
+// the event executes ahead of the normal events queued to the state machine and the
+// thread. ASYNC_INVOKE_PURGE also discards the queued normal external events, so an
+// abort event such as Cancel() runs next and the discarded events never execute.
+// Requires CreateEventQueue(). The event queue reserves room for one priority event;
+// if priority events fill the queue the event is discarded and an exception thrown,
+// since a lost abort event must not go unnoticed.
+// stateMachine - the state machine class name
+// stateName - the state machine external event function name
+// ... - the stateName function argument, if any
+#define ASYNC_INVOKE_PRIORITY(stateMachine, stateName, ...) \
+    { \
+        if (!GetThread()) \
+            throw std::runtime_error("Thread is not initialized (nullptr)."); \
+        if (!GetThread()->IsCurrentThread()) { \
+            if (!PostPriorityEvent<&stateMachine::stateName>(CopyEventData(__VA_ARGS__))) \
+                throw std::runtime_error("Event queue full. Priority event discarded."); \
+            return; \
+        } \
+    }
+
+#define ASYNC_INVOKE_PURGE(stateMachine, stateName, ...) \
+    { \
+        if (!GetThread()) \
+            throw std::runtime_error("Thread is not initialized (nullptr)."); \
+        if (!GetThread()->IsCurrentThread()) { \
+            if (!PostPriorityEvent<&stateMachine::stateName>(CopyEventData(__VA_ARGS__), TRUE)) \
+                throw std::runtime_error("Event queue full. Priority event discarded."); \
+            return; \
+        } \
+    }
+
 // AsyncStateMachine is a StateMachine and uses a Thread. Thread provides
 // a C++ std::thread worker thread with a message queue. A delegate asynchronous 
 // function invocation inserts a message into the message queue using 
@@ -54,36 +157,227 @@ void AsyncInvoke(C obj, F func, T& thread, Args&&... args)
 // Thread uses a std::thread, however any OS thread API is possible. The only 
 // requirement is that the thread implement DispatchDelegate() for queue insertion.
 // The destination thread must dequeue the delegate message and call DelegateInvoke().
+// Alternatively, CreateStrand() executes the state machine on a shared ThreadPool,
+// allowing many thousands of state machines without one OS thread each. 
 // See https://github.com/endurodave/AsyncMulticastDelegateModern
 class AsyncStateMachine : public StateMachine
 {
 public:
     ///	Constructor.
     ///	@param[in] maxStates - the maximum number of state machine states.
-    AsyncStateMachine(BYTE maxStates, BYTE initialState = 0);
+    AsyncStateMachine(STATE_INDEX maxStates, STATE_INDEX initialState = 0);
+
+    /// @brief Options applied to the thread created by CreateThread(). The thread 
+    /// settings must be made before the thread starts, so they are passed together.
+    struct ThreadOptions
+    {
+        /// The thread message queue implementation. Use QueueMode::LOCK_FREE when 
+        /// many threads generate events, or QueueMode::RING for a thread message 
+        /// queue that never allocates.
+        dmq::os::QueueMode queueMode = dmq::os::QueueMode::MUTEX;
+
+        /// The maximum number of thread messages, or 0 for unlimited. Required by 
+        /// QueueMode::RING. A full queue faults.
+        size_t maxQueueSize = 0;
+
+        /// The maximum number of messages removed per lock acquisition. See 
+        /// Thread::SetMaxBatchSize().
+        size_t maxBatchSize = 1;
+
+        /// The busy-spin and yield polls of an idle thread before it parks. See 
+        /// Thread::SetWaitStrategy().
+        size_t spinCount = 0;
+        size_t yieldCount = 0;
+
+        /// The wait promoting a queued message one priority level, or 0 for strict 
+        /// priority. See Thread::SetPriorityAging().
+        dmq::Duration agingInterval = dmq::Duration(0);
+    };
 
     /// Destructor
     virtual ~AsyncStateMachine();
 
     /// Create a new thread for this state machine
     /// @param[in] threadName - the thread name
-    void CreateThread(const std::string& threadName);
+    /// @param[in] queueMode - the thread message queue implementation. Use 
+    ///     QueueMode::LOCK_FREE when many threads generate events, or QueueMode::RING
+    ///     for a thread message queue that never allocates.
+    /// @param[in] maxQueueSize - the maximum number of thread messages, or 0 for 
+    ///     unlimited. Required by QueueMode::RING. A full queue faults.
+    void CreateThread(const std::string& threadName, 
+        dmq::os::QueueMode queueMode = dmq::os::QueueMode::MUTEX, size_t maxQueueSize = 0);
+
+    /// Create a new thread for this state machine, configured by the options. For
+    /// example, a latency critical state machine thread:
+    ///     ThreadOptions options;
+    ///     options.maxBatchSize = 32;
+    ///     options.spinCount = 200000;
+    ///     CreateThread("MotorControl", options);
+    /// @param[in] threadName - the thread name
+    /// @param[in] options - the thread options
+    void CreateThread(const std::string& threadName, const ThreadOptions& options);
+
+#if defined(__linux__)
+    /// Create a new native Linux thread for this state machine, pinned to CPUs or 
+    /// running at realtime priority as given by the attributes.
+    /// @param[in] threadName - the thread name, shown by top -H and debuggers
+    /// @param[in] attributes - the CPU set, scheduling policy and priority, and stack size
+    /// @param[in] maxQueueSize - the maximum number of thread messages, or 0 for 
+    ///     unlimited. A full queue faults.
+    /// @return TRUE if created. FALSE if the system rejected the attributes, for 
+    ///     instance SCHED_FIFO without privilege; no thread is attached.
+    /// LinuxThread always drains its whole queue per wakeup, parks without spinning,
+    /// and uses strict priority, so ThreadOptions do not apply.
+    BOOL CreateThread(const std::string& threadName, const dmq::os::ThreadAttributes& attributes,
+        size_t maxQueueSize = 0);
+#endif
+
+    /// Create a new strand for this state machine. Events execute serially on 
+    /// any of the pool worker threads. 
+    /// @param[in] pool - the thread pool. Must outlive the state machine.
+    void CreateStrand(dmq::os::ThreadPool& pool);
 
     /// Set a thread for this state machine
-    /// @param[in] thread - a Thread instance
-    void SetThread(std::shared_ptr<dmq::os::Thread> thread) { m_thread = thread;  }
+    /// @param[in] thread - a Thread or Strand instance
+    void SetThread(std::shared_ptr<dmq::IThread> thread) { m_thread = thread;  }
 
     /// Get the thread attached to this state machine
-    /// @return A Thread instance
-    std::shared_ptr<dmq::os::Thread> GetThread() { return m_thread; }
+    /// @return A Thread or Strand instance
+    const std::shared_ptr<dmq::IThread>& GetThread() const { return m_thread; }
+
+    /// Generate an external event by event ID. Must be called on the state machine
+    /// thread. Other threads use PostEvent() with an event ID instead.
+    /// @see StateMachine::Dispatch()
+    void Dispatch(EVENT_INDEX event, const EventData* pData = NULL);
 
 protected:
     /// @see StateMachine::ExternalEvent()
-    void ExternalEvent(BYTE newState, const EventData* pData = NULL);
+    void ExternalEvent(STATE_INDEX newState, const EventData* pData = NULL);
+
+    /// @see StateMachine::ExternalEvent()
+    template <class Data>
+    void ExternalEvent(STATE_INDEX newState, std::unique_ptr<Data>& pData)
+    {
+        ExternalEvent(newState, TransferEventData(pData));
+    }
+
+    /// Dispatch queued events on the state machine thread. One thread message
+    /// is sent per batch of posted events. Throws std::runtime_error if the thread
+    /// queue rejects the message; the events stay queued until the next post.
+    /// @see StateMachine::OnEventsPosted()
+    virtual void OnEventsPosted() override;
+
+    /// Dispatch queued events without waiting for room in the thread queue. The 
+    /// events stay queued if the thread queue is full.
+    /// @see StateMachine::OnEventsPostedNoWait()
+    virtual BOOL OnEventsPostedNoWait() override;
+
+    /// Dispatch queued events using a high priority thread message, so a priority
+    /// event also runs ahead of other messages queued to the thread.
+    /// @see StateMachine::OnPriorityEventPosted()
+    virtual void OnPriorityEventPosted() override;
 
 private:
-    // The worker thread instance the state machine executes on
-    std::shared_ptr<dmq::os::Thread> m_thread = nullptr;
+    friend class AsyncEventBatch;
+
+    /// Invokes DispatchEvents() on the state machine thread.
+    class DispatchEventsInvoker : public dmq::IThreadInvoker
+    {
+    public:
+        explicit DispatchEventsInvoker(StateMachine* sm) : m_sm(sm) {}
+        virtual bool Invoke(std::shared_ptr<dmq::DelegateMsg> /*msg*/) override
+        {
+            m_sm->DispatchEvents();
+            return true;
+        }
+    private:
+        StateMachine* const m_sm;
+    };
+
+    // The worker thread or strand instance the state machine executes on
+    std::shared_ptr<dmq::IThread> m_thread = nullptr;
+
+    // The thread messages sent by OnEventsPosted() and OnPriorityEventPosted(). 
+    // Created once and reused by every batch, since the messages hold no arguments.
+    std::shared_ptr<dmq::DelegateMsg> m_dispatchEventsMsg;
+    std::shared_ptr<dmq::DelegateMsg> m_dispatchPriorityEventsMsg;
+};
+
+// AsyncEventBatch posts many external events at once, such as a decoded network 
+// frame holding setpoints for many state machines. Events are grouped by destination
+// thread: each state machine event queue is locked once, and each thread receives all
+// of its wakeup messages using one DispatchDelegates() call, so one lock acquisition
+// and one wakeup per thread. Events to the same state machine keep their order. Each
+// state machine requires CreateEventQueue(). For example:
+//    AsyncEventBatch batch;
+//    for (int i = 0; i < 64; i++)
+//        batch.Add<&Motor::SetSpeed>(motors[i], new MotorData(speeds[i]));
+//    batch.Post();
+class AsyncEventBatch
+{
+public:
+    AsyncEventBatch() = default;
+
+    /// Destructor. Deletes the event data of events not posted.
+    ~AsyncEventBatch() { Clear(); }
+
+    /// Add an external event. See StateMachine::PostEvent().
+    /// @param[in] sm - the destination state machine.
+    /// @param[in] pData - the event data sent to the event function, if any. Must be
+    ///     created on the heap.
+    template <auto Event, class T, class Data = const EventData>
+    void Add(T& sm, Data* pData = nullptr)
+    {
+        typedef ExternalEventTraits<decltype(Event)> Traits;
+        static_assert(std::is_base_of<typename Traits::StateMachineType, T>::value,
+            "Event function is not a member of the destination state machine.");
+        static_assert(std::is_base_of<AsyncStateMachine, T>::value,
+            "Destination must be an AsyncStateMachine.");
+        m_events.push_back({ &sm, m_events.size(), StateMachine::BatchEvent::Create<Event>(pData) });
+    }
+
+    /// Add an external event by event ID. See StateMachine::PostEvent().
+    /// @param[in] sm - the destination state machine.
+    /// @param[in] event - the event ID. An index into the event map.
+    /// @param[in] pData - the event data sent to the state, if any. Must be created on
+    ///     the heap.
+    void Add(AsyncStateMachine& sm, EVENT_INDEX event, const EventData* pData = nullptr)
+    {
+        m_events.push_back({ &sm, m_events.size(), StateMachine::BatchEvent::Create(event, pData) });
+    }
+
+    /// Get the number of events added and not yet posted.
+    size_t GetSize() const { return m_events.size(); }
+
+    /// Post all added events and empty the batch. The batch is reusable; its buffers
+    /// are kept, so a steady state batch performs no heap allocation when posting.
+    /// @return The number of events queued. Events that do not fit in a state 
+    ///     machine event queue are discarded. Throws std::runtime_error once all
+    ///     events are queued if a thread queue rejected a wakeup message; those
+    ///     events stay queued until the next post to their state machine.
+    size_t Post();
+
+    /// Discard all added events.
+    void Clear();
+
+private:
+    AsyncEventBatch(const AsyncEventBatch&) = delete;
+    AsyncEventBatch& operator=(const AsyncEventBatch&) = delete;
+
+    struct Entry
+    {
+        AsyncStateMachine* sm;
+        size_t order;
+        StateMachine::BatchEvent event;
+    };
+
+    // The added events
+    std::vector<Entry> m_events;
+
+    // Scratch buffers reused by each Post()
+    std::vector<StateMachine::BatchEvent> m_machineEvents;
+    std::vector<std::shared_ptr<dmq::DelegateMsg>> m_threadMsgs;
+    std::vector<AsyncStateMachine*> m_threadMachines;
 };
 
 #endif // _ASYNC_STATE_MACHINE_H
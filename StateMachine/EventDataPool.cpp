@@ -0,0 +1,137 @@
+#include "EventDataPool.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	/// A free block within a size class. The link overlays the unused block memory.
+	struct Block
+	{
+		Block* next;
+	};
+
+	/// A single size class free list.
+	struct SizeClass
+	{
+		std::mutex lock;
+		Block* freeList = nullptr;
+		size_t blockAllocs = 0;
+		size_t blockFrees = 0;
+		size_t slabAllocs = 0;
+	};
+
+	// Size classes 16, 32, 64, 128 and 256 bytes
+	const int NUM_SIZE_CLASSES = 5;
+
+	SizeClass& GetSizeClass(int index)
+	{
+		// Intentionally leaked so the pool outlives any static state machine
+		static SizeClass* sizeClasses = new SizeClass[NUM_SIZE_CLASSES];
+		return sizeClasses[index];
+	}
+
+	std::atomic<size_t> heapAllocs(0);
+
+	int GetSizeClassIndex(size_t size)
+	{
+		int index = 0;
+		size_t blockSize = EventDataPool::MIN_BLOCK_SIZE;
+		while (blockSize < size)
+		{
+			blockSize <<= 1;
+			index++;
+		}
+		return index;
+	}
+}
+
+//----------------------------------------------------------------------------
+// Allocate
+//----------------------------------------------------------------------------
+void* EventDataPool::Allocate(size_t size)
+{
+	void* ptr = TryAllocate(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+//----------------------------------------------------------------------------
+// TryAllocate
+//----------------------------------------------------------------------------
+void* EventDataPool::TryAllocate(size_t size) noexcept
+{
+	if (size > MAX_BLOCK_SIZE)
+	{
+		heapAllocs++;
+		return ::operator new(size, std::nothrow);
+	}
+
+	int index = GetSizeClassIndex(size);
+	SizeClass& sizeClass = GetSizeClass(index);
+	std::lock_guard<std::mutex> lock(sizeClass.lock);
+
+	// Free list empty? Grow the pool by one slab.
+	if (sizeClass.freeList == nullptr)
+	{
+		const size_t blockSize = size_t(MIN_BLOCK_SIZE) << index;
+		char* slab = static_cast<char*>(::operator new(blockSize * BLOCKS_PER_SLAB, std::nothrow));
+		if (slab == nullptr)
+			return nullptr;
+		for (int i = BLOCKS_PER_SLAB - 1; i >= 0; i--)
+		{
+			Block* block = reinterpret_cast<Block*>(slab + (blockSize * i));
+			block->next = sizeClass.freeList;
+			sizeClass.freeList = block;
+		}
+		sizeClass.slabAllocs++;
+	}
+
+	Block* block = sizeClass.freeList;
+	sizeClass.freeList = block->next;
+	sizeClass.blockAllocs++;
+	return block;
+}
+
+//----------------------------------------------------------------------------
+// Deallocate
+//----------------------------------------------------------------------------
+void EventDataPool::Deallocate(void* ptr, size_t size)
+{
+	if (ptr == nullptr)
+		return;
+
+	if (size > MAX_BLOCK_SIZE)
+	{
+		::operator delete(ptr);
+		return;
+	}
+
+	SizeClass& sizeClass = GetSizeClass(GetSizeClassIndex(size));
+	std::lock_guard<std::mutex> lock(sizeClass.lock);
+
+	Block* block = static_cast<Block*>(ptr);
+	block->next = sizeClass.freeList;
+	sizeClass.freeList = block;
+	sizeClass.blockFrees++;
+}
+
+//----------------------------------------------------------------------------
+// GetStats
+//----------------------------------------------------------------------------
+EventDataPool::Stats EventDataPool::GetStats()
+{
+	Stats stats = {};
+	for (int i = 0; i < NUM_SIZE_CLASSES; i++)
+	{
+		SizeClass& sizeClass = GetSizeClass(i);
+		std::lock_guard<std::mutex> lock(sizeClass.lock);
+		stats.blockAllocs += sizeClass.blockAllocs;
+		stats.blockFrees += sizeClass.blockFrees;
+		stats.slabAllocs += sizeClass.slabAllocs;
+	}
+	stats.blocksInUse = stats.blockAllocs - stats.blockFrees;
+	stats.heapAllocs = heapAllocs.load();
+	return stats;
+}
@@ -0,0 +1,47 @@
+#ifndef _EVENT_DATA_POOL_H
+#define _EVENT_DATA_POOL_H
+
+#include <cstddef>
+
+/// @brief EventDataPool is a fixed-block allocator for EventData objects. Blocks
+/// are carved from slabs within power-of-two size classes and recycled on a free
+/// list. Slab memory is never returned to the heap, so once the pool is warmed up
+/// the state engine makes no heap calls to create or delete event data. Allocations
+/// larger than MAX_BLOCK_SIZE are routed to the global heap. The class is thread-safe.
+class EventDataPool
+{
+public:
+	enum { MIN_BLOCK_SIZE = 16, MAX_BLOCK_SIZE = 256, BLOCKS_PER_SLAB = 32 };
+
+	/// @brief Allocation counters. Compare two snapshots to verify a steady state
+	/// is allocation-free: heapAllocs and slabAllocs must not change.
+	struct Stats
+	{
+		size_t blockAllocs;		// Blocks handed out from the pool
+		size_t blockFrees;		// Blocks returned to the pool
+		size_t blocksInUse;		// Blocks currently handed out
+		size_t slabAllocs;		// Heap allocations used to grow the pool
+		size_t heapAllocs;		// Oversize allocations routed to the global heap
+	};
+
+	/// Allocate a block. Throws std::bad_alloc if the pool cannot grow.
+	/// @param[in] size - the object size in bytes.
+	/// @return A pointer to the memory block.
+	static void* Allocate(size_t size);
+
+	/// Allocate a block without throwing.
+	/// @param[in] size - the object size in bytes.
+	/// @return A pointer to the memory block or nullptr if the pool cannot grow.
+	static void* TryAllocate(size_t size) noexcept;
+
+	/// Return a block to the pool.
+	/// @param[in] ptr - a pointer returned by Allocate().
+	/// @param[in] size - the object size in bytes passed to Allocate().
+	static void Deallocate(void* ptr, size_t size);
+
+	/// Get the pool allocation counters.
+	/// @return The counters summed over all size classes.
+	static Stats GetStats();
+};
+
+#endif // _EVENT_DATA_POOL_H
@@ -0,0 +1,202 @@
+#ifndef _STATE_COROUTINE_H
+#define _STATE_COROUTINE_H
+
+// Coroutine state actions. A state action starts a coroutine member function returning
+// StateTask. The coroutine becomes the state activity: it executes on the state machine
+// thread and may suspend using co_await Delay() or co_await WaitEvent() without
+// blocking the thread. Any state executing next, including the same state, destroys
+// the coroutine. For example:
+//
+//    STATE_DEFINE(CentrifugeTest, WaitForAcceleration, NoEventData)
+//    {
+//        Accelerate();
+//    }
+//
+//    StateTask CentrifugeTest::Accelerate()
+//    {
+//        while (m_speed < 5)
+//        {
+//            co_await Delay(10);
+//            m_speed++;
+//        }
+//        ExternalEvent(ST_DECELERATION);
+//    }
+//
+// The coroutine first executes after the state action returns, so it generates
+// transitions using ExternalEvent(), never InternalEvent(). The state machine must
+// call CreateEventQueue(). Requires C++20; StateMachine itself remains C++17.
+
+#include "StateMachine.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "StateCoroutine.h requires C++20 coroutines. Build with CMAKE_CXX_STANDARD 20."
+#endif
+
+#include <coroutine>
+
+class StateCoroutine;
+
+/// @brief The return type of a coroutine state activity. The coroutine must be a
+/// member function of a StateMachine derived class, called from a state action.
+class StateTask
+{
+public:
+	struct promise_type
+	{
+		/// Bind the coroutine to the state machine the member function is called on.
+		template <class SM, class... Args>
+		promise_type(SM& sm, Args&...) : Machine(&sm)
+		{
+			static_assert(std::is_base_of<StateMachine, std::remove_reference_t<SM>>::value,
+				"A StateTask coroutine must be a StateMachine member function.");
+		}
+
+		StateTask get_return_object();
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() { throw; }
+
+		StateMachine* const Machine;
+		StateCoroutine* Activity = nullptr;
+	};
+};
+
+/// @brief A coroutine running as the state activity. Owned by the state machine.
+class StateCoroutine : public StateActivity
+{
+public:
+	explicit StateCoroutine(std::coroutine_handle<StateTask::promise_type> handle) :
+		m_handle(handle) {}
+
+	~StateCoroutine() { m_handle.destroy(); }
+
+	/// @see StateActivity::Resume
+	virtual void Resume() override
+	{
+		if (m_wait == WAIT_RESUME)
+		{
+			m_wait = WAIT_NONE;
+			m_handle.resume();
+		}
+	}
+
+	/// @see StateActivity::OnEvent
+	virtual BOOL OnEvent(EVENT_INDEX event, const EventData* pData) override
+	{
+		if (m_wait != WAIT_EVENT || event != m_event)
+			return FALSE;
+
+		m_wait = WAIT_NONE;
+		*m_pEventData = pData;
+		m_handle.resume();
+		return TRUE;
+	}
+
+	/// Suspend until the next Resume().
+	void WaitResume() { m_wait = WAIT_RESUME; }
+
+	/// Suspend until an event is dispatched by ID.
+	/// @param[in] event - the event ID.
+	/// @param[out] pEventData - receives the event data.
+	void WaitEvent(EVENT_INDEX event, const EventData** pEventData)
+	{
+		m_wait = WAIT_EVENT;
+		m_event = event;
+		m_pEventData = pEventData;
+	}
+
+private:
+	StateCoroutine(const StateCoroutine&) = delete;
+	StateCoroutine& operator=(const StateCoroutine&) = delete;
+
+	enum Wait { WAIT_NONE, WAIT_RESUME, WAIT_EVENT };
+
+	std::coroutine_handle<StateTask::promise_type> m_handle;
+	Wait m_wait = WAIT_NONE;
+	EVENT_INDEX m_event = 0;
+	const EventData** m_pEventData = nullptr;
+};
+
+inline StateTask StateTask::promise_type::get_return_object()
+{
+	// Register the coroutine as the state activity and start it once the state
+	// action returns
+	Activity = new StateCoroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+	Activity->WaitResume();
+	Machine->SetStateActivity(Activity);
+	Machine->ResumeStateActivity(Machine->GetStateActivityGeneration());
+	return StateTask();
+}
+
+/// @brief Awaitable suspending a coroutine state activity for a time. The delay runs on
+/// the shared StateTimerWheel and is stopped if the coroutine is destroyed first.
+class StateDelay
+{
+public:
+	explicit StateDelay(UINT timeout) : m_timeout(timeout), m_timer(&OnExpired, this) {}
+
+	~StateDelay()
+	{
+		if (m_machine != nullptr)
+			StateTimerWheel::GetInstance().Stop(m_timer);
+	}
+
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(std::coroutine_handle<StateTask::promise_type> handle)
+	{
+		m_machine = handle.promise().Machine;
+		m_generation = m_machine->GetStateActivityGeneration();
+		handle.promise().Activity->WaitResume();
+		StateTimerWheel::GetInstance().Start(m_timer, m_timeout);
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+	/// Called on the timer thread; resume on the state machine thread.
+	static void OnExpired(void* context, UINT /*generation*/)
+	{
+		StateDelay* self = static_cast<StateDelay*>(context);
+		self->m_machine->ResumeStateActivity(self->m_generation);
+	}
+
+	const UINT m_timeout;
+	StateTimer m_timer;
+	StateMachine* m_machine = nullptr;
+	UINT m_generation = 0;
+};
+
+/// @brief Awaitable suspending a coroutine state activity until an event is dispatched
+/// by ID using Dispatch() or PostEvent(). The awaited event is consumed by the coroutine
+/// instead of the event map. co_await returns the event data, valid until the
+/// coroutine suspends again.
+class StateEventWait
+{
+public:
+	explicit StateEventWait(EVENT_INDEX event) : m_event(event) {}
+
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(std::coroutine_handle<StateTask::promise_type> handle)
+	{
+		handle.promise().Activity->WaitEvent(m_event, &m_pData);
+	}
+
+	const EventData* await_resume() const noexcept { return m_pData; }
+
+private:
+	const EVENT_INDEX m_event;
+	const EventData* m_pData = nullptr;
+};
+
+/// Suspend the coroutine state activity for a time.
+/// @param[in] timeout - the delay in milliseconds.
+inline StateDelay Delay(UINT timeout) { return StateDelay(timeout); }
+
+/// Suspend the coroutine state activity until an event is dispatched by ID.
+/// @param[in] event - the event ID.
+inline StateEventWait WaitEvent(EVENT_INDEX event) { return StateEventWait(event); }
+
+#endif // _STATE_COROUTINE_H
@@ -0,0 +1,85 @@
+#include "StateHierarchy.h"
+#include "Fault.h"
+#include <mutex>
+
+namespace
+{
+	/// A cached hierarchy keyed by the state map address.
+	struct CacheEntry
+	{
+		const void* key;
+		const StateHierarchy* hierarchy;
+		CacheEntry* next;
+	};
+
+	CacheEntry* cacheHead = nullptr;
+	std::mutex cacheLock;
+}
+
+//----------------------------------------------------------------------------
+// Get
+//----------------------------------------------------------------------------
+const StateHierarchy* StateHierarchy::Get(const void* key, const std::vector<STATE_INDEX>& parents)
+{
+	std::lock_guard<std::mutex> lock(cacheLock);
+	for (CacheEntry* entry = cacheHead; entry != nullptr; entry = entry->next)
+	{
+		if (entry->key == key)
+			return entry->hierarchy;
+	}
+
+	// Intentionally never deleted; shared by all instances for the program lifetime
+	CacheEntry* entry = new CacheEntry{ key, new StateHierarchy(parents), cacheHead };
+	cacheHead = entry;
+	return entry->hierarchy;
+}
+
+//----------------------------------------------------------------------------
+// StateHierarchy
+//----------------------------------------------------------------------------
+StateHierarchy::StateHierarchy(const std::vector<STATE_INDEX>& parents) :
+	m_maxStates(static_cast<STATE_INDEX>(parents.size())),
+	m_pathIndex(parents.size() * parents.size())
+{
+	// Ancestor chain of each state, innermost (the state itself) first
+	std::vector<std::vector<STATE_INDEX>> chains(m_maxStates);
+	for (STATE_INDEX state = 0; state < m_maxStates; state++)
+	{
+		for (STATE_INDEX s = state; s != NO_PARENT; s = parents[s])
+		{
+			// A parent must be a valid state and the hierarchy must not contain a cycle
+			ASSERT_TRUE(s < m_maxStates && chains[state].size() < m_maxStates);
+			chains[state].push_back(s);
+		}
+	}
+
+	for (STATE_INDEX source = 0; source < m_maxStates; source++)
+	{
+		for (STATE_INDEX target = 0; target < m_maxStates; target++)
+		{
+			const std::vector<STATE_INDEX>& exitChain = chains[source];
+			const std::vector<STATE_INDEX>& entryChain = chains[target];
+
+			// Strip the common ancestors from the outermost end of both chains
+			size_t exitCount = exitChain.size();
+			size_t entryCount = entryChain.size();
+			while (exitCount > 0 && entryCount > 0 &&
+				exitChain[exitCount - 1] == entryChain[entryCount - 1])
+			{
+				exitCount--;
+				entryCount--;
+			}
+
+			PathIndex& index = m_pathIndex[(size_t)source * m_maxStates + target];
+			index.Offset = static_cast<UINT>(m_pathStates.size());
+			index.ExitCount = static_cast<STATE_INDEX>(exitCount);
+			index.EntryCount = static_cast<STATE_INDEX>(entryCount);
+
+			// Exit innermost first, then enter outermost first
+			for (size_t i = 0; i < exitCount; i++)
+				m_pathStates.push_back(exitChain[i]);
+			for (size_t i = entryCount; i > 0; i--)
+				m_pathStates.push_back(entryChain[i - 1]);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef _STATE_HIERARCHY_H
+#define _STATE_HIERARCHY_H
+
+#include "StateIndex.h"
+#include <vector>
+
+/// @brief StateHierarchy holds the precomputed exit and entry paths of a hierarchical
+/// state map. Each state map row optionally names a parent (composite) state. For every
+/// (source, target) state pair, the states exited (source up to, but excluding, the least
+/// common ancestor) and entered (below the least common ancestor down to target) are
+/// computed once per state map, so a transition walks a flat list instead of climbing
+/// the tree. If target is an ancestor of source, or vice versa, the ancestor is neither
+/// exited nor entered (local transition).
+class StateHierarchy
+{
+public:
+	/// The Parent value of a state without a parent state.
+	static const STATE_INDEX NO_PARENT = STATE_INDEX_MAX;
+
+	/// @brief A precomputed transition path.
+	struct Path
+	{
+		const STATE_INDEX* Exit;	// States to exit, innermost first
+		STATE_INDEX ExitCount;
+		const STATE_INDEX* Entry;	// States to enter, outermost first
+		STATE_INDEX EntryCount;
+	};
+
+	/// Get the hierarchy for a state map, creating it on first use. The hierarchy is
+	/// shared by all state machine instances using the same state map. Thread-safe.
+	/// @param[in] pStateMap - the state map. Each row has a Parent member.
+	/// @param[in] maxStates - the number of state map rows.
+	/// @return The hierarchy or NULL if no state has a parent state.
+	template <class Row>
+	static const StateHierarchy* Get(const Row* pStateMap, STATE_INDEX maxStates)
+	{
+		std::vector<STATE_INDEX> parents(maxStates);
+		BOOL hierarchical = FALSE;
+		for (STATE_INDEX state = 0; state < maxStates; state++)
+		{
+			parents[state] = pStateMap[state].Parent;
+			if (parents[state] != NO_PARENT)
+				hierarchical = TRUE;
+		}
+		if (!hierarchical)
+			return NULL;
+		return Get(pStateMap, parents);
+	}
+
+	/// Get the precomputed path between two states.
+	/// @param[in] source - the current state.
+	/// @param[in] target - the new state.
+	/// @return The exit and entry states.
+	Path GetPath(STATE_INDEX source, STATE_INDEX target) const
+	{
+		const PathIndex& index = m_pathIndex[(size_t)source * m_maxStates + target];
+		const STATE_INDEX* states = &m_pathStates[index.Offset];
+		Path path = { states, index.ExitCount, states + index.ExitCount, index.EntryCount };
+		return path;
+	}
+
+private:
+	StateHierarchy(const std::vector<STATE_INDEX>& parents);
+
+	static const StateHierarchy* Get(const void* key, const std::vector<STATE_INDEX>& parents);
+
+	/// Location of a path within m_pathStates.
+	struct PathIndex
+	{
+		UINT Offset;
+		STATE_INDEX ExitCount;
+		STATE_INDEX EntryCount;
+	};
+
+	const STATE_INDEX m_maxStates;
+
+	/// Path index for each (source, target) pair.
+	std::vector<PathIndex> m_pathIndex;
+
+	/// The exit and entry states of all paths.
+	std::vector<STATE_INDEX> m_pathStates;
+};
+
+#endif // _STATE_HIERARCHY_H
@@ -0,0 +1,133 @@
+#ifndef _STATE_INDEX_H
+#define _STATE_INDEX_H
+
+#include "DataTypes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// STATE_INDEX_TYPE is the unsigned integer type of state indexes used by the state
+// engine. The two largest values are reserved for EVENT_IGNORED and CANNOT_HAPPEN.
+// BYTE supports up to 253 states, uint16_t up to 65533 states and uint32_t more.
+// Transition and event map tables are unaffected; each is packed using the smallest
+// type holding its own state machine's states. See TransitionEntry.
+#ifndef STATE_INDEX_TYPE
+#define STATE_INDEX_TYPE BYTE
+#endif
+
+typedef STATE_INDEX_TYPE STATE_INDEX;
+
+static_assert(std::is_unsigned<STATE_INDEX>::value, "STATE_INDEX_TYPE must be an unsigned integer type.");
+
+/// The largest STATE_INDEX value.
+const STATE_INDEX STATE_INDEX_MAX = static_cast<STATE_INDEX>(~static_cast<STATE_INDEX>(0));
+
+// EVENT_INDEX_TYPE is the unsigned integer type of the event IDs used by Dispatch(),
+// PostEvent() and state activities. It defaults to the STATE_INDEX_TYPE width. An
+// event map with more events than EVENT_INDEX_TYPE holds fails to compile.
+#ifndef EVENT_INDEX_TYPE
+#define EVENT_INDEX_TYPE STATE_INDEX_TYPE
+#endif
+
+typedef EVENT_INDEX_TYPE EVENT_INDEX;
+
+static_assert(std::is_unsigned<EVENT_INDEX>::value, "EVENT_INDEX_TYPE must be an unsigned integer type.");
+
+/// The largest EVENT_INDEX value.
+const EVENT_INDEX EVENT_INDEX_MAX = static_cast<EVENT_INDEX>(~static_cast<EVENT_INDEX>(0));
+
+/// @brief TransitionEntry selects the smallest unsigned type holding maxStates state
+/// indexes plus the EVENT_IGNORED and CANNOT_HAPPEN values, so the transition tables
+/// of small state machines stay densely packed regardless of STATE_INDEX width. The
+/// two largest values of each entry type are the reserved values.
+template <size_t MaxStates>
+struct TransitionEntry
+{
+	typedef typename std::conditional<(MaxStates + 2 <= 0x100), uint8_t,
+		typename std::conditional<(MaxStates + 2 <= 0x10000), uint16_t, uint32_t>::type>::type Type;
+
+	static_assert(sizeof(Type) <= sizeof(STATE_INDEX), "Too many states for STATE_INDEX_TYPE.");
+
+	/// The largest entry value.
+	static constexpr Type MAX = static_cast<Type>(~static_cast<Type>(0));
+
+	/// Narrow a state index or reserved value to a table entry.
+	static constexpr Type Pack(STATE_INDEX state)
+	{
+		return static_cast<Type>(state);
+	}
+
+	/// Widen a table entry to a state index or reserved value.
+	static constexpr STATE_INDEX Unpack(Type entry)
+	{
+		return entry >= MAX - 1 ?
+			static_cast<STATE_INDEX>(STATE_INDEX_MAX - (MAX - entry)) : static_cast<STATE_INDEX>(entry);
+	}
+};
+
+/// @brief An event map entry as written between BEGIN_EVENT_MAP and END_EVENT_MAP: 
+/// either an EVENT_MAP_ROW marker or a TRANSITION_MAP_ENTRY. The markers are checked at
+/// compile time and then removed, so the event map used at run time is a dense table of
+/// TransitionEntry values.
+template <size_t MaxStates>
+struct EventMapEntry
+{
+	typedef typename TransitionEntry<MaxStates>::Type Type;
+
+	Type Value;		// The transition entry
+	size_t Event;	// The event ID of a row marker
+	bool IsRow;
+
+	/// Create a transition entry. Implicit, so TRANSITION_MAP_ENTRY is unchanged.
+	constexpr EventMapEntry(Type value) : Value(value), Event(0), IsRow(false) {}
+
+	/// Create an EVENT_MAP_ROW marker.
+	/// @param[in] event - the event ID of the row.
+	static constexpr EventMapEntry Row(size_t event)
+	{
+		EventMapEntry entry(0);
+		entry.Event = event;
+		entry.IsRow = true;
+		return entry;
+	}
+
+	/// Check that each event ID row marker is preceded by event * MaxStates transition
+	/// entries and followed by exactly MaxStates transition entries.
+	/// @param[in] entries - the entries written by the event map macros.
+	/// @param[in] maxEvents - the number of events.
+	/// @return TRUE if the rows are in event order and each row is complete.
+	template <size_t N>
+	static constexpr bool Check(const EventMapEntry (&entries)[N], size_t maxEvents)
+	{
+		if (N != maxEvents * (MaxStates + 1))
+			return false;
+		for (size_t i = 0; i < N; i++)
+		{
+			bool rowPosition = (i % (MaxStates + 1)) == 0;
+			if (entries[i].IsRow != rowPosition)
+				return false;
+			if (rowPosition && entries[i].Event != i / (MaxStates + 1))
+				return false;
+		}
+		return true;
+	}
+
+	/// Remove the row markers.
+	/// @param[in] entries - the entries written by the event map macros.
+	/// @return The [event][state] transition table.
+	template <size_t MaxEvents, size_t N>
+	static constexpr std::array<Type, MaxEvents * MaxStates> Pack(const EventMapEntry (&entries)[N])
+	{
+		std::array<Type, MaxEvents * MaxStates> table{};
+		size_t count = 0;
+		for (size_t i = 0; i < N && count < table.size(); i++)
+		{
+			if (!entries[i].IsRow)
+				table[count++] = entries[i].Value;
+		}
+		return table;
+	}
+};
+
+#endif // _STATE_INDEX_H
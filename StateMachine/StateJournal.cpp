@@ -0,0 +1,377 @@
+#include "StateJournal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	/// The journal file header. The size is updated after each record is written, so
+	/// records beyond it are incomplete and ignored.
+	struct JournalHeader
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t headerSize;
+		uint32_t maxStates;
+		uint32_t reserved;
+		uint64_t size;			// Committed bytes, including the header
+	};
+
+	/// A journal record, followed by the serialized event data. Records are padded to
+	/// a multiple of 8 bytes.
+	struct JournalRecord
+	{
+		uint64_t time;			// Nanoseconds since the journal was opened
+		uint32_t newState;
+		uint32_t dataSize;		// NO_DATA if the event had no event data
+		uint32_t event;			// The event ID, or NO_EVENT to replay newState
+		uint32_t reserved;
+	};
+
+	const uint32_t JOURNAL_MAGIC = 0x4C4A4D53;		// "SMJL"
+	const uint16_t JOURNAL_VERSION = 2;
+	const uint32_t NO_DATA = 0xFFFFFFFF;
+
+	uint64_t AlignJournal(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+}
+
+//----------------------------------------------------------------------------
+// StateJournal
+//----------------------------------------------------------------------------
+StateJournal::StateJournal() :
+#ifdef _WIN32
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(NULL),
+#else
+	m_file(-1),
+#endif
+	m_buffer(NULL),
+	m_mappedSize(0),
+	m_size(0),
+	m_count(0)
+{
+}
+
+//----------------------------------------------------------------------------
+// ~StateJournal
+//----------------------------------------------------------------------------
+StateJournal::~StateJournal()
+{
+	Close();
+}
+
+//----------------------------------------------------------------------------
+// Open
+//----------------------------------------------------------------------------
+BOOL StateJournal::Open(const char* path, STATE_INDEX maxStates)
+{
+	Close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return FALSE;
+#else
+	m_file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_file < 0)
+		return FALSE;
+#endif
+
+	if (!Map(MIN_SIZE))
+	{
+		Close();
+		return FALSE;
+	}
+
+	JournalHeader* header = reinterpret_cast<JournalHeader*>(m_buffer);
+	header->magic = JOURNAL_MAGIC;
+	header->version = JOURNAL_VERSION;
+	header->headerSize = sizeof(JournalHeader);
+	header->maxStates = maxStates;
+	header->reserved = 0;
+	header->size = sizeof(JournalHeader);
+
+	m_size = sizeof(JournalHeader);
+	m_count = 0;
+	m_epoch = std::chrono::steady_clock::now();
+	return TRUE;
+}
+
+//----------------------------------------------------------------------------
+// Close
+//----------------------------------------------------------------------------
+void StateJournal::Close()
+{
+	Unmap();
+
+#ifdef _WIN32
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		// Drop the unused preallocated space
+		LARGE_INTEGER size;
+		size.QuadPart = (LONGLONG)m_size;
+		if (SetFilePointerEx(m_file, size, NULL, FILE_BEGIN))
+			SetEndOfFile(m_file);
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_file >= 0)
+	{
+		// Drop the unused preallocated space
+		if (ftruncate(m_file, (off_t)m_size) != 0)
+			perror("StateJournal ftruncate");
+		close(m_file);
+		m_file = -1;
+	}
+#endif
+	m_size = 0;
+}
+
+//----------------------------------------------------------------------------
+// Map
+//----------------------------------------------------------------------------
+BOOL StateJournal::Map(uint64_t size)
+{
+	Unmap();
+
+#ifdef _WIN32
+	// Creating the mapping grows the file
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE,
+		(DWORD)(size >> 32), (DWORD)size, NULL);
+	if (m_mapping == NULL)
+		return FALSE;
+	m_buffer = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)size));
+	if (m_buffer == NULL)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+		return FALSE;
+	}
+#else
+	if (ftruncate(m_file, (off_t)size) != 0)
+		return FALSE;
+	void* buffer = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+	if (buffer == MAP_FAILED)
+		return FALSE;
+	m_buffer = static_cast<char*>(buffer);
+#endif
+
+	m_mappedSize = size;
+	return TRUE;
+}
+
+//----------------------------------------------------------------------------
+// Unmap
+//----------------------------------------------------------------------------
+void StateJournal::Unmap()
+{
+	if (m_buffer == NULL)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_buffer);
+	CloseHandle(m_mapping);
+	m_mapping = NULL;
+#else
+	munmap(m_buffer, (size_t)m_mappedSize);
+#endif
+	m_buffer = NULL;
+	m_mappedSize = 0;
+}
+
+//----------------------------------------------------------------------------
+// Record
+//----------------------------------------------------------------------------
+void StateJournal::Record(STATE_INDEX newState, const EventData* pData)
+{
+	Append(newState, NO_EVENT, pData);
+}
+
+//----------------------------------------------------------------------------
+// RecordEvent
+//----------------------------------------------------------------------------
+void StateJournal::RecordEvent(EVENT_INDEX event, const EventData* pData)
+{
+	Append(0, event, pData);
+}
+
+//----------------------------------------------------------------------------
+// Append
+//----------------------------------------------------------------------------
+void StateJournal::Append(STATE_INDEX newState, uint32_t event, const EventData* pData)
+{
+	if (m_buffer == NULL)
+		return;
+
+	BOOL hasData = (pData != NULL && pData != &NO_EVENT_DATA);
+	UINT dataSize = hasData ? pData->Serialize(NULL) : 0;
+	uint64_t recordSize = AlignJournal(sizeof(JournalRecord) + dataSize);
+
+	// Grow the file by doubling; on failure keep what was recorded and stop
+	if (m_size + recordSize > m_mappedSize)
+	{
+		uint64_t size = m_mappedSize;
+		while (m_size + recordSize > size)
+			size *= 2;
+		if (!Map(size))
+		{
+			Close();
+			return;
+		}
+	}
+
+	JournalRecord* record = reinterpret_cast<JournalRecord*>(m_buffer + m_size);
+	record->time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - m_epoch).count();
+	record->newState = newState;
+	record->dataSize = hasData ? dataSize : NO_DATA;
+	record->event = event;
+	record->reserved = 0;
+	if (dataSize > 0)
+		pData->Serialize(record + 1);
+
+	// Commit the record
+	m_size += recordSize;
+	m_count++;
+	std::atomic_thread_fence(std::memory_order_release);
+	reinterpret_cast<JournalHeader*>(m_buffer)->size = m_size;
+}
+
+//----------------------------------------------------------------------------
+// Replay
+//----------------------------------------------------------------------------
+uint64_t StateJournal::Replay(StateMachine& sm, const void* buffer, size_t size)
+{
+	if (buffer == NULL || size < sizeof(JournalHeader))
+		return 0;
+
+	const char* base = static_cast<const char*>(buffer);
+	const JournalHeader* header = reinterpret_cast<const JournalHeader*>(base);
+	if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION ||
+		header->headerSize != sizeof(JournalHeader))
+		return 0;
+	if (header->maxStates != 0 && header->maxStates != sm.GetMaxStates())
+		return 0;
+
+	uint64_t end = header->size < size ? header->size : size;
+	uint64_t offset = header->headerSize;
+	uint64_t count = 0;
+	while (offset + sizeof(JournalRecord) <= end)
+	{
+		const JournalRecord* record = reinterpret_cast<const JournalRecord*>(base + offset);
+		UINT dataSize = record->dataSize != NO_DATA ? record->dataSize : 0;
+		if (offset + sizeof(JournalRecord) + dataSize > end)
+			break;
+
+		// Replay an event ID through the event map, or switch to the recorded state.
+		// The event data type is the state function data type of the new state.
+		EventData* pData = NULL;
+		if (record->event != NO_EVENT)
+		{
+			EVENT_INDEX event = static_cast<EVENT_INDEX>(record->event);
+			if (record->dataSize != NO_DATA &&
+				!CreateEventData(sm, sm.GetEventTransition(event, sm.GetCurrentState()), record + 1, dataSize, pData))
+				break;
+			sm.Dispatch(event, pData);
+		}
+		else
+		{
+			STATE_INDEX newState = static_cast<STATE_INDEX>(record->newState);
+			if (record->dataSize != NO_DATA &&
+				!CreateEventData(sm, newState, record + 1, dataSize, pData))
+				break;
+			sm.ExternalEvent(newState, pData);
+		}
+#ifdef EXTERNAL_EVENT_NO_HEAP_DATA
+		delete pData;
+#endif
+
+		offset += AlignJournal(sizeof(JournalRecord) + dataSize);
+		count++;
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------------
+// CreateEventData
+//----------------------------------------------------------------------------
+BOOL StateJournal::CreateEventData(StateMachine& sm, STATE_INDEX state, const void* buffer, 
+	UINT size, EventData*& pData)
+{
+	// Event data sent to an ignored event, or to CANNOT_HAPPEN, is dropped. A state
+	// activity consuming an ignored event receives no event data.
+	pData = NULL;
+	if (state >= sm.GetMaxStates())
+		return TRUE;
+
+	const StateMapRow* pStateMap = sm.GetStateMap();
+	const StateBase* stateObj = pStateMap ? pStateMap[state].State : sm.GetStateMapEx()[state].State;
+	pData = stateObj->CreateEventData();
+	if (pData == NULL)
+		return FALSE;
+
+	// A NoEventData state ignores the derived event data it was sent
+	if (typeid(*pData) != typeid(EventData) && !pData->Deserialize(buffer, size))
+	{
+		delete pData;
+		pData = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+//----------------------------------------------------------------------------
+// Replay
+//----------------------------------------------------------------------------
+uint64_t StateJournal::Replay(StateMachine& sm, const char* path)
+{
+	uint64_t count = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return 0;
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)sizeof(JournalHeader))
+	{
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			const void* buffer = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (buffer != NULL)
+			{
+				count = Replay(sm, buffer, (size_t)size.QuadPart);
+				UnmapViewOfFile(buffer);
+			}
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return 0;
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size >= (off_t)sizeof(JournalHeader))
+	{
+		void* buffer = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (buffer != MAP_FAILED)
+		{
+			count = Replay(sm, buffer, (size_t)info.st_size);
+			munmap(buffer, (size_t)info.st_size);
+		}
+	}
+	close(file);
+#endif
+
+	return count;
+}
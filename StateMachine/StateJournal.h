@@ -0,0 +1,140 @@
+#ifndef _STATE_JOURNAL_H
+#define _STATE_JOURNAL_H
+
+#include "StateMachine.h"
+#include <chrono>
+
+/// @brief StateJournal records every external event executed by a state machine into
+/// an append-only, memory mapped binary file, and replays a journal into a fresh
+/// state machine as fast as possible. Use it to reproduce field incidents offline, or
+/// to turn recorded traffic into a throughput benchmark.
+///
+/// Each record holds a monotonic timestamp, the event and the event data written by 
+/// EventData::Serialize(). An event generated by ID, using Dispatch() or PostEvent(), 
+/// records the event ID and replays through Dispatch(), so the event map and any 
+/// state activity, such as a coroutine WaitEvent(), execute again. An external event 
+/// function or state timeout has no event ID, so it records the new state selected by
+/// its transition map instead.
+///
+/// Records are appended in place in the mapped file with no system call, except when
+/// the file grows. The header commits each record once written, so a journal is
+/// readable up to the last complete record even if the process crashes. The format
+/// uses the native byte order.
+///
+/// For example:
+///    StateJournal journal;
+///    journal.Open("motor.smj");
+///    motor.SetJournal(&journal);
+///    ...
+///    Motor replay;
+///    StateJournal::Replay(replay, "motor.smj");
+class StateJournal
+{
+public:
+	StateJournal();
+
+	/// Destructor. Closes the journal.
+	~StateJournal();
+
+	/// Create the journal file, replacing any existing file.
+	/// @param[in] path - the file path.
+	/// @param[in] maxStates - the recorded state machine GetMaxStates(), checked on
+	///		replay. 0 to skip the check.
+	/// @return TRUE if opened.
+	BOOL Open(const char* path, STATE_INDEX maxStates = 0);
+
+	/// Close the journal, truncating the file to the recorded size.
+	void Close();
+
+	/// Get whether the journal is open and recording.
+	BOOL IsOpen() const { return m_buffer != NULL; }
+
+	/// Get the number of events recorded since Open().
+	uint64_t GetRecordCount() const { return m_count; }
+
+	/// Append an external event. Called by StateMachine::ExternalEvent() on the state
+	/// machine thread. If the file cannot grow, recording stops.
+	/// @param[in] newState - the new state selected by the event.
+	/// @param[in] pData - the event data, if any.
+	void Record(STATE_INDEX newState, const EventData* pData);
+
+	/// Append an external event by event ID. Called by StateMachine::Dispatch() on the
+	/// state machine thread. If the file cannot grow, recording stops.
+	/// @param[in] event - the event ID.
+	/// @param[in] pData - the event data, if any.
+	void RecordEvent(EVENT_INDEX event, const EventData* pData);
+
+	/// Replay a journal in memory into a state machine. The state machine executes
+	/// each recorded event on the calling thread with no delay between events. Call
+	/// on a fresh state machine with no thread created, or on its own thread. Event
+	/// data is recreated using the default constructor of the state function data type
+	/// and EventData::Deserialize(). For an event ID, the state is the one selected by
+	/// the event map in the current state.
+	/// @param[in] sm - the state machine, usually in its initial state.
+	/// @param[in] buffer - the journal file contents, 8 byte aligned.
+	/// @param[in] size - the buffer size in bytes.
+	/// @return The number of events replayed. Replay stops at the first record whose
+	///		event data cannot be recreated. 0 if the journal is invalid or was
+	///		recorded by a state machine with a different number of states.
+	static uint64_t Replay(StateMachine& sm, const void* buffer, size_t size);
+
+	/// Replay a journal file. The file is memory mapped and read in place.
+	/// @see Replay() above.
+	/// @param[in] sm - the state machine.
+	/// @param[in] path - the journal file path.
+	/// @return The number of events replayed.
+	static uint64_t Replay(StateMachine& sm, const char* path);
+
+private:
+	StateJournal(const StateJournal&) = delete;
+	StateJournal& operator=(const StateJournal&) = delete;
+
+	/// Map the file with a new size.
+	/// @return TRUE if mapped.
+	BOOL Map(uint64_t size);
+
+	/// Unmap the file.
+	void Unmap();
+
+	/// Append a record.
+	/// @param[in] newState - the new state, or 0 for an event ID record.
+	/// @param[in] event - the event ID, or NO_EVENT for a new state record.
+	/// @param[in] pData - the event data, if any.
+	void Append(STATE_INDEX newState, uint32_t event, const EventData* pData);
+
+	/// Recreate recorded event data sent to a state.
+	/// @param[in] sm - the state machine.
+	/// @param[in] state - the state receiving the event data.
+	/// @param[in] buffer - the serialized data.
+	/// @param[in] size - the serialized size in bytes.
+	/// @param[out] pData - the event data, or NULL.
+	/// @return FALSE if the event data cannot be recreated.
+	static BOOL CreateEventData(StateMachine& sm, STATE_INDEX state, const void* buffer, 
+		UINT size, EventData*& pData);
+
+	/// The event field of a new state record.
+	enum : uint32_t { NO_EVENT = 0xFFFFFFFF };
+
+	/// The initial file size and the minimum growth.
+	enum { MIN_SIZE = 1024 * 1024 };
+
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+
+	/// The mapped file and its size.
+	char* m_buffer;
+	uint64_t m_mappedSize;
+
+	/// The committed size in bytes and the number of records.
+	uint64_t m_size;
+	uint64_t m_count;
+
+	/// The time Open() was called.
+	std::chrono::steady_clock::time_point m_epoch;
+};
+
+#endif // _STATE_JOURNAL_H
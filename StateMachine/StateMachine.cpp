@@ -1,29 +1,649 @@
 #include "StateMachine.h"
+#include "StateJournal.h"
+#include <cstring>
+
+namespace
+{
+	/// The binary snapshot header. Snapshots use the native byte order and are
+	/// padded to a multiple of 8 bytes so records can be packed back to back.
+	struct SnapshotHeader
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t headerSize;
+		uint32_t currentState;
+		uint32_t maxStates;
+		uint32_t dataSize;
+		uint32_t layout;		// Hash of the registered variable sizes
+	};
+
+	const uint32_t SNAPSHOT_MAGIC = 0x50534D53;		// "SMSP"
+	const uint16_t SNAPSHOT_VERSION = 1;
+
+	UINT AlignSnapshot(UINT size) { return (size + 7) & ~7u; }
+}
 
 //----------------------------------------------------------------------------
 // StateMachine
 //----------------------------------------------------------------------------
-StateMachine::StateMachine(BYTE maxStates, BYTE initialState) :
+StateMachine::StateMachine(STATE_INDEX maxStates, STATE_INDEX initialState) :
 	MAX_STATES(maxStates),
 	m_currentState(initialState),
 	m_newState(FALSE),
 	m_eventGenerated(FALSE),
-	m_pEventData(NULL)
+	m_pEventData(NULL),
+	m_hierarchy(NULL),
+	m_hierarchyResolved(FALSE),
+	m_journal(NULL),
+	m_journalDispatch(FALSE),
+#if STATE_MACHINE_STATS
+	m_stats(maxStates),
+#endif
+	m_eventQueue(NULL),
+	m_eventBatch(NULL),
+	m_eventQueueCapacity(0),
+	m_eventQueueHead(0),
+	m_eventQueueCount(0),
+	m_eventQueuePriorityCount(0),
+	m_eventQueuePurges(0),
+	m_priorityEventPosted(false),
+	m_eventsPosted(FALSE),
+	m_stateTimer(&StateMachine::OnStateTimerExpired, this),
+	m_stateTimeoutRunning(FALSE),
+	m_stateTimerExpired(0),
+	m_stateActivity(NULL),
+	m_runningActivity(NULL),
+	m_retiredActivity(NULL),
+	m_stateActivityGeneration(0),
+	m_stateActivityResume(0)
 {
 	ASSERT_TRUE(MAX_STATES < EVENT_IGNORED);
 }  
 
+//----------------------------------------------------------------------------
+// ~StateMachine
+//----------------------------------------------------------------------------
+StateMachine::~StateMachine()
+{
+	StopStateTimeout();
+	CancelStateActivity();
+
+	// Delete the event data of any events never dispatched
+	for (UINT i = 0; i < m_eventQueueCount; i++)
+		DeleteEventData(m_eventQueue[(m_eventQueueHead + i) % m_eventQueueCapacity].pData);
+
+	delete[] m_eventQueue;
+	delete[] m_eventBatch;
+}
+
+//----------------------------------------------------------------------------
+// CreateEventQueue
+//----------------------------------------------------------------------------
+void StateMachine::CreateEventQueue(UINT capacity)
+{
+	ASSERT_TRUE(m_eventQueue == NULL);
+	ASSERT_TRUE(capacity > 0);
+
+	// Slots are reserved for the state timeout and state activity events. At most 
+	// one of each is ever queued, so a full queue never loses them. One more slot 
+	// lets a priority event such as Cancel() into a queue full of normal events.
+	m_eventQueue = new QueuedEvent[capacity + RESERVED_EVENTS];
+	m_eventBatch = new QueuedEvent[capacity + RESERVED_EVENTS];
+	m_eventQueueCapacity = capacity + RESERVED_EVENTS;
+}
+
+//----------------------------------------------------------------------------
+// PostQueuedEvent
+//----------------------------------------------------------------------------
+BOOL StateMachine::PostQueuedEvent(void (*invoke)(StateMachine*, EVENT_INDEX, const EventData*), EVENT_INDEX event, const EventData* pData, UINT flags)
+{
+	// CreateEventQueue() must be called before posting events
+	ASSERT_TRUE(m_eventQueue != NULL);
+
+	BOOL notify = FALSE;
+	BOOL priority = (flags & POST_PRIORITY) != 0;
+	const EventData* pStaleData = NULL;
+	std::vector<const EventData*> purged;
+	{
+		std::unique_lock<std::mutex> lock(m_eventQueueLock);
+
+		// Replace the data of a pending instance of the same event
+		QueuedEvent* pending = NULL;
+		if (flags & POST_COALESCE)
+		{
+			if (IsReservedEvent(invoke))
+			{
+				// Reserved events carry no data and check their generation when they
+				// execute, so any queued instance is reused
+				for (UINT i = 0; i < m_eventQueueCount && !pending; i++)
+				{
+					if (GetQueuedEvent(i).Invoke == invoke)
+						pending = &GetQueuedEvent(i);
+				}
+			}
+			else if (m_eventQueueCount > m_eventQueuePriorityCount)
+			{
+				// Only the last queued event, and only if it was posted as coalescing, 
+				// so the new value never moves ahead of an event posted after it
+				QueuedEvent& last = GetQueuedEvent(m_eventQueueCount - 1);
+				if (last.Coalesce && last.Invoke == invoke && last.Event == event)
+					pending = &last;
+			}
+		}
+
+		if (pending)
+		{
+			pStaleData = pending->pData;
+			pending->pData = pData;
+		}
+		else
+		{
+			if (flags & POST_PURGE)
+				PurgeQueuedEvents(purged);
+
+			UINT capacity = m_eventQueueCapacity - RESERVED_EVENTS;
+			if (IsReservedEvent(invoke))
+				capacity = m_eventQueueCapacity;
+			else if (priority)
+				capacity++;
+			if (m_eventQueueCount >= capacity)
+			{
+				lock.unlock();
+				for (size_t i = 0; i < purged.size(); i++)
+					DeleteEventData(purged[i]);
+				DeleteEventData(pData);
+				return FALSE;
+			}
+
+			if (priority)
+			{
+				// Insert after the queued priority events by moving them one slot forward
+				m_eventQueueHead = (m_eventQueueHead + m_eventQueueCapacity - 1) % m_eventQueueCapacity;
+				for (UINT i = 0; i < m_eventQueuePriorityCount; i++)
+					GetQueuedEvent(i) = GetQueuedEvent(i + 1);
+				QueuedEvent& queued = GetQueuedEvent(m_eventQueuePriorityCount++);
+				queued.Invoke = invoke;
+				queued.Event = event;
+				queued.Coalesce = FALSE;
+				queued.pData = pData;
+				m_priorityEventPosted.store(true, std::memory_order_release);
+			}
+			else
+			{
+				QueuedEvent& queued = GetQueuedEvent(m_eventQueueCount);
+				queued.Invoke = invoke;
+				queued.Event = event;
+				queued.Coalesce = (flags & POST_COALESCE) != 0;
+				queued.pData = pData;
+			}
+			m_eventQueueCount++;
+		}
+
+		// Only the first post of a batch wakes up the owner. A coalesced event is 
+		// already pending, but its wakeup may have failed.
+		if (!m_eventsPosted)
+		{
+			m_eventsPosted = TRUE;
+			notify = TRUE;
+		}
+	}
+
+	DeleteEventData(pStaleData);
+	for (size_t i = 0; i < purged.size(); i++)
+		DeleteEventData(purged[i]);
+
+	// A priority event always wakes up the owner, even if a batch is pending
+	if (priority)
+		OnPriorityEventPosted();
+	else if (notify && (flags & POST_NO_WAIT))
+		return OnEventsPostedNoWait();
+	else if (notify)
+		OnEventsPosted();
+	return TRUE;
+}
+
+//----------------------------------------------------------------------------
+// PostEvents
+//----------------------------------------------------------------------------
+UINT StateMachine::PostEvents(const BatchEvent* events, UINT count)
+{
+	BOOL notify = FALSE;
+	UINT queued = QueueEvents(events, count, notify);
+	if (notify)
+		OnEventsPosted();
+	return queued;
+}
+
+//----------------------------------------------------------------------------
+// QueueEvents
+//----------------------------------------------------------------------------
+UINT StateMachine::QueueEvents(const BatchEvent* events, UINT count, BOOL& notify)
+{
+	// CreateEventQueue() must be called before posting events
+	ASSERT_TRUE(m_eventQueue != NULL);
+
+	notify = FALSE;
+	UINT queued = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_eventQueueLock);
+		UINT capacity = m_eventQueueCapacity - RESERVED_EVENTS;
+		for (; queued < count && m_eventQueueCount < capacity; queued++)
+		{
+			QueuedEvent& slot = GetQueuedEvent(m_eventQueueCount++);
+			slot.Invoke = events[queued].Invoke;
+			slot.Event = events[queued].Event;
+			slot.Coalesce = FALSE;
+			slot.pData = events[queued].pData;
+		}
+
+		// Only the first post of a batch wakes up the owner
+		if (queued > 0 && !m_eventsPosted)
+		{
+			m_eventsPosted = TRUE;
+			notify = TRUE;
+		}
+	}
+
+	// Discard the events that did not fit
+	for (UINT i = queued; i < count; i++)
+		DeleteEventData(events[i].pData);
+	return queued;
+}
+
+//----------------------------------------------------------------------------
+// PurgeQueuedEvents
+//----------------------------------------------------------------------------
+void StateMachine::PurgeQueuedEvents(std::vector<const EventData*>& purged)
+{
+	// Keep the priority events at the front and any reserved events
+	UINT kept = 0;
+	for (UINT i = 0; i < m_eventQueueCount; i++)
+	{
+		QueuedEvent& queued = GetQueuedEvent(i);
+		if (i < m_eventQueuePriorityCount || IsReservedEvent(queued.Invoke))
+			GetQueuedEvent(kept++) = queued;
+		else
+			purged.push_back(queued.pData);
+	}
+	m_eventQueueCount = kept;
+	m_eventQueuePurges++;
+}
+
+//----------------------------------------------------------------------------
+// ResetEventsPosted
+//----------------------------------------------------------------------------
+void StateMachine::ResetEventsPosted()
+{
+	std::lock_guard<std::mutex> lock(m_eventQueueLock);
+	m_eventsPosted = FALSE;
+}
+
+//----------------------------------------------------------------------------
+// DispatchEvents
+//----------------------------------------------------------------------------
+UINT StateMachine::DispatchEvents()
+{
+	if (m_eventQueue == NULL)
+		return 0;
+
+	UINT dispatched = 0;
+	for (;;)
+	{
+		// Remove all queued events under a single lock acquisition
+		UINT count = 0;
+		UINT priorityCount = 0;
+		UINT purges = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_eventQueueLock);
+			if (m_eventQueueCount == 0)
+			{
+				// Queue drained. The next post starts a new batch.
+				m_eventsPosted = FALSE;
+				break;
+			}
+
+			for (count = 0; count < m_eventQueueCount; count++)
+				m_eventBatch[count] = GetQueuedEvent(count);
+			m_eventQueueHead = (m_eventQueueHead + count) % m_eventQueueCapacity;
+			m_eventQueueCount = 0;
+			priorityCount = m_eventQueuePriorityCount;
+			m_eventQueuePriorityCount = 0;
+			m_priorityEventPosted.store(false, std::memory_order_relaxed);
+			purges = m_eventQueuePurges;
+		}
+
+		// Run each event to completion without holding the lock. Events posted 
+		// while executing are picked up by the next loop iteration. The invoke 
+		// function disposes of the event data.
+		for (UINT i = 0; i < count; i++)
+		{
+			// Priority events posted since the batch started run before its 
+			// remaining normal events, which are discarded if purged
+			if (i >= priorityCount && m_priorityEventPosted.load(std::memory_order_acquire))
+			{
+				UINT batchPurges = purges;
+				dispatched += DispatchPriorityEvents(purges);
+				if (purges != batchPurges)
+				{
+					for (UINT j = i; j < count; j++)
+					{
+						if (!IsReservedEvent(m_eventBatch[j].Invoke))
+						{
+							DeleteEventData(m_eventBatch[j].pData);
+							m_eventBatch[j].Invoke = NULL;
+						}
+					}
+				}
+			}
+
+			if (m_eventBatch[i].Invoke != NULL)
+			{
+				m_eventBatch[i].Invoke(this, m_eventBatch[i].Event, m_eventBatch[i].pData);
+				dispatched++;
+			}
+		}
+	}
+	return dispatched;
+}
+
+//----------------------------------------------------------------------------
+// DispatchPriorityEvents
+//----------------------------------------------------------------------------
+UINT StateMachine::DispatchPriorityEvents(UINT& purges)
+{
+	UINT dispatched = 0;
+	for (;;)
+	{
+		QueuedEvent queued;
+		{
+			std::lock_guard<std::mutex> lock(m_eventQueueLock);
+			purges = m_eventQueuePurges;
+			if (m_eventQueuePriorityCount == 0)
+			{
+				m_priorityEventPosted.store(false, std::memory_order_relaxed);
+				break;
+			}
+
+			queued = GetQueuedEvent(0);
+			m_eventQueueHead = (m_eventQueueHead + 1) % m_eventQueueCapacity;
+			m_eventQueueCount--;
+			m_eventQueuePriorityCount--;
+		}
+
+		queued.Invoke(this, queued.Event, queued.pData);
+		dispatched++;
+	}
+	return dispatched;
+}
+
+//----------------------------------------------------------------------------
+// RegisterSnapshotVariable
+//----------------------------------------------------------------------------
+void StateMachine::RegisterSnapshotVariable(void* pVariable, UINT size)
+{
+	SnapshotVariable variable = { pVariable, size };
+	m_snapshotVariables.push_back(variable);
+}
+
+//----------------------------------------------------------------------------
+// GetSnapshotSize
+//----------------------------------------------------------------------------
+UINT StateMachine::GetSnapshotSize() const
+{
+	UINT size = sizeof(SnapshotHeader);
+	for (size_t i = 0; i < m_snapshotVariables.size(); i++)
+		size += m_snapshotVariables[i].size;
+	return AlignSnapshot(size);
+}
+
+//----------------------------------------------------------------------------
+// SaveSnapshot
+//----------------------------------------------------------------------------
+UINT StateMachine::SaveSnapshot(void* buffer, UINT size) const
+{
+	UINT snapshotSize = GetSnapshotSize();
+	if (buffer == NULL || size < snapshotSize)
+		return 0;
+
+	SnapshotHeader header;
+	header.magic = SNAPSHOT_MAGIC;
+	header.version = SNAPSHOT_VERSION;
+	header.headerSize = sizeof(SnapshotHeader);
+	header.currentState = m_currentState;
+	header.maxStates = MAX_STATES;
+	header.dataSize = 0;
+	header.layout = 2166136261u;
+
+	// Copy each variable after the header, hashing the sizes (FNV-1a) so a restore
+	// into a different variable layout is rejected
+	BYTE* pData = static_cast<BYTE*>(buffer) + sizeof(SnapshotHeader);
+	for (size_t i = 0; i < m_snapshotVariables.size(); i++)
+	{
+		const SnapshotVariable& variable = m_snapshotVariables[i];
+		memcpy(pData + header.dataSize, variable.pVariable, variable.size);
+		header.dataSize += variable.size;
+		header.layout = (header.layout ^ variable.size) * 16777619u;
+	}
+
+	memcpy(buffer, &header, sizeof(header));
+	memset(pData + header.dataSize, 0, snapshotSize - sizeof(SnapshotHeader) - header.dataSize);
+	return snapshotSize;
+}
+
+//----------------------------------------------------------------------------
+// RestoreSnapshot
+//----------------------------------------------------------------------------
+BOOL StateMachine::RestoreSnapshot(const void* buffer, UINT size)
+{
+	if (buffer == NULL || size < sizeof(SnapshotHeader))
+		return FALSE;
+
+	SnapshotHeader header;
+	memcpy(&header, buffer, sizeof(header));
+
+	uint32_t layout = 2166136261u;
+	UINT dataSize = 0;
+	for (size_t i = 0; i < m_snapshotVariables.size(); i++)
+	{
+		dataSize += m_snapshotVariables[i].size;
+		layout = (layout ^ m_snapshotVariables[i].size) * 16777619u;
+	}
+
+	if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+		header.headerSize != sizeof(SnapshotHeader) || header.maxStates != MAX_STATES ||
+		header.currentState >= MAX_STATES || header.dataSize != dataSize ||
+		header.layout != layout || size < sizeof(SnapshotHeader) + dataSize)
+		return FALSE;
+
+	const BYTE* pData = static_cast<const BYTE*>(buffer) + sizeof(SnapshotHeader);
+	for (size_t i = 0; i < m_snapshotVariables.size(); i++)
+	{
+		const SnapshotVariable& variable = m_snapshotVariables[i];
+		memcpy(variable.pVariable, pData, variable.size);
+		pData += variable.size;
+	}
+
+	// Switch state directly; the snapshot already reflects the entry actions
+	StopStateTimeout();
+	CancelStateActivity();
+	SetCurrentState(static_cast<STATE_INDEX>(header.currentState));
+	return TRUE;
+}
+
+//----------------------------------------------------------------------------
+// StartStateTimeout
+//----------------------------------------------------------------------------
+void StateMachine::StartStateTimeout(const StateMapRowEx& row)
+{
+	if (row.Timeout != 0)
+	{
+		// State timeouts are delivered through the event queue
+		ASSERT_TRUE(m_eventQueue != NULL);
+		StateTimerWheel::GetInstance().Start(m_stateTimer, row.Timeout);
+		m_stateTimeoutRunning = TRUE;
+	}
+	else
+		StopStateTimeout();
+}
+
+//----------------------------------------------------------------------------
+// StopStateTimeout
+//----------------------------------------------------------------------------
+void StateMachine::StopStateTimeout()
+{
+	if (m_stateTimeoutRunning)
+	{
+		StateTimerWheel::GetInstance().Stop(m_stateTimer);
+		m_stateTimeoutRunning = FALSE;
+	}
+}
+
+//----------------------------------------------------------------------------
+// OnStateTimerExpired
+//----------------------------------------------------------------------------
+void StateMachine::OnStateTimerExpired(void* context, UINT generation)
+{
+	// Called on the timer thread. InvokeStateTimeout() discards the timeout if the
+	// timer was stopped or restarted since it expired with this generation.
+	StateMachine* sm = static_cast<StateMachine*>(context);
+	sm->m_stateTimerExpired.store(generation);
+
+	// Never wait for the owner here; it may be stopping this timer. If the owner 
+	// could not be woken up, retry on the next tick unless the timer was stopped.
+	if (!sm->PostQueuedEvent(&InvokeStateTimeout, 0, NULL, POST_COALESCE | POST_NO_WAIT))
+		StateTimerWheel::GetInstance().Retry(sm->m_stateTimer, generation, 1);
+}
+
+//----------------------------------------------------------------------------
+// InvokeStateTimeout
+//----------------------------------------------------------------------------
+void StateMachine::InvokeStateTimeout(StateMachine* sm, EVENT_INDEX, const EventData*)
+{
+	// Ignore a timeout that expired before the state machine left the state, or 
+	// before the timeout was restarted by a self-transition
+	if (!sm->m_stateTimeoutRunning || sm->m_stateTimerExpired.load() != sm->m_stateTimer.Generation)
+		return;
+	sm->m_stateTimeoutRunning = FALSE;
+
+	const StateMapRowEx* pStateMapEx = sm->GetStateMapEx();
+	ASSERT_TRUE(pStateMapEx != NULL);
+	sm->ExternalEvent(pStateMapEx[sm->m_currentState].TimeoutState, NULL);
+}
+
+//----------------------------------------------------------------------------
+// SetStateActivity
+//----------------------------------------------------------------------------
+void StateMachine::SetStateActivity(StateActivity* activity)
+{
+	CancelStateActivity();
+	m_stateActivity = activity;
+}
+
+//----------------------------------------------------------------------------
+// CancelStateActivity
+//----------------------------------------------------------------------------
+void StateMachine::CancelStateActivity()
+{
+	if (m_stateActivity == NULL)
+		return;
+
+	// An activity that caused its own state to exit is still on the call stack
+	if (m_stateActivity == m_runningActivity)
+	{
+		ASSERT_TRUE(m_retiredActivity == NULL);
+		m_retiredActivity = m_stateActivity;
+	}
+	else
+		delete m_stateActivity;
+
+	m_stateActivity = NULL;
+	m_stateActivityGeneration++;
+}
+
+//----------------------------------------------------------------------------
+// ResumeStateActivity
+//----------------------------------------------------------------------------
+void StateMachine::ResumeStateActivity(UINT generation)
+{
+	m_stateActivityResume.store(generation);
+	PostQueuedEvent(&InvokeStateActivity, 0, NULL, POST_COALESCE);
+}
+
+//----------------------------------------------------------------------------
+// InvokeStateActivity
+//----------------------------------------------------------------------------
+void StateMachine::InvokeStateActivity(StateMachine* sm, EVENT_INDEX, const EventData*)
+{
+	// Ignore a resume for an activity since replaced or deleted
+	if (sm->m_stateActivity != NULL && sm->m_runningActivity == NULL &&
+		sm->m_stateActivityResume.load() == sm->m_stateActivityGeneration)
+		sm->RunStateActivity(FALSE, 0, NULL);
+}
+
+//----------------------------------------------------------------------------
+// RunStateActivity
+//----------------------------------------------------------------------------
+BOOL StateMachine::RunStateActivity(BOOL offerEvent, EVENT_INDEX event, const EventData* pData)
+{
+	BOOL consumed = TRUE;
+	m_runningActivity = m_stateActivity;
+	if (offerEvent)
+		consumed = m_runningActivity->OnEvent(event, pData);
+	else
+		m_runningActivity->Resume();
+	m_runningActivity = NULL;
+
+	delete m_retiredActivity;
+	m_retiredActivity = NULL;
+	return consumed;
+}
+
+//----------------------------------------------------------------------------
+// Dispatch
+//----------------------------------------------------------------------------
+void StateMachine::Dispatch(EVENT_INDEX event, const EventData* pData)
+{
+	// Record the event ID rather than the new state, so a replay runs the event map
+	// and any state activity again. ExternalEvent() below does not record it twice.
+	BOOL journalDispatch = m_journalDispatch;
+	if (m_journal != NULL && !journalDispatch)
+	{
+		m_journal->RecordEvent(event, pData);
+		m_journalDispatch = TRUE;
+	}
+
+	// A suspended state activity may be waiting for the event
+	if (m_stateActivity != NULL && m_runningActivity == NULL && 
+		RunStateActivity(TRUE, event, pData))
+	{
+		m_journalDispatch = journalDispatch;
+		return;
+	}
+
+	ExternalEvent(GetEventTransition(event, m_currentState), pData);
+	m_journalDispatch = journalDispatch;
+}
+
+//----------------------------------------------------------------------------
+// DeleteEventData
+//----------------------------------------------------------------------------
+void StateMachine::DeleteEventData(const EventData* pData)
+{
+	if (pData != NULL && pData != &NO_EVENT_DATA)
+		delete pData;
+}
+
 //----------------------------------------------------------------------------
 // ExternalEvent
 //----------------------------------------------------------------------------
-void StateMachine::ExternalEvent(BYTE newState, const EventData* pData)
+void StateMachine::ExternalEvent(STATE_INDEX newState, const EventData* pData)
 {
 	// If we are supposed to ignore this event
 	if (newState == EVENT_IGNORED)
 	{
 #ifndef EXTERNAL_EVENT_NO_HEAP_DATA
 		// Just delete the event data, if any
-		if (pData != NULL)
+		if (pData != NULL && pData != &NO_EVENT_DATA)
 			delete pData;
 #endif
 	}
@@ -31,10 +651,13 @@ void StateMachine::ExternalEvent(BYTE newState, const EventData* pData)
 	{
 		// TODO - capture software lock here for thread-safety if necessary
 
+		// Record the event before the state engine may delete the event data
+		if (m_journal != NULL && !m_journalDispatch)
+			m_journal->Record(newState, pData);
+
 #ifdef EXTERNAL_EVENT_NO_HEAP_DATA
-		EventData data;
 		if (pData == NULL)
-			pData = &data;
+			pData = &NO_EVENT_DATA;
 #endif
 		// Generate the event
 		InternalEvent(newState, pData);
@@ -50,16 +673,64 @@ void StateMachine::ExternalEvent(BYTE newState, const EventData* pData)
 //----------------------------------------------------------------------------
 // InternalEvent
 //----------------------------------------------------------------------------
-void StateMachine::InternalEvent(BYTE newState, const EventData* pData)
+void StateMachine::InternalEvent(STATE_INDEX newState, const EventData* pData)
 {
 	if (pData == NULL)
-		pData = new NoEventData();
+		pData = &NO_EVENT_DATA;
 
 	m_pEventData = pData;
 	m_eventGenerated = TRUE;
 	m_newState = newState;
 }
 
+//----------------------------------------------------------------------------
+// GetTrace
+//----------------------------------------------------------------------------
+UINT StateMachine::GetTrace(StateTraceRecord* records, UINT maxRecords) const
+{
+#if STATE_MACHINE_TRACE
+	return m_trace.Snapshot(records, maxRecords);
+#else
+	return 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// GetStats
+//----------------------------------------------------------------------------
+BOOL StateMachine::GetStats(StateMachineStats& stats) const
+{
+#if STATE_MACHINE_STATS
+	m_stats.Snapshot(stats);
+	return TRUE;
+#else
+	(void)stats;
+	return FALSE;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// TraceTransition
+//----------------------------------------------------------------------------
+void StateMachine::TraceTransition(BOOL guardResult, const EventData* pData)
+{
+#if STATE_MACHINE_TRACE
+	m_trace.Record(m_currentState, m_newState, guardResult, pData ? &typeid(*pData) : NULL);
+#endif
+}
+
+//----------------------------------------------------------------------------
+// InvalidTransition
+//----------------------------------------------------------------------------
+void StateMachine::InvalidTransition()
+{
+#if STATE_MACHINE_TRACE
+	TraceTransition(FALSE, m_pEventData);
+	m_trace.Print();
+#endif
+	ASSERT();
+}
+
 //----------------------------------------------------------------------------
 // StateEngine
 //----------------------------------------------------------------------------
@@ -92,7 +763,8 @@ void StateMachine::StateEngine(const StateMapRow* const pStateMap)
 	while (m_eventGenerated)
 	{
 		// Error check that the new state is valid before proceeding
-		ASSERT_TRUE(m_newState < MAX_STATES);
+		if (m_newState >= MAX_STATES)
+			InvalidTransition();
 
 		// Get the pointer from the state map
 		const StateBase* state = pStateMap[m_newState].State;
@@ -106,18 +778,34 @@ void StateMachine::StateEngine(const StateMapRow* const pStateMap)
 		// Event used up, reset the flag
 		m_eventGenerated = FALSE;
 
+		TraceTransition(TRUE, pDataTemp);
+
+#if STATE_MACHINE_STATS
+		STATE_INDEX fromState = m_currentState;
+		STATE_INDEX toState = m_newState;
+		m_stats.BeginEvent();
+#endif
+
 		// Switch to the new current state
 		SetCurrentState(m_newState);
 
+		// The state executes again; its previous activity is over
+		if (m_stateActivity != NULL)
+			CancelStateActivity();
+
 		// Execute the state action passing in event data
 		ASSERT_TRUE(state != NULL);
 		state->InvokeStateAction(this, pDataTemp);
 
+#if STATE_MACHINE_STATS
+		m_stats.EndEvent(fromState, toState, TRUE);
+#endif
+
 		// If event data was used, then delete it
 #if EXTERNAL_EVENT_NO_HEAP_DATA
 		if (pDataTemp)
 		{
-			if (!externalEvent)
+			if (!externalEvent && pDataTemp != &NO_EVENT_DATA)
 				delete pDataTemp;
 			pDataTemp = NULL;
 		}
@@ -125,7 +813,8 @@ void StateMachine::StateEngine(const StateMapRow* const pStateMap)
 #else
 		if (pDataTemp)
 		{
-			delete pDataTemp;
+			if (pDataTemp != &NO_EVENT_DATA)
+				delete pDataTemp;
 			pDataTemp = NULL;
 		}
 #endif
@@ -142,11 +831,19 @@ void StateMachine::StateEngine(const StateMapRowEx* const pStateMapEx)
 #endif
 	const EventData* pDataTemp = NULL;
 
+	// Resolve the shared hierarchical exit/entry paths on first use
+	if (!m_hierarchyResolved)
+	{
+		m_hierarchy = StateHierarchy::Get(pStateMapEx, MAX_STATES);
+		m_hierarchyResolved = TRUE;
+	}
+
 	// While events are being generated keep executing states
 	while (m_eventGenerated)
 	{
 		// Error check that the new state is valid before proceeding
-		ASSERT_TRUE(m_newState < MAX_STATES);
+		if (m_newState >= MAX_STATES)
+			InvalidTransition();
 
 		// Get the pointers from the state map
 		const StateBase* state = pStateMapEx[m_newState].State;
@@ -163,10 +860,17 @@ void StateMachine::StateEngine(const StateMapRowEx* const pStateMapEx)
 		// Event used up, reset the flag
 		m_eventGenerated = FALSE;
 
+#if STATE_MACHINE_STATS
+		STATE_INDEX fromState = m_currentState;
+		STATE_INDEX toState = m_newState;
+		m_stats.BeginEvent();
+#endif
+
 		// Execute the guard condition
 		BOOL guardResult = TRUE;
 		if (guard != NULL)
 			guardResult = guard->InvokeGuardCondition(this, pDataTemp);
+		TraceTransition(guardResult, pDataTemp);
 
 		// If the guard condition succeeds
 		if (guardResult == TRUE)
@@ -174,13 +878,49 @@ void StateMachine::StateEngine(const StateMapRowEx* const pStateMapEx)
 			// Transitioning to a new state?
 			if (m_newState != m_currentState)
 			{
-				// Execute the state exit action on current state before switching to new state
-				if (exit != NULL)
-					exit->InvokeExitAction(this);
+				if (m_hierarchy != NULL)
+				{
+					// Walk the precomputed path out of and into each composite state
+					StateHierarchy::Path path = m_hierarchy->GetPath(m_currentState, m_newState);
+					for (STATE_INDEX i = 0; i < path.ExitCount; i++)
+					{
+						const ExitBase* pathExit = pStateMapEx[path.Exit[i]].Exit;
+						if (pathExit != NULL)
+						{
+#if STATE_MACHINE_STATS
+							m_stats.BeginExit();
+							pathExit->InvokeExitAction(this);
+							m_stats.EndExit(path.Exit[i]);
+#else
+							pathExit->InvokeExitAction(this);
+#endif
+						}
+					}
+					for (STATE_INDEX i = 0; i < path.EntryCount; i++)
+					{
+						const EntryBase* pathEntry = pStateMapEx[path.Entry[i]].Entry;
+						if (pathEntry != NULL)
+							pathEntry->InvokeEntryAction(this, pDataTemp);
+					}
+				}
+				else
+				{
+					// Execute the state exit action on current state before switching to new state
+					if (exit != NULL)
+					{
+#if STATE_MACHINE_STATS
+						m_stats.BeginExit();
+						exit->InvokeExitAction(this);
+						m_stats.EndExit(m_currentState);
+#else
+						exit->InvokeExitAction(this);
+#endif
+					}
 
-				// Execute the state entry action on the new state
-				if (entry != NULL)
-					entry->InvokeEntryAction(this, pDataTemp);
+					// Execute the state entry action on the new state
+					if (entry != NULL)
+						entry->InvokeEntryAction(this, pDataTemp);
+				}
 
 				// Ensure exit/entry actions didn't call InternalEvent by accident 
 				ASSERT_TRUE(m_eventGenerated == FALSE);
@@ -189,16 +929,28 @@ void StateMachine::StateEngine(const StateMapRowEx* const pStateMapEx)
 			// Switch to the new current state
 			SetCurrentState(m_newState);
 
+			// Restart or stop the state timeout
+			if (m_stateTimeoutRunning || pStateMapEx[m_newState].Timeout != 0)
+				StartStateTimeout(pStateMapEx[m_newState]);
+
+			// The state executes again; its previous activity is over
+			if (m_stateActivity != NULL)
+				CancelStateActivity();
+
 			// Execute the state action passing in event data
 			ASSERT_TRUE(state != NULL);
 			state->InvokeStateAction(this, pDataTemp);
 		}
 
+#if STATE_MACHINE_STATS
+		m_stats.EndEvent(fromState, toState, guardResult);
+#endif
+
 		// If event data was used, then delete it
 #if EXTERNAL_EVENT_NO_HEAP_DATA
 		if (pDataTemp)
 		{
-			if (!externalEvent)
+			if (!externalEvent && pDataTemp != &NO_EVENT_DATA)
 				delete pDataTemp;
 			pDataTemp = NULL;
 		}
@@ -206,7 +958,8 @@ void StateMachine::StateEngine(const StateMapRowEx* const pStateMapEx)
 #else
 		if (pDataTemp)
 		{
-			delete pDataTemp;
+			if (pDataTemp != &NO_EVENT_DATA)
+				delete pDataTemp;
 			pDataTemp = NULL;
 		}
 #endif
@@ -3,8 +3,21 @@
 
 #include "DataTypes.h"
 #include <stdio.h>
+#include <cstddef>
+#include <new>
 #include <typeinfo>
+#include <type_traits>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <memory>
 #include "Fault.h"
+#include "EventDataPool.h"
+#include "StateIndex.h"
+#include "StateHierarchy.h"
+#include "StateTrace.h"
+#include "StateStats.h"
+#include "StateTimerWheel.h"
 
 // If EXTERNAL_EVENT_NO_HEAP_DATA is defined it changes how a client sends data to the
 // state machine. When undefined, the ExternalEvent() pData argument must be created on the heap. 
@@ -13,6 +26,29 @@
 // used inside the state machine always heap allocates event data. 
 #define EXTERNAL_EVENT_NO_HEAP_DATA 1
 
+// If EVENT_DATA_POOL is defined, EventData, or derived class thereof, created with 
+// new/delete is routed to the EventDataPool fixed-block allocator. Data-less events 
+// use the shared NO_EVENT_DATA instance. Once warmed up, the state engine makes no 
+// heap calls per transition. Do not combine with the XALLOCATOR option below.
+#define EVENT_DATA_POOL 1
+
+// If STATE_MACHINE_TRACE is nonzero, each state machine instance records its most recent 
+// transitions into a lock-free StateTrace ring buffer. Use GetTrace() to snapshot the 
+// history from any thread. The trace is printed before asserting on an invalid transition, 
+// such as CANNOT_HAPPEN. Set STATE_TRACE_DEPTH to change the number of records kept. 
+// Define to 0 to compile the trace out.
+#ifndef STATE_MACHINE_TRACE
+#define STATE_MACHINE_TRACE 1
+#endif
+
+// If STATE_MACHINE_STATS is nonzero, each state machine instance collects per state entry 
+// counts, wall-clock dwell time, thread CPU time spent in the state/guard/entry/exit actions
+// and a transition count matrix. Use GetStats() to snapshot. When zero the instrumentation 
+// is compiled out.
+#ifndef STATE_MACHINE_STATS
+#define STATE_MACHINE_STATS 0
+#endif
+
 // @see https://github.com/endurodave/StateMachine
 // David Lafreniere
 
@@ -26,12 +62,73 @@ class EventData
 {
 public:
 	virtual ~EventData() {}
+
+	/// Serialize the event data into a StateJournal record. Override in event data
+	/// sent to a journaled state machine; by default no data is recorded.
+	/// @param[out] buffer - the destination, or NULL to get the size only.
+	/// @return The serialized size in bytes.
+	virtual UINT Serialize(void* /*buffer*/) const { return 0; }
+
+	/// Restore the event data from a StateJournal record written by Serialize().
+	/// @param[in] buffer - the serialized data.
+	/// @param[in] size - the serialized size in bytes.
+	/// @return TRUE if restored.
+	virtual BOOL Deserialize(const void* /*buffer*/, UINT size) { return size == 0; }
+
+#if EVENT_DATA_POOL
+	static void* operator new(size_t size) { return EventDataPool::Allocate(size); }
+	static void* operator new(size_t size, const std::nothrow_t&) noexcept { return EventDataPool::TryAllocate(size); }
+	static void operator delete(void* ptr, size_t size) { EventDataPool::Deallocate(ptr, size); }
+#endif
 	//XALLOCATOR
 };
 
 typedef EventData NoEventData;
 
+/// @brief Shared event data instance sent to states for data-less events. The
+/// instance is never deleted by the state engine.
+inline const NoEventData NO_EVENT_DATA{};
+
 class StateMachine;
+class StateJournal;
+
+template <class SM>
+class StaticStateMachine;
+
+/// @brief A suspended activity owned by the current state, such as a coroutine state
+/// action (see StateCoroutine.h). The state machine deletes the activity when any
+/// state executes next, so an activity never outlives its state.
+class StateActivity
+{
+public:
+	virtual ~StateActivity() {}
+
+	/// Resume the activity on the state machine thread. Called once per 
+	/// StateMachine::ResumeStateActivity().
+	virtual void Resume() = 0;
+
+	/// Offer an event dispatched by ID to the activity before the event map.
+	/// @param[in] event - the event ID.
+	/// @param[in] pData - the event data, if any.
+	/// @return TRUE if the activity consumed the event.
+	virtual BOOL OnEvent(EVENT_INDEX /*event*/, const EventData* /*pData*/) { return FALSE; }
+};
+
+/// Downcast the state machine to the derived type. The action classes below are 
+/// shared with StaticStateMachine, which never calls the virtual action functions.
+/// @param[in] sm - A state machine instance.
+/// @return The derived state machine instance.
+template <class SM>
+inline SM* StateMachineCast(StateMachine* sm)
+{
+	if constexpr (std::is_base_of<StateMachine, SM>::value)
+		return static_cast<SM*>(sm);
+	else
+	{
+		ASSERT();
+		return NULL;
+	}
+}
 
 /// @brief Abstract state base class that all states inherit from.
 class StateBase
@@ -42,6 +139,11 @@ public:
 	/// @param[in] sm - A state machine instance. 
 	/// @param[in] data - The event data. 
 	virtual void InvokeStateAction(StateMachine* sm, const EventData* data) const = 0;
+
+	/// Create a default event data instance of the state function type on the heap.
+	/// Used by StateJournal to replay recorded event data.
+	/// @return The event data, or NULL if the type is not default constructible.
+	virtual EventData* CreateEventData() const { return NULL; }
 };
 
 /// @brief StateAction takes three template arguments: A state machine class,
@@ -51,11 +153,17 @@ template <class SM, class Data, void (SM::*Func)(const Data*)>
 class StateAction : public StateBase
 {
 public:
+	typedef Data DataType;
+
+	/// Call the state function directly without a virtual call or data downcast. 
+	/// Used by StaticStateMachine.
+	static void Dispatch(SM* sm, const Data* data) { (sm->*Func)(data); }
+
 	/// @see StateBase::InvokeStateAction
 	virtual void InvokeStateAction(StateMachine* sm, const EventData* data) const 
 	{
 		// Downcast the state machine and event data to the correct derived type
-		SM* derivedSM = static_cast<SM*>(sm);
+		SM* derivedSM = StateMachineCast<SM>(sm);
 		
 		// If this check fails, there is a mismatch between the STATE_DECLARE 
 		// event data type and the data type being sent to the state function. 
@@ -71,6 +179,15 @@ public:
 		// Call the state function
 		(derivedSM->*Func)(derivedData);
 	}
+
+	/// @see StateBase::CreateEventData
+	virtual EventData* CreateEventData() const
+	{
+		if constexpr (std::is_default_constructible<Data>::value)
+			return new Data();
+		else
+			return NULL;
+	}
 };
 
 /// @brief Abstract guard base class that all guards classes inherit from.
@@ -93,9 +210,14 @@ template <class SM, class Data, BOOL (SM::*Func)(const Data*)>
 class GuardCondition : public GuardBase
 {
 public:
+	typedef Data DataType;
+
+	/// Call the guard function directly. Used by StaticStateMachine.
+	static BOOL Dispatch(SM* sm, const Data* data) { return (sm->*Func)(data); }
+
 	virtual BOOL InvokeGuardCondition(StateMachine* sm, const EventData* data) const 
 	{
-		SM* derivedSM = static_cast<SM*>(sm);		
+		SM* derivedSM = StateMachineCast<SM>(sm);		
 		const Data* derivedData = dynamic_cast<const Data*>(data);
 		ASSERT_TRUE(derivedData != NULL);
 
@@ -122,9 +244,14 @@ template <class SM, class Data, void (SM::*Func)(const Data*)>
 class EntryAction : public EntryBase
 {
 public:
+	typedef Data DataType;
+
+	/// Call the entry function directly. Used by StaticStateMachine.
+	static void Dispatch(SM* sm, const Data* data) { (sm->*Func)(data); }
+
 	virtual void InvokeEntryAction(StateMachine* sm, const EventData* data) const
 	{
-		SM* derivedSM = static_cast<SM*>(sm);
+		SM* derivedSM = StateMachineCast<SM>(sm);
 		const Data* derivedData = dynamic_cast<const Data*>(data);
 		ASSERT_TRUE(derivedData != NULL);
 
@@ -149,19 +276,43 @@ template <class SM, void (SM::*Func)(void)>
 class ExitAction : public ExitBase
 {
 public:
+	/// Call the exit function directly. Used by StaticStateMachine.
+	static void Dispatch(SM* sm) { (sm->*Func)(); }
+
 	virtual void InvokeExitAction(StateMachine* sm) const
 	{
-		SM* derivedSM = static_cast<SM*>(sm);
+		SM* derivedSM = StateMachineCast<SM>(sm);
 
 		// Call the exit function
 		(derivedSM->*Func)();
 	}
 };
 
+/// @brief Resolves a state map entry type to a statically allocated action instance.
+/// State map entries are passed by type (e.g. decltype(&Idle)) so the map is built at 
+/// compile time. Action classes are stateless so a single instance is shared by all 
+/// state machine objects. A non-pointer entry type (e.g. a 0 literal) means no action.
+template <class T>
+struct StateMapObject
+{
+	static constexpr std::nullptr_t Get() { return nullptr; }
+};
+
+template <class T>
+struct StateMapObject<T*>
+{
+	static constexpr T Instance{};
+	static constexpr const T* Get() { return &Instance; }
+};
+
 /// @brief A structure to hold a single row within the state map. 
 struct StateMapRow
 {
 	const StateBase* const State;
+
+	/// Create a state map row from the state object type.
+	template <class S>
+	static constexpr StateMapRow Make() { return { StateMapObject<S>::Get() }; }
 };
 
 /// @brief A structure to hold a single row within the extended state map. 
@@ -171,49 +322,395 @@ struct StateMapRowEx
 	const GuardBase* const Guard;
 	const EntryBase* const Entry;
 	const ExitBase* const Exit;
+	const STATE_INDEX Parent;
+	const UINT Timeout;
+	const STATE_INDEX TimeoutState;
+
+	/// Create an extended state map row from the state, guard, entry and exit object types.
+	/// @param[in] parent - the parent (composite) state or StateHierarchy::NO_PARENT.
+	template <class S, class G = int, class E = int, class X = int>
+	static constexpr StateMapRowEx Make(STATE_INDEX parent = StateHierarchy::NO_PARENT) 
+	{ 
+		return { StateMapObject<S>::Get(), StateMapObject<G>::Get(), 
+			StateMapObject<E>::Get(), StateMapObject<X>::Get(), parent, 0, 0 };
+	}
+
+	/// Create an extended state map row with a state timeout.
+	/// @param[in] timeout - the timeout in milliseconds, armed on each transition into
+	///		the state and stopped on transition out of the state. 
+	/// @param[in] timeoutState - the state to transition to when the timeout expires.
+	/// @param[in] parent - the parent (composite) state or StateHierarchy::NO_PARENT.
+	template <class S, class G = int, class E = int, class X = int>
+	static constexpr StateMapRowEx MakeTimeout(UINT timeout, STATE_INDEX timeoutState, 
+		STATE_INDEX parent = StateHierarchy::NO_PARENT)
+	{
+		return { StateMapObject<S>::Get(), StateMapObject<G>::Get(),
+			StateMapObject<E>::Get(), StateMapObject<X>::Get(), parent, timeout, timeoutState };
+	}
+};
+
+/// @brief Traits used to invoke a queued external event member function. An 
+/// external event function takes either no argument, a single EventData pointer, or
+/// a std::unique_ptr owning its EventData.
+template <class F>
+struct ExternalEventTraits;
+
+template <class SM>
+struct ExternalEventTraits<void (SM::*)(void)>
+{
+	typedef SM StateMachineType;
+	typedef const EventData DataType;
+};
+
+template <class SM, class Data>
+struct ExternalEventTraits<void (SM::*)(Data*)>
+{
+	typedef SM StateMachineType;
+	typedef Data DataType;
+};
+
+template <class SM, class Data>
+struct ExternalEventTraits<void (SM::*)(std::unique_ptr<Data>)>
+{
+	typedef SM StateMachineType;
+	typedef Data DataType;
 };
 
 /// @brief StateMachine implements a software-based state machine. 
 class StateMachine 
 {
 public:
-	enum { EVENT_IGNORED = 0xFE, CANNOT_HAPPEN };
+	enum : STATE_INDEX { EVENT_IGNORED = STATE_INDEX_MAX - 1, CANNOT_HAPPEN };
 
 	///	Constructor.
 	///	@param[in] maxStates - the maximum number of state machine states.
-	StateMachine(BYTE maxStates, BYTE initialState = 0);
+	StateMachine(STATE_INDEX maxStates, STATE_INDEX initialState = 0);
 
-	virtual ~StateMachine() {}
+	virtual ~StateMachine();
 
 	/// Gets the current state machine state.
 	/// @return Current state machine state.
-	BYTE GetCurrentState() { return m_currentState; }
+	STATE_INDEX GetCurrentState() { return m_currentState; }
 
 	/// Gets the maximum number of state machine states.
 	/// @return The maximum state machine states. 
-	BYTE GetMaxStates() { return MAX_STATES; }
-	
+	STATE_INDEX GetMaxStates() { return MAX_STATES; }
+
+	/// Copy the most recent state transitions, oldest first. Callable from any thread
+	/// without stopping the state machine. 
+	/// @param[out] records - the destination array.
+	/// @param[in] maxRecords - the destination array size.
+	/// @return The number of records copied. Always 0 if STATE_MACHINE_TRACE is 0.
+	UINT GetTrace(StateTraceRecord* records, UINT maxRecords) const;
+
+	/// Copy the per state and transition statistics. Callable from any thread.
+	/// @param[out] stats - the destination.
+	/// @return TRUE if copied. FALSE if STATE_MACHINE_STATS is disabled.
+	BOOL GetStats(StateMachineStats& stats) const;
+
+	/// Create the optional bounded event queue. Call once before PostEvent().
+	/// @param[in] capacity - the maximum number of queued events.
+	void CreateEventQueue(UINT capacity);
+
+	/// Post an external event to the event queue. Callable from any thread. The 
+	/// event function executes later when the owner calls DispatchEvents(). For 
+	/// example:
+	///    motor.PostEvent<&Motor::SetSpeed>(new MotorData());
+	/// @param[in] pData - the event data sent to the event function, if any. Must be 
+	///		created on the heap. The queue deletes the data once the event completes,
+	///		or immediately if the event is not queued.
+	/// @return TRUE if queued. FALSE if the event queue is full. 
+	template <auto Event, class Data = const EventData>
+	BOOL PostEvent(Data* pData = NULL)
+	{
+		typedef ExternalEventTraits<decltype(Event)> Traits;
+		static_assert(std::is_convertible<Data*, typename Traits::DataType*>::value,
+			"Event data type does not match the external event function argument.");
+		return PostQueuedEvent(&InvokeEvent<Event>, 0, pData);
+	}
+
+	/// Post an external event by event ID to the event queue. Callable from any 
+	/// thread. The event executes later using Dispatch() when the owner calls 
+	/// DispatchEvents(). 
+	/// @param[in] event - the event ID. An index into the event map.
+	/// @param[in] pData - the event data sent to the state, if any. Must be created 
+	///		on the heap. The queue deletes the data once the event completes, or 
+	///		immediately if the event is not queued.
+	/// @return TRUE if queued. FALSE if the event queue is full. 
+	BOOL PostEvent(EVENT_INDEX event, const EventData* pData = NULL)
+	{
+		return PostQueuedEvent(&InvokeDispatch, event, pData);
+	}
+
+	/// Post a coalescing external event to the event queue. Callable from any thread.
+	/// If the last queued event is the same event, also posted by PostLatestEvent(),
+	/// the new event data replaces its event data and the older data is deleted, so
+	/// only the latest value is processed. Otherwise the event is queued like 
+	/// PostEvent(), so events are never reordered.
+	/// For example:
+	///    motor.PostLatestEvent<&Motor::SetSpeed>(new MotorData());
+	/// @param[in] pData - the event data sent to the event function, if any. Must be
+	///		created on the heap.
+	/// @return TRUE if queued or coalesced. FALSE if the event queue is full.
+	template <auto Event, class Data = const EventData>
+	BOOL PostLatestEvent(Data* pData = NULL)
+	{
+		typedef ExternalEventTraits<decltype(Event)> Traits;
+		static_assert(std::is_convertible<Data*, typename Traits::DataType*>::value,
+			"Event data type does not match the external event function argument.");
+		return PostQueuedEvent(&InvokeEvent<Event>, 0, pData, POST_COALESCE);
+	}
+
+	/// Post a coalescing external event by event ID to the event queue. Callable from
+	/// any thread. See PostLatestEvent() above.
+	/// @param[in] event - the event ID. An index into the event map.
+	/// @param[in] pData - the event data sent to the state, if any. Must be created
+	///		on the heap.
+	/// @return TRUE if queued or coalesced. FALSE if the event queue is full.
+	BOOL PostLatestEvent(EVENT_INDEX event, const EventData* pData = NULL)
+	{
+		return PostQueuedEvent(&InvokeDispatch, event, pData, POST_COALESCE);
+	}
+
+	/// Post a priority external event to the event queue. Callable from any thread.
+	/// The event executes ahead of all queued normal events, after any priority 
+	/// events already queued, and interrupts a batch of normal events being 
+	/// dispatched. If purge is TRUE, the queued normal external events are discarded
+	/// first and never execute. State timeout and state activity events are kept. 
+	/// One priority event always fits, even when normal events fill the queue. 
+	/// For example, purging with no event data, which names the data type since
+	/// NULL cannot deduce it:
+	///    test.PostPriorityEvent<&SelfTest::Cancel, const EventData>(NULL, TRUE);
+	/// @param[in] pData - the event data sent to the event function, if any. Must be
+	///		created on the heap.
+	/// @param[in] purge - TRUE to discard the queued normal events.
+	/// @return TRUE if queued. FALSE if the event queue is full of priority events. 
+	template <auto Event, class Data = const EventData>
+	BOOL PostPriorityEvent(Data* pData = NULL, BOOL purge = FALSE)
+	{
+		typedef ExternalEventTraits<decltype(Event)> Traits;
+		static_assert(std::is_convertible<Data*, typename Traits::DataType*>::value,
+			"Event data type does not match the external event function argument.");
+		return PostQueuedEvent(&InvokeEvent<Event>, 0, pData, 
+			purge ? POST_PRIORITY | POST_PURGE : POST_PRIORITY);
+	}
+
+	/// Post a priority external event by event ID to the event queue. Callable from
+	/// any thread. See PostPriorityEvent() above.
+	/// @param[in] event - the event ID. An index into the event map.
+	/// @param[in] pData - the event data sent to the state, if any. Must be created
+	///		on the heap.
+	/// @param[in] purge - TRUE to discard the queued normal events.
+	/// @return TRUE if queued. FALSE if the event queue is full of priority events.
+	BOOL PostPriorityEvent(EVENT_INDEX event, const EventData* pData = NULL, BOOL purge = FALSE)
+	{
+		return PostQueuedEvent(&InvokeDispatch, event, pData, 
+			purge ? POST_PRIORITY | POST_PURGE : POST_PRIORITY);
+	}
+
+	/// @brief An external event posted as part of a batch using PostEvents(). 
+	class BatchEvent
+	{
+	public:
+		/// Create an event calling an external event function. See PostEvent().
+		/// @param[in] pData - the event data sent to the event function, if any. Must
+		///		be created on the heap.
+		template <auto Event, class Data = const EventData>
+		static BatchEvent Create(Data* pData = NULL)
+		{
+			typedef ExternalEventTraits<decltype(Event)> Traits;
+			static_assert(std::is_convertible<Data*, typename Traits::DataType*>::value,
+				"Event data type does not match the external event function argument.");
+			return BatchEvent(&InvokeEvent<Event>, 0, pData);
+		}
+
+		/// Create an event by event ID. See PostEvent().
+		/// @param[in] event - the event ID. An index into the event map.
+		/// @param[in] pData - the event data sent to the state, if any. Must be created
+		///		on the heap.
+		static BatchEvent Create(EVENT_INDEX event, const EventData* pData = NULL)
+		{
+			return BatchEvent(&InvokeDispatch, event, pData);
+		}
+
+		/// Delete the event data of an event that will not be posted.
+		void Discard() const { DeleteEventData(pData); }
+
+	private:
+		friend class StateMachine;
+
+		BatchEvent(void (*invoke)(StateMachine*, EVENT_INDEX, const EventData*), EVENT_INDEX event, const EventData* pData) :
+			Invoke(invoke), Event(event), pData(pData) {}
+
+		void (*Invoke)(StateMachine* sm, EVENT_INDEX event, const EventData* data);
+		EVENT_INDEX Event;
+		const EventData* pData;
+	};
+
+	/// Post a batch of external events to the event queue. Callable from any thread.
+	/// The events are queued in order using one lock acquisition, and the owner is 
+	/// woken up at most once. For example:
+	///    StateMachine::BatchEvent events[] = {
+	///        StateMachine::BatchEvent::Create<&Motor::SetSpeed>(new MotorData()),
+	///        StateMachine::BatchEvent::Create<&Motor::Halt>() };
+	///    motor.PostEvents(events, 2);
+	/// @param[in] events - the events. 
+	/// @param[in] count - the number of events.
+	/// @return The number of events queued. The events that do not fit in the event
+	///		queue are discarded and their event data deleted.
+	UINT PostEvents(const BatchEvent* events, UINT count);
+
+	/// Generate an external event by event ID. The event map row of the event 
+	/// selects the new state using the current state, the same as the transition map 
+	/// of an external event function. The state machine must define an event map 
+	/// using BEGIN_EVENT_MAP, EVENT_MAP_ROW and END_EVENT_MAP.
+	/// @param[in] event - the event ID. An index into the event map.
+	/// @param[in] pData - the event data sent to the state.
+	void Dispatch(EVENT_INDEX event, const EventData* pData = NULL);
+
+	/// Execute all queued events on the calling thread. Each event runs to completion
+	/// before the next event starts. Queued events are removed in batches using one
+	/// lock acquisition per batch. Only the state machine owner thread may call.
+	/// @return The number of events executed.
+	UINT DispatchEvents();
+
+	/// Get the size of the binary snapshot written by SaveSnapshot(). The size is
+	/// fixed once all extended state variables are registered.
+	/// @return The snapshot size in bytes, a multiple of 8.
+	UINT GetSnapshotSize() const;
+
+	/// Save the current state and registered extended state variables into a binary
+	/// snapshot. Call on the state machine thread, or while no event executes.
+	/// @param[out] buffer - the destination.
+	/// @param[in] size - the destination size in bytes.
+	/// @return The number of bytes written, or 0 if size is too small.
+	UINT SaveSnapshot(void* buffer, UINT size) const;
+
+	/// Restore the current state and registered extended state variables from a
+	/// snapshot created by SaveSnapshot(). No state, guard, entry or exit action
+	/// executes. Call on the state machine thread, or while no event executes.
+	/// @param[in] buffer - the snapshot.
+	/// @param[in] size - the snapshot size in bytes.
+	/// @return TRUE if restored. FALSE if the snapshot is invalid or was created by a
+	///		state machine with a different state count or variable layout.
+	BOOL RestoreSnapshot(const void* buffer, UINT size);
+
+	/// Make an activity the current state activity, deleting any previous activity.
+	/// Call from a state action on the state machine thread.
+	/// @param[in] activity - the activity created on the heap. The state machine 
+	///		deletes it.
+	void SetStateActivity(StateActivity* activity);
+
+	/// Get the current state activity generation. Changes each time the activity is
+	/// set or deleted.
+	UINT GetStateActivityGeneration() const { return m_stateActivityGeneration; }
+
+	/// Resume the current state activity later on the state machine thread using the 
+	/// event queue. Callable from any thread. Requires CreateEventQueue().
+	/// @param[in] generation - the GetStateActivityGeneration() value when the activity
+	///		suspended. Ignored if the activity has since been replaced or deleted.
+	void ResumeStateActivity(UINT generation);
+
+	/// Record every external event into a journal, or stop recording. Events 
+	/// generated by ID record the event ID. Call on the state machine thread, or 
+	/// while no event executes.
+	/// @param[in] journal - an open journal, or NULL. Must outlive the recording.
+	void SetJournal(StateJournal* journal) { m_journal = journal; }
+
 protected:
+	/// Called when a PostEvent() makes the event queue non-empty. Called once per
+	/// batch and not for every post. Override to wake up the owner thread, which then
+	/// calls DispatchEvents(). Called on the posting thread. 
+	virtual void OnEventsPosted() {}
+
+	/// Insert a batch of events into the event queue without calling OnEventsPosted().
+	/// Used to wake up the owners of several state machines together. 
+	/// @param[in] events - the events.
+	/// @param[in] count - the number of events.
+	/// @param[out] notify - set to TRUE if the owner must be woken up, FALSE otherwise.
+	/// @return The number of events queued. 
+	UINT QueueEvents(const BatchEvent* events, UINT count, BOOL& notify);
+
+	/// Called instead of OnEventsPosted() by the state timeout timer thread, which 
+	/// must never block. Override to wake up the owner thread without waiting for 
+	/// room in its message queue.
+	/// @return TRUE if the owner was woken up. FALSE after calling ResetEventsPosted().
+	virtual BOOL OnEventsPostedNoWait() { OnEventsPosted(); return TRUE; }
+
+	/// Called by an OnEventsPosted() override that failed to wake up the owner. The 
+	/// events stay queued and the next post wakes up the owner again.
+	void ResetEventsPosted();
+
+	/// Called on each PostPriorityEvent(), whether or not the event queue was empty.
+	/// Override to wake up the owner thread ahead of other pending work. Called on 
+	/// the posting thread.
+	virtual void OnPriorityEventPosted() { OnEventsPosted(); }
+
 	/// External state machine event.
 	/// @param[in] newState - the state machine state to transition to.
 	/// @param[in] pData - the event data sent to the state.
-	void ExternalEvent(BYTE newState, const EventData* pData = NULL);
+	void ExternalEvent(STATE_INDEX newState, const EventData* pData = NULL);
+
+	/// External state machine event from an event function taking ownership of its
+	/// event data. The event data is deleted once the state action completes.
+	/// @param[in] newState - the state machine state to transition to.
+	/// @param[in] pData - the event data sent to the state.
+	template <class Data>
+	void ExternalEvent(STATE_INDEX newState, std::unique_ptr<Data>& pData)
+	{
+		ExternalEvent(newState, TransferEventData(pData));
+	}
+
+	/// Pass owned event data to ExternalEvent().
+	/// @param[in] pData - the event data.
+	/// @return The event data pointer sent to the state.
+	template <class Data>
+	static const EventData* TransferEventData(std::unique_ptr<Data>& pData)
+	{
+#ifdef EXTERNAL_EVENT_NO_HEAP_DATA
+		// pData deletes the event data when the event function returns
+		return pData.get();
+#else
+		// The state engine deletes the event data
+		return pData.release();
+#endif
+	}
 
 	/// Internal state machine event. These events are generated while executing
 	///	within a state machine state.
 	/// @param[in] newState - the state machine state to transition to.
 	/// @param[in] pData - the event data sent to the state.
-	void InternalEvent(BYTE newState, const EventData* pData = NULL);
+	void InternalEvent(STATE_INDEX newState, const EventData* pData = NULL);
+
+	/// Stop the current state timeout, if running. Called by a derived class destructor
+	/// whose OnEventsPosted() override must not be called once destruction begins.
+	void StopStateTimeout();
+
+	/// Delete the current state activity, if any. Also called by a derived class 
+	/// destructor, for the same reason as StopStateTimeout().
+	void CancelStateActivity();
+
+	/// Register an extended state variable saved and restored with snapshots. Call
+	/// from the derived class constructor. The variable is copied byte for byte, so
+	/// it must be trivially copyable and must not hold pointers.
+	/// @param[in] variable - the extended state variable.
+	template <class T>
+	void RegisterSnapshotVariable(T& variable)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value,
+			"Snapshot variables must be trivially copyable and not pointers.");
+		RegisterSnapshotVariable(&variable, sizeof(T));
+	}
 	
 private:
 	/// The maximum number of state machine states.
-	const BYTE MAX_STATES;
+	const STATE_INDEX MAX_STATES;
 
 	/// The current state machine state.
-	BYTE m_currentState;
+	STATE_INDEX m_currentState;
 
 	/// The new state the state machine has yet to transition to. 
-	BYTE m_newState;
+	STATE_INDEX m_newState;
 
 	/// Set to TRUE when an event is generated.
 	BOOL m_eventGenerated;
@@ -221,6 +718,202 @@ private:
 	/// The state event data pointer.
 	const EventData* m_pEventData;
 
+	/// The precomputed exit/entry paths, or NULL if the state map is not hierarchical.
+	const StateHierarchy* m_hierarchy;
+
+	/// Set to TRUE once m_hierarchy is resolved from the state map.
+	BOOL m_hierarchyResolved;
+
+	/// The journal recording external events, or NULL.
+	StateJournal* m_journal;
+
+	/// Set to TRUE while Dispatch() executes an event it already recorded.
+	BOOL m_journalDispatch;
+
+	/// Replays journaled events using Dispatch(), ExternalEvent() and the state map.
+	friend class StateJournal;
+
+#if STATE_MACHINE_TRACE
+	/// The recent transition history.
+	StateTrace m_trace;
+#endif
+
+#if STATE_MACHINE_STATS
+	/// The per state and transition statistics.
+	StateStats m_stats;
+#endif
+
+	/// Record a transition into the trace, if enabled.
+	void TraceTransition(BOOL guardResult, const EventData* pData);
+
+	/// Called when an event targets a state outside the state map. Prints the trace
+	/// and asserts.
+	void InvalidTransition();
+
+	/// A queued external event. 
+	struct QueuedEvent
+	{
+		void (*Invoke)(StateMachine* sm, EVENT_INDEX event, const EventData* data);
+		EVENT_INDEX Event;
+		BOOL Coalesce;		// Posted by PostLatestEvent()
+		const EventData* pData;
+	};
+
+	/// Event queue slots reserved for the state timeout, the state activity and one 
+	/// priority event.
+	enum { RESERVED_EVENTS = 3 };
+
+	/// Event queue ring buffer and the batch buffer used by DispatchEvents().
+	QueuedEvent* m_eventQueue;
+	QueuedEvent* m_eventBatch;
+	UINT m_eventQueueCapacity;
+	UINT m_eventQueueHead;
+	UINT m_eventQueueCount;
+
+	/// The number of priority events at the front of the event queue.
+	UINT m_eventQueuePriorityCount;
+
+	/// Incremented each time queued events are purged.
+	UINT m_eventQueuePurges;
+
+	/// Set when a priority event is posted, cleared once it is removed from the queue.
+	std::atomic<bool> m_priorityEventPosted;
+
+	/// Set to TRUE from the first post into an empty queue until the queue is drained.
+	BOOL m_eventsPosted;
+
+	/// An extended state variable saved with snapshots.
+	struct SnapshotVariable
+	{
+		void* pVariable;
+		UINT size;
+	};
+
+	/// The registered extended state variables.
+	std::vector<SnapshotVariable> m_snapshotVariables;
+
+	/// Add an extended state variable to the snapshot.
+	void RegisterSnapshotVariable(void* pVariable, UINT size);
+
+	/// Lock protecting the event queue.
+	std::mutex m_eventQueueLock;
+
+	/// The current state timeout on the shared StateTimerWheel.
+	StateTimer m_stateTimer;
+
+	/// Set to TRUE while m_stateTimer is started and its timeout not yet handled.
+	BOOL m_stateTimeoutRunning;
+
+	/// The m_stateTimer generation that last expired.
+	std::atomic<UINT> m_stateTimerExpired;
+
+	/// Start or stop the state timeout on transition into a state.
+	/// @param[in] row - the new state map row.
+	void StartStateTimeout(const StateMapRowEx& row);
+
+	/// Called by the StateTimerWheel when m_stateTimer expires.
+	static void OnStateTimerExpired(void* context, UINT generation);
+
+	/// Execute the timeout transition of the current state. Queued by 
+	/// OnStateTimerExpired().
+	static void InvokeStateTimeout(StateMachine* sm, EVENT_INDEX, const EventData*);
+
+	/// The current state activity, or NULL.
+	StateActivity* m_stateActivity;
+
+	/// The activity executing Resume() or OnEvent(), or NULL.
+	StateActivity* m_runningActivity;
+
+	/// An activity cancelled while executing, deleted once it returns.
+	StateActivity* m_retiredActivity;
+
+	/// Incremented each time the current state activity changes.
+	UINT m_stateActivityGeneration;
+
+	/// The generation of the last ResumeStateActivity().
+	std::atomic<UINT> m_stateActivityResume;
+
+	/// Resume the current state activity. Queued by ResumeStateActivity().
+	static void InvokeStateActivity(StateMachine* sm, EVENT_INDEX, const EventData*);
+
+	/// Execute the current state activity. 
+	/// @return TRUE if an offered event was consumed.
+	BOOL RunStateActivity(BOOL offerEvent, EVENT_INDEX event, const EventData* pData);
+
+	/// PostQueuedEvent() options.
+	enum 
+	{ 
+		POST_COALESCE = 0x01,	// An identical last queued event takes the new data instead
+		POST_PRIORITY = 0x02,	// Queue ahead of normal events
+		POST_PURGE = 0x04,		// Discard queued normal external events first
+		POST_NO_WAIT = 0x08		// Wake up the owner using OnEventsPostedNoWait()
+	};
+
+	/// Insert an event into the event queue.
+	/// @param[in] flags - POST_COALESCE, POST_PRIORITY, POST_PURGE and POST_NO_WAIT 
+	///		options.
+	/// @return TRUE if queued. FALSE if the event queue is full, or with POST_NO_WAIT,
+	///		if the event is queued but the owner was not woken up.
+	BOOL PostQueuedEvent(void (*invoke)(StateMachine*, EVENT_INDEX, const EventData*), EVENT_INDEX event, const EventData* pData, UINT flags = 0);
+
+	/// Get an event queue slot.
+	/// @param[in] index - the position from the front of the queue.
+	QueuedEvent& GetQueuedEvent(UINT index) { return m_eventQueue[(m_eventQueueHead + index) % m_eventQueueCapacity]; }
+
+	/// Get whether a queued event is a state timeout or state activity event, which
+	/// may use the reserved slots and are never purged.
+	static BOOL IsReservedEvent(void (*invoke)(StateMachine*, EVENT_INDEX, const EventData*))
+	{
+		return invoke == &InvokeStateTimeout || invoke == &InvokeStateActivity;
+	}
+
+	/// Remove the queued normal external events. Called with the queue locked.
+	/// @param[out] purged - receives the event data to delete once unlocked.
+	void PurgeQueuedEvents(std::vector<const EventData*>& purged);
+
+	/// Execute the priority events queued while a batch is dispatched.
+	/// @param[out] purges - the m_eventQueuePurges value after the last event.
+	/// @return The number of events executed.
+	UINT DispatchPriorityEvents(UINT& purges);
+
+	/// Invoke a queued external event function.
+	template <auto Event>
+	static void InvokeEvent(StateMachine* sm, EVENT_INDEX, const EventData* data)
+	{
+		typedef ExternalEventTraits<decltype(Event)> Traits;
+		typedef typename Traits::StateMachineType SM;
+		typedef typename Traits::DataType Data;
+
+		SM* derivedSM = static_cast<SM*>(sm);
+		if constexpr (std::is_same<decltype(Event), void (SM::*)(std::unique_ptr<Data>)>::value)
+		{
+			// The event function owns the event data
+			(derivedSM->*Event)(std::unique_ptr<Data>(static_cast<Data*>(const_cast<EventData*>(data))));
+			return;
+		}
+		else if constexpr (std::is_same<decltype(Event), void (SM::*)(void)>::value)
+			(derivedSM->*Event)();
+		else
+			(derivedSM->*Event)(static_cast<Data*>(const_cast<EventData*>(data)));
+
+#ifdef EXTERNAL_EVENT_NO_HEAP_DATA
+		// ExternalEvent() does not delete external event data
+		DeleteEventData(data);
+#endif
+	}
+
+	/// Invoke a queued event by event ID.
+	static void InvokeDispatch(StateMachine* sm, EVENT_INDEX event, const EventData* data)
+	{
+		sm->Dispatch(event, data);
+#ifdef EXTERNAL_EVENT_NO_HEAP_DATA
+		DeleteEventData(data);
+#endif
+	}
+
+	/// Delete queued event data. 
+	static void DeleteEventData(const EventData* pData);
+
 	/// Gets the state map as defined in the derived class. The BEGIN_STATE_MAP,
 	/// STATE_MAP_ENTRY and END_STATE_MAP macros are used to assist in creating the
 	/// map. A state machine only needs to return a state map using either GetStateMap()  
@@ -237,9 +930,22 @@ private:
 	/// NULL if the state machine uses the GetStateMap().
 	virtual const StateMapRowEx* GetStateMapEx() = 0;
 
+	/// Gets the new state for an event using the event map defined in the derived 
+	/// class. The BEGIN_EVENT_MAP, EVENT_MAP_ROW and END_EVENT_MAP macros are used to 
+	/// assist in creating the map.
+	/// @param[in] event - the event ID.
+	/// @param[in] currentState - the current state.
+	/// @return The new state, EVENT_IGNORED or CANNOT_HAPPEN.
+	virtual STATE_INDEX GetEventTransition(EVENT_INDEX /*event*/, STATE_INDEX /*currentState*/) 
+	{ 
+		// The state machine has no event map
+		ASSERT();
+		return CANNOT_HAPPEN; 
+	}
+
 	/// Set a new current state.
 	/// @param[in] newState - the new state.
-	void SetCurrentState(BYTE newState) { m_currentState = newState; }
+	void SetCurrentState(STATE_INDEX newState) { m_currentState = newState; }
 
 	/// State machine engine that executes the external event and, optionally, all 
 	/// internal events generated during state execution.
@@ -276,17 +982,44 @@ private:
 #define EXIT_DEFINE(stateMachine, exitName) \
 	void stateMachine::EX_##exitName(void)
 
+// Transition map entries are packed using the smallest type holding ST_MAX_STATES.
 #define BEGIN_TRANSITION_MAP \
-    static const BYTE TRANSITIONS[] = {\
+	typedef TransitionEntry<ST_MAX_STATES> TransitionEntryType; \
+    static const typename TransitionEntryType::Type TRANSITIONS[] = {\
 
 #define TRANSITION_MAP_ENTRY(entry)\
-    entry,
+    TransitionEntryType::Pack(entry),
 
 #define END_TRANSITION_MAP(data) \
     };\
 	ASSERT_TRUE(GetCurrentState() < ST_MAX_STATES); \
-    ExternalEvent(TRANSITIONS[GetCurrentState()], data); \
-	C_ASSERT((sizeof(TRANSITIONS)/sizeof(BYTE)) == ST_MAX_STATES); 
+    ExternalEvent(TransitionEntryType::Unpack(TRANSITIONS[GetCurrentState()]), data); \
+	C_ASSERT((sizeof(TRANSITIONS)/sizeof(TRANSITIONS[0])) == ST_MAX_STATES); 
+
+// The event map macros generate a single contiguous [event][state] transition table 
+// used by Dispatch(). Each EVENT_MAP_ROW is followed by one TRANSITION_MAP_ENTRY per 
+// state, in state enumeration order. Rows must be in event enumeration order, which
+// END_EVENT_MAP checks at compile time.
+#define BEGIN_EVENT_MAP \
+	template <class> friend class StaticStateMachine; \
+	private:\
+	STATE_INDEX GetEventTransition(EVENT_INDEX event, STATE_INDEX currentState) { return GetEventTransitionT(event, currentState); }\
+	static STATE_INDEX GetEventTransitionT(EVENT_INDEX event, STATE_INDEX currentState) {\
+		typedef TransitionEntry<ST_MAX_STATES> TransitionEntryType; \
+		typedef EventMapEntry<ST_MAX_STATES> EventMapEntryType; \
+		static constexpr EventMapEntryType EVENT_MAP_ENTRIES[] = {
+
+#define EVENT_MAP_ROW(eventName) \
+	EventMapEntryType::Row(eventName),
+
+#define END_EVENT_MAP(maxEvents) \
+		};\
+		static_assert(EventMapEntryType::Check(EVENT_MAP_ENTRIES, (maxEvents)), \
+			"Each EVENT_MAP_ROW must be in event order and followed by one TRANSITION_MAP_ENTRY per state."); \
+		static_assert((size_t)(maxEvents) - 1 <= (size_t)EVENT_INDEX_MAX, "Too many events for EVENT_INDEX_TYPE."); \
+		static constexpr auto EVENT_MAP = EventMapEntryType::template Pack<(maxEvents)>(EVENT_MAP_ENTRIES); \
+		ASSERT_TRUE(event < (maxEvents) && currentState < ST_MAX_STATES); \
+		return TransitionEntryType::Unpack(EVENT_MAP[(size_t)event * ST_MAX_STATES + currentState]); }
 
 #define PARENT_TRANSITION(state) \
 	if (GetCurrentState() >= ST_MAX_STATES && \
@@ -294,35 +1027,57 @@ private:
 		ExternalEvent(state); \
 		return; }
 	
+// The state map macros generate GetStateMapT(), a template that builds the state map 
+// for any row type at compile time. StateMachine uses StateMapRow/StateMapRowEx rows 
+// and StaticStateMachine uses StaticStateMapRowEx rows from the same map definition.
 #define BEGIN_STATE_MAP \
+	template <class> friend class StaticStateMachine; \
 	private:\
-	virtual const StateMapRowEx* GetStateMapEx() { return NULL; }\
-	virtual const StateMapRow* GetStateMap() {\
-		static const StateMapRow STATE_MAP[] = { 
+	const StateMapRowEx* GetStateMapEx() { return NULL; }\
+	const StateMapRow* GetStateMap() { return GetStateMapT<StateMapRow>(); }\
+	template <class Row> \
+	static const Row* GetStateMapT() {\
+		static constexpr Row STATE_MAP[] = { 
 
 #define STATE_MAP_ENTRY(stateName)\
-	stateName,
+	Row::template Make<decltype(stateName)>(),
 
 #define END_STATE_MAP \
     }; \
-	C_ASSERT((sizeof(STATE_MAP)/sizeof(StateMapRow)) == ST_MAX_STATES); \
+	C_ASSERT((sizeof(STATE_MAP)/sizeof(Row)) == ST_MAX_STATES); \
 	return &STATE_MAP[0]; }
 
 #define BEGIN_STATE_MAP_EX \
+	template <class> friend class StaticStateMachine; \
 	private:\
-	virtual const StateMapRow* GetStateMap() { return NULL; }\
-	virtual const StateMapRowEx* GetStateMapEx() {\
-		static const StateMapRowEx STATE_MAP[] = { 
+	const StateMapRow* GetStateMap() { return NULL; }\
+	const StateMapRowEx* GetStateMapEx() { return GetStateMapT<StateMapRowEx>(); }\
+	template <class Row> \
+	static const Row* GetStateMapT() {\
+		static constexpr Row STATE_MAP[] = { 
 
 #define STATE_MAP_ENTRY_EX(stateName)\
-	{ stateName, 0, 0, 0 },
+	Row::template Make<decltype(stateName)>(),
 
 #define STATE_MAP_ENTRY_ALL_EX(stateName, guardName, entryName, exitName)\
-	{ stateName, guardName, entryName, exitName },
+	Row::template Make<decltype(stateName), decltype(guardName), decltype(entryName), decltype(exitName)>(),
+
+// A hierarchical state nested within parentState. Transitions into or out of the state 
+// execute the exit and entry actions of each composite state crossed.
+#define STATE_MAP_ENTRY_CHILD_EX(stateName, parentState, guardName, entryName, exitName)\
+	Row::template Make<decltype(stateName), decltype(guardName), decltype(entryName), decltype(exitName)>(parentState),
+
+// A state with a timeout. After timeout milliseconds in the state without a transition,
+// the state machine transitions to timeoutState. Each transition into the state, including
+// a self-transition, restarts the timeout. Requires CreateEventQueue(); entering the 
+// state without an event queue fails an ASSERT. Not supported by StaticStateMachine, 
+// which rejects the entry at compile time.
+#define STATE_MAP_ENTRY_TIMEOUT_EX(stateName, guardName, entryName, exitName, timeout, timeoutState)\
+	Row::template MakeTimeout<decltype(stateName), decltype(guardName), decltype(entryName), decltype(exitName)>(timeout, timeoutState),
 
 #define END_STATE_MAP_EX \
     }; \
-	C_ASSERT((sizeof(STATE_MAP)/sizeof(StateMapRowEx)) == ST_MAX_STATES); \
+	C_ASSERT((sizeof(STATE_MAP)/sizeof(Row)) == ST_MAX_STATES); \
    return &STATE_MAP[0]; }
 
 #endif // _STATE_MACHINE_H
@@ -0,0 +1,86 @@
+#include "StateRegions.h"
+
+using namespace dmq;
+
+//----------------------------------------------------------------------------
+// StateRegions
+//----------------------------------------------------------------------------
+StateRegions::StateRegions(dmq::os::ThreadPool* pool) :
+	m_pool(pool),
+	m_event(0),
+	m_pData(NULL),
+	m_pending(0)
+{
+}
+
+//----------------------------------------------------------------------------
+// AddRegion
+//----------------------------------------------------------------------------
+void StateRegions::AddRegion(StateMachine& region)
+{
+	Region entry = { &region, nullptr, nullptr };
+	if (m_pool)
+	{
+		entry.Strand = m_pool->CreateStrand();
+		entry.Msg = std::make_shared<DelegateMsg>(
+			std::make_shared<DispatchRegionInvoker>(this, m_regions.size()), Priority::NORMAL);
+	}
+	m_regions.push_back(entry);
+}
+
+//----------------------------------------------------------------------------
+// Dispatch
+//----------------------------------------------------------------------------
+void StateRegions::Dispatch(EVENT_INDEX event, const EventData* pData)
+{
+	if (m_regions.empty())
+		return;
+
+#ifndef EXTERNAL_EVENT_NO_HEAP_DATA
+	// Each region deletes its event data; the data cannot be shared
+	ASSERT_TRUE(pData == NULL);
+#endif
+
+	// Execute serially without a pool, or if the caller is a pool worker that
+	// could otherwise wait on work queued behind itself
+	if (m_pool == nullptr || m_regions.size() == 1 || m_pool->IsCurrentThread())
+	{
+		for (size_t i = 0; i < m_regions.size(); i++)
+			m_regions[i].Machine->Dispatch(event, pData);
+		return;
+	}
+
+	m_event = event;
+	m_pData = pData;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_pending = m_regions.size() - 1;
+	}
+
+	// Fork the other regions onto their strands, execute the first region here. A
+	// region the strand rejects, because the pool is exiting, executes here too.
+	for (size_t i = 1; i < m_regions.size(); i++)
+	{
+		if (!m_regions[i].Strand->DispatchDelegate(m_regions[i].Msg))
+			DispatchRegion(i);
+	}
+	m_regions[0].Machine->Dispatch(event, pData);
+
+	// Join
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_done.wait(lock, [this]() { return m_pending == 0; });
+}
+
+//----------------------------------------------------------------------------
+// DispatchRegion
+//----------------------------------------------------------------------------
+void StateRegions::DispatchRegion(size_t index)
+{
+	m_regions[index].Machine->Dispatch(m_event, m_pData);
+
+	// Notify while locked; the dispatching thread may return and destroy this
+	// instance as soon as the lock is released
+	std::lock_guard<std::mutex> lock(m_lock);
+	if (--m_pending == 0)
+		m_done.notify_one();
+}
@@ -0,0 +1,102 @@
+#ifndef _STATE_REGIONS_H
+#define _STATE_REGIONS_H
+
+#include "StateMachine.h"
+#include "DelegateMQ.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+/// @brief StateRegions holds the orthogonal (AND) regions of a composite state. Each
+/// region is an independent StateMachine with its own event map. Dispatch() sends
+/// the same event to every region and returns once all regions have executed it, so
+/// the owning state machine continues with every region in its new state.
+///
+/// Without a thread pool the regions execute one after another on the calling thread.
+/// With a thread pool the regions execute concurrently, each serialized on its own
+/// strand, with the calling thread executing the first region. Regions executing
+/// concurrently must not share data, and the event data is shared read-only. Every
+/// region receives the same event data pointer, so event data requires 
+/// EXTERNAL_EVENT_NO_HEAP_DATA; otherwise each region would delete it.
+///
+/// For example, a parent state machine forwards events while in its composite state:
+///    STATE_DEFINE(Rig, Testing, RigData)
+///    {
+///        m_regions.Dispatch(RegionEvents::EV_TICK, data);
+///    }
+class StateRegions
+{
+public:
+	/// Constructor.
+	/// @param[in] pool - the running thread pool executing the regions concurrently,
+	///		or nullptr to execute the regions serially. Must outlive this instance.
+	explicit StateRegions(dmq::os::ThreadPool* pool = nullptr);
+
+	/// Add a region. Call before the first Dispatch().
+	/// @param[in] region - the region state machine. Must define an event map and
+	///		outlive this instance. Not an AsyncStateMachine; the region executes on
+	///		the thread selected by Dispatch().
+	void AddRegion(StateMachine& region);
+
+	/// Get the number of regions.
+	size_t GetRegionCount() const { return m_regions.size(); }
+
+	/// Get a region.
+	/// @param[in] index - the region index, in the order added.
+	/// @return The region state machine.
+	StateMachine& GetRegion(size_t index) { return *m_regions[index].Machine; }
+
+	/// Dispatch an event to every region and wait until all regions complete. Not
+	/// reentrant; call from the owning state machine thread only.
+	/// @param[in] event - the event ID. An index into each region's event map.
+	/// @param[in] pData - the event data sent to each region, if any. Owned by the
+	///		caller. Must be NULL unless EXTERNAL_EVENT_NO_HEAP_DATA is defined.
+	void Dispatch(EVENT_INDEX event, const EventData* pData = NULL);
+
+private:
+	StateRegions(const StateRegions&) = delete;
+	StateRegions& operator=(const StateRegions&) = delete;
+
+	/// Execute the current event on a region and signal completion.
+	void DispatchRegion(size_t index);
+
+	/// Invokes DispatchRegion() on the region strand.
+	class DispatchRegionInvoker : public dmq::IThreadInvoker
+	{
+	public:
+		DispatchRegionInvoker(StateRegions* regions, size_t index) : m_regions(regions), m_index(index) {}
+		virtual bool Invoke(std::shared_ptr<dmq::DelegateMsg> /*msg*/) override
+		{
+			m_regions->DispatchRegion(m_index);
+			return true;
+		}
+	private:
+		StateRegions* const m_regions;
+		const size_t m_index;
+	};
+
+	struct Region
+	{
+		StateMachine* Machine;
+		std::shared_ptr<dmq::os::Strand> Strand;
+
+		// The strand message sent by each Dispatch(). Reused, since Dispatch() 
+		// waits for the region to complete.
+		std::shared_ptr<dmq::DelegateMsg> Msg;
+	};
+
+	dmq::os::ThreadPool* const m_pool;
+	std::vector<Region> m_regions;
+
+	/// The event being dispatched.
+	EVENT_INDEX m_event;
+	const EventData* m_pData;
+
+	/// Regions yet to complete the current event.
+	size_t m_pending;
+	std::mutex m_lock;
+	std::condition_variable m_done;
+};
+
+#endif // _STATE_REGIONS_H
@@ -0,0 +1,79 @@
+#include "StateSnapshot.h"
+#include <cstring>
+
+namespace
+{
+	/// The fleet header, followed by count 64-bit record offsets.
+	struct FleetHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t count;
+	};
+
+	const uint32_t FLEET_MAGIC = 0x54464D53;		// "SMFT"
+	const uint32_t FLEET_VERSION = 1;
+
+	size_t GetRecordsOffset(size_t count)
+	{
+		return sizeof(FleetHeader) + count * sizeof(uint64_t);
+	}
+}
+
+//----------------------------------------------------------------------------
+// GetSize
+//----------------------------------------------------------------------------
+size_t StateSnapshot::GetSize(StateMachine* const* machines, size_t count)
+{
+	size_t size = GetRecordsOffset(count);
+	for (size_t i = 0; i < count; i++)
+		size += machines[i]->GetSnapshotSize();
+	return size;
+}
+
+//----------------------------------------------------------------------------
+// Save
+//----------------------------------------------------------------------------
+size_t StateSnapshot::Save(StateMachine* const* machines, size_t count, void* buffer, size_t size)
+{
+	if (buffer == NULL || size < GetSize(machines, count))
+		return 0;
+
+	BYTE* pBuffer = static_cast<BYTE*>(buffer);
+	FleetHeader header = { FLEET_MAGIC, FLEET_VERSION, count };
+	memcpy(pBuffer, &header, sizeof(header));
+
+	uint64_t* offsets = reinterpret_cast<uint64_t*>(pBuffer + sizeof(FleetHeader));
+	size_t offset = GetRecordsOffset(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		offsets[i] = offset;
+		offset += machines[i]->SaveSnapshot(pBuffer + offset, static_cast<UINT>(size - offset));
+	}
+	return offset;
+}
+
+//----------------------------------------------------------------------------
+// Restore
+//----------------------------------------------------------------------------
+size_t StateSnapshot::Restore(StateMachine* const* machines, size_t count, const void* buffer, size_t size)
+{
+	if (buffer == NULL || size < sizeof(FleetHeader))
+		return 0;
+
+	const BYTE* pBuffer = static_cast<const BYTE*>(buffer);
+	FleetHeader header;
+	memcpy(&header, pBuffer, sizeof(header));
+	if (header.magic != FLEET_MAGIC || header.version != FLEET_VERSION ||
+		header.count < count || size < GetRecordsOffset(static_cast<size_t>(header.count)))
+		return 0;
+
+	const uint64_t* offsets = reinterpret_cast<const uint64_t*>(pBuffer + sizeof(FleetHeader));
+	for (size_t i = 0; i < count; i++)
+	{
+		if (offsets[i] >= size ||
+			!machines[i]->RestoreSnapshot(pBuffer + offsets[i], static_cast<UINT>(size - offsets[i])))
+			return i;
+	}
+	return count;
+}
@@ -0,0 +1,40 @@
+#ifndef _STATE_SNAPSHOT_H
+#define _STATE_SNAPSHOT_H
+
+#include "StateMachine.h"
+
+/// @brief StateSnapshot saves and restores a fleet of state machines to and from a
+/// single contiguous buffer, such as a memory mapped file. The buffer holds a header,
+/// a table of record offsets, then each state machine snapshot (see
+/// StateMachine::SaveSnapshot()) 8 byte aligned in array order. Restoring reads the
+/// records in place; there is no parsing or intermediate copy. The format uses the
+/// native byte order.
+class StateSnapshot
+{
+public:
+	/// Get the buffer size required to save the state machines.
+	/// @param[in] machines - the state machines.
+	/// @param[in] count - the number of state machines.
+	/// @return The buffer size in bytes.
+	static size_t GetSize(StateMachine* const* machines, size_t count);
+
+	/// Save the state machines. Each state machine must be idle.
+	/// @param[in] machines - the state machines.
+	/// @param[in] count - the number of state machines.
+	/// @param[out] buffer - the destination, 8 byte aligned.
+	/// @param[in] size - the destination size in bytes.
+	/// @return The number of bytes written, or 0 if size is too small.
+	static size_t Save(StateMachine* const* machines, size_t count, void* buffer, size_t size);
+
+	/// Restore the state machines without executing any actions. Each state machine
+	/// must be idle and registered with the same variables used to save.
+	/// @param[in] machines - the state machines, in the order saved.
+	/// @param[in] count - the number of state machines.
+	/// @param[in] buffer - the saved buffer, 8 byte aligned.
+	/// @param[in] size - the saved buffer size in bytes.
+	/// @return The number of state machines restored. Restoring stops at the first
+	///		invalid record.
+	static size_t Restore(StateMachine* const* machines, size_t count, const void* buffer, size_t size);
+};
+
+#endif // _STATE_SNAPSHOT_H
@@ -0,0 +1,142 @@
+#include "StateStats.h"
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//----------------------------------------------------------------------------
+// StateStats
+//----------------------------------------------------------------------------
+StateStats::StateStats(STATE_INDEX maxStates) :
+	MAX_STATES(maxStates),
+	m_states(new StateCounters[maxStates]),
+	m_transitions(new std::atomic<uint64_t>[(size_t)maxStates * maxStates]),
+	m_enterTime(GetWallTime()),
+	m_eventTime(0),
+	m_eventCpuTime(0),
+	m_exitCpuTime(0),
+	m_exitCpuTotal(0)
+{
+	for (size_t i = 0; i < MAX_STATES; i++)
+	{
+		m_states[i].entryCount.store(0, std::memory_order_relaxed);
+		m_states[i].dwellTotal.store(0, std::memory_order_relaxed);
+		m_states[i].dwellMax.store(0, std::memory_order_relaxed);
+		m_states[i].cpuTime.store(0, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < (size_t)MAX_STATES * MAX_STATES; i++)
+		m_transitions[i].store(0, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// BeginEvent
+//----------------------------------------------------------------------------
+void StateStats::BeginEvent()
+{
+	m_eventTime = GetWallTime();
+	m_eventCpuTime = GetThreadCpuTime();
+	m_exitCpuTotal = 0;
+}
+
+//----------------------------------------------------------------------------
+// BeginExit
+//----------------------------------------------------------------------------
+void StateStats::BeginExit()
+{
+	m_exitCpuTime = GetThreadCpuTime();
+}
+
+//----------------------------------------------------------------------------
+// EndExit
+//----------------------------------------------------------------------------
+void StateStats::EndExit(STATE_INDEX state)
+{
+	uint64_t exitCpu = GetThreadCpuTime() - m_exitCpuTime;
+	Add(m_states[state].cpuTime, exitCpu);
+	m_exitCpuTotal += exitCpu;
+}
+
+//----------------------------------------------------------------------------
+// EndEvent
+//----------------------------------------------------------------------------
+void StateStats::EndEvent(STATE_INDEX fromState, STATE_INDEX toState, BOOL guardResult)
+{
+	// The guard, entry and state actions belong to the target state
+	uint64_t eventCpu = GetThreadCpuTime() - m_eventCpuTime;
+	Add(m_states[toState].cpuTime, eventCpu - m_exitCpuTotal);
+
+	if (guardResult != TRUE)
+		return;
+
+	Add(m_transitions[(size_t)fromState * MAX_STATES + toState], 1);
+
+	if (fromState != toState)
+	{
+		// Close the dwell time of the state exited at the start of the transition
+		uint64_t dwell = m_eventTime - m_enterTime;
+		m_enterTime = m_eventTime;
+
+		StateCounters& from = m_states[fromState];
+		Add(from.dwellTotal, dwell);
+		if (dwell > from.dwellMax.load(std::memory_order_relaxed))
+			from.dwellMax.store(dwell, std::memory_order_relaxed);
+
+		Add(m_states[toState].entryCount, 1);
+	}
+}
+
+//----------------------------------------------------------------------------
+// Snapshot
+//----------------------------------------------------------------------------
+void StateStats::Snapshot(StateMachineStats& stats) const
+{
+	stats.states.resize(MAX_STATES);
+	stats.transitions.resize((size_t)MAX_STATES * MAX_STATES);
+
+	for (size_t i = 0; i < MAX_STATES; i++)
+	{
+		stats.states[i].entryCount = m_states[i].entryCount.load(std::memory_order_relaxed);
+		stats.states[i].dwellTotal = m_states[i].dwellTotal.load(std::memory_order_relaxed);
+		stats.states[i].dwellMax = m_states[i].dwellMax.load(std::memory_order_relaxed);
+		stats.states[i].cpuTime = m_states[i].cpuTime.load(std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < (size_t)MAX_STATES * MAX_STATES; i++)
+		stats.transitions[i] = m_transitions[i].load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+// GetThreadCpuTime
+//----------------------------------------------------------------------------
+uint64_t StateStats::GetThreadCpuTime()
+{
+#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+
+	// FILETIME is in 100 nanosecond units
+	return (kernel.QuadPart + user.QuadPart) * 100;
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// GetWallTime
+//----------------------------------------------------------------------------
+uint64_t StateStats::GetWallTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
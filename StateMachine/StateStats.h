@@ -0,0 +1,108 @@
+#ifndef _STATE_STATS_H
+#define _STATE_STATS_H
+
+#include "StateIndex.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// @brief Per state statistics. Times are in nanoseconds.
+struct StateStatsRecord
+{
+	uint64_t entryCount;	// Transitions into the state from another state
+	uint64_t dwellTotal;	// Wall-clock time spent in the state over all completed visits
+	uint64_t dwellMax;		// Longest completed visit
+	uint64_t cpuTime;		// Thread CPU time spent in the state, guard, entry and exit actions
+};
+
+/// @brief A statistics snapshot returned by StateMachine::GetStats().
+struct StateMachineStats
+{
+	/// Per state statistics indexed by state.
+	std::vector<StateStatsRecord> states;
+
+	/// Executed transition counts indexed by from-state * states.size() + to-state.
+	/// Self-transitions are included.
+	std::vector<uint64_t> transitions;
+
+	/// Get the executed transition count between two states.
+	uint64_t GetTransitionCount(STATE_INDEX fromState, STATE_INDEX toState) const
+	{
+		return transitions[fromState * states.size() + toState];
+	}
+};
+
+/// @brief StateStats collects per state dwell time, action CPU time and transition
+/// counts for a single state machine instance. The Begin/End functions are called
+/// only by the state machine thread. Snapshot() may be called from any thread; each
+/// counter is read atomically but the snapshot as a whole is not a consistent cut.
+class StateStats
+{
+public:
+	/// Constructor.
+	/// @param[in] maxStates - the maximum number of state machine states. The
+	///	initial state dwell time starts now.
+	StateStats(STATE_INDEX maxStates);
+
+	/// Called before the guard condition executes.
+	void BeginEvent();
+
+	/// Called before the exit actions execute.
+	void BeginExit();
+
+	/// Called after the exit actions execute.
+	/// @param[in] state - the state exited.
+	void EndExit(STATE_INDEX state);
+
+	/// Called after the state action executes, or after a failed guard condition.
+	/// @param[in] fromState - the state when the event started.
+	/// @param[in] toState - the event target state.
+	/// @param[in] guardResult - the guard condition result.
+	void EndEvent(STATE_INDEX fromState, STATE_INDEX toState, BOOL guardResult);
+
+	/// Copy the statistics. Callable from any thread.
+	/// @param[out] stats - the destination.
+	void Snapshot(StateMachineStats& stats) const;
+
+	/// Get the calling thread CPU time in nanoseconds.
+	static uint64_t GetThreadCpuTime();
+
+	/// Get the steady clock time in nanoseconds.
+	static uint64_t GetWallTime();
+
+private:
+	struct StateCounters
+	{
+		std::atomic<uint64_t> entryCount;
+		std::atomic<uint64_t> dwellTotal;
+		std::atomic<uint64_t> dwellMax;
+		std::atomic<uint64_t> cpuTime;
+	};
+
+	/// Increment a counter. Single writer, so no read-modify-write is required.
+	static void Add(std::atomic<uint64_t>& counter, uint64_t value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	const STATE_INDEX MAX_STATES;
+
+	std::unique_ptr<StateCounters[]> m_states;
+	std::unique_ptr<std::atomic<uint64_t>[]> m_transitions;
+
+	/// Wall-clock time the current state was entered.
+	uint64_t m_enterTime;
+
+	/// Wall-clock time at BeginEvent().
+	uint64_t m_eventTime;
+
+	/// Thread CPU time at BeginEvent() and BeginExit().
+	uint64_t m_eventCpuTime;
+	uint64_t m_exitCpuTime;
+
+	/// CPU time spent in exit actions during the current event.
+	uint64_t m_exitCpuTotal;
+};
+
+#endif // _STATE_STATS_H
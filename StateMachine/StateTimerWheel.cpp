@@ -0,0 +1,212 @@
+#include "StateTimerWheel.h"
+#include "Fault.h"
+
+//----------------------------------------------------------------------------
+// GetInstance
+//----------------------------------------------------------------------------
+StateTimerWheel& StateTimerWheel::GetInstance()
+{
+	// Never deleted; state machines with static storage may stop timers at exit
+	static StateTimerWheel* instance = new StateTimerWheel();
+	return *instance;
+}
+
+//----------------------------------------------------------------------------
+// StateTimerWheel
+//----------------------------------------------------------------------------
+StateTimerWheel::StateTimerWheel() :
+	m_now(0),
+	m_count(0),
+	m_expired(NULL),
+	m_expiredTail(&m_expired),
+	m_firing(NULL),
+	m_epoch(std::chrono::steady_clock::now())
+{
+	for (int level = 0; level < LEVELS; level++)
+		for (int slot = 0; slot < SLOTS; slot++)
+			m_slots[level][slot] = NULL;
+}
+
+//----------------------------------------------------------------------------
+// Start
+//----------------------------------------------------------------------------
+void StateTimerWheel::Start(StateTimer& timer, UINT timeout)
+{
+	uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - m_epoch).count();
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	StartLocked(timer, timeout, now);
+}
+
+//----------------------------------------------------------------------------
+// Retry
+//----------------------------------------------------------------------------
+void StateTimerWheel::Retry(StateTimer& timer, UINT generation, UINT timeout)
+{
+	uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - m_epoch).count();
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	if (timer.Generation == generation && timer.Link == NULL)
+		StartLocked(timer, timeout, now);
+}
+
+//----------------------------------------------------------------------------
+// StartLocked
+//----------------------------------------------------------------------------
+void StateTimerWheel::StartLocked(StateTimer& timer, UINT timeout, uint64_t now)
+{
+	if (timer.Link != NULL)
+		Remove(timer);
+	timer.Generation++;
+
+	// Expire no earlier than the next tick
+	if (now < m_now)
+		now = m_now;
+	timer.Expiry = now + (timeout > 0 ? timeout : 1);
+	Insert(timer);
+}
+
+//----------------------------------------------------------------------------
+// Stop
+//----------------------------------------------------------------------------
+void StateTimerWheel::Stop(StateTimer& timer)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	if (timer.Link != NULL)
+		Remove(timer);
+	timer.Generation++;
+
+	// The owner may be destroyed once returned; wait out a callback in progress
+	while (m_firing == &timer && m_firingThread != std::this_thread::get_id())
+		m_fired.wait(lock);
+}
+
+//----------------------------------------------------------------------------
+// ProcessTimers
+//----------------------------------------------------------------------------
+void StateTimerWheel::ProcessTimers()
+{
+	StateTimerWheel& wheel = GetInstance();
+	uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - wheel.m_epoch).count();
+
+	std::unique_lock<std::mutex> lock(wheel.m_lock);
+	if (now > wheel.m_now)
+		wheel.Advance(now - wheel.m_now);
+
+	// Call back each expired timer with the wheel unlocked. A timer stopped or 
+	// restarted meanwhile has left the expired list and is skipped.
+	wheel.m_firingThread = std::this_thread::get_id();
+	while (wheel.m_expired != NULL)
+	{
+		StateTimer* timer = wheel.m_expired;
+		wheel.Remove(*timer);
+		UINT generation = timer->Generation;
+		wheel.m_firing = timer;
+
+		lock.unlock();
+		timer->Expired(timer->Context, generation);
+		lock.lock();
+
+		wheel.m_firing = NULL;
+		wheel.m_fired.notify_all();
+	}
+}
+
+//----------------------------------------------------------------------------
+// Advance
+//----------------------------------------------------------------------------
+void StateTimerWheel::Advance(uint64_t ticks)
+{
+	for (; ticks > 0; ticks--)
+	{
+		// Nothing running; skip ahead
+		if (m_count == 0)
+		{
+			m_now += ticks;
+			break;
+		}
+
+		m_now++;
+
+		// Each time a level wraps, move the next level's current slot down
+		for (int level = 1; level < LEVELS; level++)
+		{
+			if ((m_now & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0)
+				break;
+			Cascade(level, static_cast<UINT>(m_now >> (SLOT_BITS * level)) & SLOT_MASK);
+		}
+
+		// Every timer in the current level 0 slot expires on this tick. Append it
+		// to the expired list; ProcessTimers() calls back once unlocked.
+		StateTimer*& head = m_slots[0][m_now & SLOT_MASK];
+		while (head != NULL)
+		{
+			StateTimer* timer = head;
+			ASSERT_TRUE(timer->Expiry <= m_now);
+			Remove(*timer);
+			timer->Link = m_expiredTail;
+			*m_expiredTail = timer;
+			m_expiredTail = &timer->Next;
+			timer->Expiring = TRUE;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// Insert
+//----------------------------------------------------------------------------
+void StateTimerWheel::Insert(StateTimer& timer)
+{
+	// The level is the first whose span covers the remaining ticks
+	uint64_t delta = timer.Expiry > m_now ? timer.Expiry - m_now : 0;
+	int level = 0;
+	while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+		level++;
+
+	StateTimer*& head = m_slots[level][(timer.Expiry >> (SLOT_BITS * level)) & SLOT_MASK];
+	timer.Next = head;
+	if (head != NULL)
+		head->Link = &timer.Next;
+	timer.Link = &head;
+	head = &timer;
+	m_count++;
+}
+
+//----------------------------------------------------------------------------
+// Remove
+//----------------------------------------------------------------------------
+void StateTimerWheel::Remove(StateTimer& timer)
+{
+	*timer.Link = timer.Next;
+	if (timer.Next != NULL)
+		timer.Next->Link = timer.Link;
+	if (timer.Expiring)
+	{
+		if (m_expiredTail == &timer.Next)
+			m_expiredTail = timer.Link;
+		timer.Expiring = FALSE;
+	}
+	else
+		m_count--;
+	timer.Link = NULL;
+	timer.Next = NULL;
+}
+
+//----------------------------------------------------------------------------
+// Cascade
+//----------------------------------------------------------------------------
+void StateTimerWheel::Cascade(int level, UINT slot)
+{
+	StateTimer* timer = m_slots[level][slot];
+	m_slots[level][slot] = NULL;
+	while (timer != NULL)
+	{
+		StateTimer* next = timer->Next;
+		m_count--;
+		Insert(*timer);
+		timer = next;
+	}
+}
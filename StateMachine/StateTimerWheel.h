@@ -0,0 +1,126 @@
+#ifndef _STATE_TIMER_WHEEL_H
+#define _STATE_TIMER_WHEEL_H
+
+#include "DataTypes.h"
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+/// @brief A timer owned by one state machine and scheduled on the StateTimerWheel.
+/// The timer is an intrusive list node so starting and stopping never allocate.
+struct StateTimer
+{
+	/// Called on the ProcessTimers() thread, without the wheel locked, when the timer
+	/// expires. The timer may be restarted meanwhile; generation is the Generation
+	/// value the timer expired with.
+	typedef void (*Callback)(void* context, UINT generation);
+
+	StateTimer(Callback callback, void* context) :
+		Expired(callback), Context(context), Link(NULL), Next(NULL), Expiry(0), Generation(0), 
+		Expiring(FALSE) {}
+
+	const Callback Expired;
+	void* const Context;
+
+	/// Running or expiring timers only. The pointer that points to this timer, either
+	/// a list head or the previous timer's Next, else NULL if the timer is stopped.
+	StateTimer** Link;
+	StateTimer* Next;
+	uint64_t Expiry;		// Expiration tick
+
+	/// Incremented by each Start and Stop, with the wheel locked. A callback compares
+	/// it later to detect a timer restarted or stopped after expiring.
+	UINT Generation;
+
+	/// TRUE while linked in the expired list, waiting for its callback.
+	BOOL Expiring;
+};
+
+/// @brief StateTimerWheel is a hierarchical timing wheel shared by all state machine
+/// state timeouts. Start and Stop are O(1), and each 1 ms tick is O(1) plus the
+/// timers expiring on that tick, regardless of the number of running timers. A
+/// stopped timer is unlinked immediately and never calls back.
+///
+/// Call ProcessTimers() periodically, at least every few milliseconds, from a single
+/// thread. Expired timers call back on that thread without the wheel locked, so a
+/// callback blocked on a full queue does not stall Start() and Stop() callers.
+class StateTimerWheel
+{
+public:
+	/// Get the shared timing wheel instance.
+	static StateTimerWheel& GetInstance();
+
+	/// Start or restart a timer. Callable from any thread.
+	/// @param[in] timer - the timer to start.
+	/// @param[in] timeout - the timeout in milliseconds.
+	void Start(StateTimer& timer, UINT timeout);
+
+	/// Stop a timer. Once returned, the timer does not call back. If its callback is
+	/// running on the ProcessTimers() thread, waits for the callback to return, 
+	/// unless called from that thread. Callable from any thread.
+	/// @param[in] timer - the timer to stop.
+	void Stop(StateTimer& timer);
+
+	/// Restart a timer from its callback, unless the timer was stopped or restarted
+	/// since it expired. Called on the ProcessTimers() thread.
+	/// @param[in] timer - the expired timer.
+	/// @param[in] generation - the generation passed to the callback.
+	/// @param[in] timeout - the timeout in milliseconds.
+	void Retry(StateTimer& timer, UINT generation, UINT timeout);
+
+	/// Advance the shared wheel to the current time and call back expired timers.
+	static void ProcessTimers();
+
+private:
+	StateTimerWheel();
+	StateTimerWheel(const StateTimerWheel&) = delete;
+	StateTimerWheel& operator=(const StateTimerWheel&) = delete;
+
+	enum { LEVELS = 4, SLOT_BITS = 8, SLOTS = 1 << SLOT_BITS, SLOT_MASK = SLOTS - 1 };
+
+	/// Advance the wheel a number of ticks.
+	/// @param[in] ticks - the number of 1 ms ticks elapsed.
+	void Advance(uint64_t ticks);
+
+	/// Start a timer. Called with the wheel locked.
+	void StartLocked(StateTimer& timer, UINT timeout, uint64_t now);
+
+	/// Link a timer into the slot matching its expiration tick.
+	void Insert(StateTimer& timer);
+
+	/// Unlink a timer from its slot or from the expired list.
+	void Remove(StateTimer& timer);
+
+	/// Move the timers of a higher level slot down the wheel.
+	void Cascade(int level, UINT slot);
+
+	std::mutex m_lock;
+
+	/// Slot list heads, one list per slot per level.
+	StateTimer* m_slots[LEVELS][SLOTS];
+
+	/// The current tick.
+	uint64_t m_now;
+
+	/// The number of running timers, excluding the expired list.
+	UINT m_count;
+
+	/// Timers removed from the wheel by Advance(), in expiration order, waiting for
+	/// ProcessTimers() to call back. m_expiredTail points to the last Next pointer.
+	StateTimer* m_expired;
+	StateTimer** m_expiredTail;
+
+	/// The timer whose callback is running, or NULL. Signals m_fired on return.
+	StateTimer* m_firing;
+	std::condition_variable m_fired;
+
+	/// The ProcessTimers() thread.
+	std::thread::id m_firingThread;
+
+	/// The time of tick 0.
+	std::chrono::steady_clock::time_point m_epoch;
+};
+
+#endif // _STATE_TIMER_WHEEL_H
@@ -0,0 +1,102 @@
+#include "StateTrace.h"
+#include <chrono>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------
+// StateTrace
+//----------------------------------------------------------------------------
+StateTrace::StateTrace() :
+	m_count(0)
+{
+	for (UINT i = 0; i < DEPTH; i++)
+	{
+		m_slots[i].sequence.store(0, std::memory_order_relaxed);
+		m_slots[i].timestamp.store(0, std::memory_order_relaxed);
+		m_slots[i].transition.store(0, std::memory_order_relaxed);
+		m_slots[i].guardResult.store(0, std::memory_order_relaxed);
+		m_slots[i].dataType.store(NULL, std::memory_order_relaxed);
+	}
+}
+
+//----------------------------------------------------------------------------
+// Record
+//----------------------------------------------------------------------------
+void StateTrace::Record(STATE_INDEX fromState, STATE_INDEX toState, BOOL guardResult, const std::type_info* dataType)
+{
+	uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	// Single writer, so a relaxed load of the count is sufficient
+	uint32_t count = m_count.load(std::memory_order_relaxed);
+	Slot& slot = m_slots[count % DEPTH];
+
+	// Mark the slot as being written before touching the fields
+	slot.sequence.store(count * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.timestamp.store(timestamp, std::memory_order_relaxed);
+	slot.transition.store((uint64_t)fromState | ((uint64_t)toState << 32), std::memory_order_relaxed);
+	slot.guardResult.store(guardResult ? 1u : 0u, std::memory_order_relaxed);
+	slot.dataType.store(dataType, std::memory_order_relaxed);
+
+	// Publish the slot and the new count
+	slot.sequence.store(count * 2 + 2, std::memory_order_release);
+	m_count.store(count + 1, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+// Snapshot
+//----------------------------------------------------------------------------
+UINT StateTrace::Snapshot(StateTraceRecord* records, UINT maxRecords) const
+{
+	uint32_t count = m_count.load(std::memory_order_acquire);
+	uint32_t available = count < (UINT)DEPTH ? count : (UINT)DEPTH;
+	if (available > maxRecords)
+		available = maxRecords;
+
+	UINT copied = 0;
+	for (uint32_t index = count - available; index != count; index++)
+	{
+		const Slot& slot = m_slots[index % DEPTH];
+
+		// Skip the slot if it was overwritten or is being written
+		uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != index * 2 + 2)
+			continue;
+
+		StateTraceRecord record;
+		record.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+		uint64_t transition = slot.transition.load(std::memory_order_relaxed);
+		uint32_t guardResult = slot.guardResult.load(std::memory_order_relaxed);
+		record.dataType = slot.dataType.load(std::memory_order_relaxed);
+
+		// Discard the copy if the writer touched the slot meanwhile
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+			continue;
+
+		record.fromState = static_cast<STATE_INDEX>(transition & 0xFFFFFFFF);
+		record.toState = static_cast<STATE_INDEX>(transition >> 32);
+		record.guardResult = guardResult ? TRUE : FALSE;
+		records[copied++] = record;
+	}
+	return copied;
+}
+
+//----------------------------------------------------------------------------
+// Print
+//----------------------------------------------------------------------------
+void StateTrace::Print() const
+{
+	StateTraceRecord records[DEPTH];
+	UINT count = Snapshot(records, DEPTH);
+	for (UINT i = 0; i < count; i++)
+	{
+		printf("[StateTrace] %llu ns: %u -> %u guard=%d data=%s\n",
+			(unsigned long long)records[i].timestamp,
+			(unsigned)records[i].fromState,
+			(unsigned)records[i].toState,
+			records[i].guardResult,
+			records[i].dataType ? records[i].dataType->name() : "");
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef _STATE_TRACE_H
+#define _STATE_TRACE_H
+
+#include "StateIndex.h"
+#include <atomic>
+#include <cstdint>
+#include <typeinfo>
+
+// The number of transition records kept per state machine instance.
+#ifndef STATE_TRACE_DEPTH
+#define STATE_TRACE_DEPTH 32
+#endif
+
+/// @brief A single state machine transition record.
+struct StateTraceRecord
+{
+	uint64_t timestamp;					// Steady clock time in nanoseconds
+	STATE_INDEX fromState;				// The current state when the event executed
+	STATE_INDEX toState;				// The new state, or CANNOT_HAPPEN
+	BOOL guardResult;					// The guard condition result. TRUE if no guard.
+	const std::type_info* dataType;		// The event data type
+};
+
+/// @brief StateTrace is a fixed-size flight recorder of the most recent state machine
+/// transitions. Record() is called only by the state machine thread and never blocks.
+/// Snapshot() is lock-free and may be called from any thread while the state machine
+/// executes; records overwritten during the copy are skipped.
+class StateTrace
+{
+public:
+	enum { DEPTH = STATE_TRACE_DEPTH };
+
+	StateTrace();
+
+	/// Record a transition. Called by the state machine thread only.
+	/// @param[in] fromState - the current state.
+	/// @param[in] toState - the new state.
+	/// @param[in] guardResult - the guard condition result.
+	/// @param[in] dataType - the event data type.
+	void Record(STATE_INDEX fromState, STATE_INDEX toState, BOOL guardResult, const std::type_info* dataType);
+
+	/// Copy the most recent records, oldest first. Callable from any thread.
+	/// @param[out] records - the destination array.
+	/// @param[in] maxRecords - the destination array size.
+	/// @return The number of records copied.
+	UINT Snapshot(StateTraceRecord* records, UINT maxRecords) const;
+
+	/// Print the most recent records to stdout.
+	void Print() const;
+
+private:
+	/// A record slot protected by a sequence lock. The sequence is odd while the
+	/// slot is being written.
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence;
+		std::atomic<uint64_t> timestamp;
+		std::atomic<uint64_t> transition;	// fromState and toState packed
+		std::atomic<uint32_t> guardResult;
+		std::atomic<const std::type_info*> dataType;
+	};
+
+	Slot m_slots[DEPTH];
+
+	/// The total number of records written.
+	std::atomic<uint32_t> m_count;
+};
+
+#endif // _STATE_TRACE_H
@@ -0,0 +1,523 @@
+#ifndef _STATIC_STATE_MACHINE_H
+#define _STATIC_STATE_MACHINE_H
+
+#include "StateMachine.h"
+#include <type_traits>
+
+// StaticStateMachine is a compile-time alternative to the StateMachine engine.
+// The derived class is passed as a template argument (CRTP) so the state map is
+// located without virtual calls, each state map row holds direct function pointers
+// resolved at compile time, and event data type checking uses a compile-time type
+// tag instead of dynamic_cast. RTTI is only used when the event data is a further 
+// derived class of the state's event data type. Event data not derived from 
+// EventData fails to compile. The STATE_DECLARE, GUARD_DECLARE, ENTRY_DECLARE, 
+// EXIT_DECLARE, BEGIN_STATE_MAP/BEGIN_STATE_MAP_EX and BEGIN_TRANSITION_MAP macros 
+// are shared by both engines. To convert, change the base class and remove any use 
+// of the StateMachine event queue:
+//
+//    class Motor : public StaticStateMachine<Motor>
+//
+// StaticStateMachine executes synchronously and has no event queue, so state
+// timeouts (STATE_MAP_ENTRY_TIMEOUT_EX) fail to compile.
+
+/// @brief A compile-time type tag for event data. The address of Id is unique
+/// for each Data type.
+template <class Data>
+struct EventDataTag
+{
+	static constexpr char Id = 0;
+};
+
+/// Downcast event data to the state function event data type.
+/// @param[in] data - the event data.
+/// @param[in] tag - the event data type tag captured when the event was generated.
+/// @return The event data as Data type.
+template <class Data>
+inline const Data* EventDataCast(const EventData* data, const void* tag)
+{
+	static_assert(std::is_base_of<EventData, Data>::value,
+		"STATE_DECLARE, GUARD_DECLARE and ENTRY_DECLARE event data must derive from EventData");
+
+	if constexpr (std::is_same<Data, EventData>::value)
+	{
+		// NoEventData states accept any event data
+		return data;
+	}
+	else if constexpr (std::is_final<Data>::value)
+	{
+		// A final Data type has no further derived classes. Only an exact type 
+		// tag match is valid, so no RTTI is needed.
+		const Data* derivedData = (tag == &EventDataTag<Data>::Id) ?
+			static_cast<const Data*>(data) : NULL;
+		ASSERT_TRUE(derivedData != NULL);
+		return derivedData;
+	}
+	else
+	{
+		// Fast path is an exact type tag match. Otherwise, the event data is
+		// a further derived class of Data (or a mismatch) so fall back to RTTI.
+		const Data* derivedData = (tag == &EventDataTag<Data>::Id) ?
+			static_cast<const Data*>(data) : dynamic_cast<const Data*>(data);
+
+		// If this check fails, there is a mismatch between the STATE_DECLARE
+		// event data type and the data type being sent to the state function.
+		ASSERT_TRUE(derivedData != NULL);
+		return derivedData;
+	}
+}
+
+/// @brief A structure to hold a single row within the StaticStateMachine state map.
+/// Each function pointer invokes the state machine member function directly.
+template <class SM>
+struct StaticStateMapRowEx
+{
+	typedef void (*StateFunc)(SM* sm, const EventData* data, const void* tag);
+	typedef BOOL (*GuardFunc)(SM* sm, const EventData* data, const void* tag);
+	typedef void (*EntryFunc)(SM* sm, const EventData* data, const void* tag);
+	typedef void (*ExitFunc)(SM* sm);
+
+	const StateFunc State;
+	const GuardFunc Guard;
+	const EntryFunc Entry;
+	const ExitFunc Exit;
+	const STATE_INDEX Parent;
+
+	/// Create a state map row from the state, guard, entry and exit object types.
+	/// @param[in] parent - the parent (composite) state or StateHierarchy::NO_PARENT.
+	template <class S, class G = int, class E = int, class X = int>
+	static constexpr StaticStateMapRowEx Make(STATE_INDEX parent = StateHierarchy::NO_PARENT)
+	{
+		return { StateOf<S>(), GuardOf<G>(), EntryOf<E>(), ExitOf<X>(), parent };
+	}
+
+	/// State timeouts are delivered through the StateMachine event queue, which 
+	/// StaticStateMachine does not have. Rejects STATE_MAP_ENTRY_TIMEOUT_EX at compile
+	/// time instead of silently dropping the timeout.
+	template <class S, class G = int, class E = int, class X = int>
+	static constexpr StaticStateMapRowEx MakeTimeout(UINT, STATE_INDEX, 
+		STATE_INDEX = StateHierarchy::NO_PARENT)
+	{
+		static_assert(sizeof(S) == 0, 
+			"StaticStateMachine does not support state timeouts (STATE_MAP_ENTRY_TIMEOUT_EX). Use StateMachine or AsyncStateMachine.");
+		return Make<S, G, E, X>();
+	}
+
+private:
+	template <class A>
+	static void InvokeState(SM* sm, const EventData* data, const void* tag)
+	{
+		A::Dispatch(sm, EventDataCast<typename A::DataType>(data, tag));
+	}
+
+	template <class A>
+	static BOOL InvokeGuard(SM* sm, const EventData* data, const void* tag)
+	{
+		return A::Dispatch(sm, EventDataCast<typename A::DataType>(data, tag));
+	}
+
+	template <class A>
+	static void InvokeEntry(SM* sm, const EventData* data, const void* tag)
+	{
+		A::Dispatch(sm, EventDataCast<typename A::DataType>(data, tag));
+	}
+
+	template <class A>
+	static void InvokeExit(SM* sm)
+	{
+		A::Dispatch(sm);
+	}
+
+	// A pointer entry type is an action object. Any other type (e.g. 0) is no action.
+	template <class T>
+	static constexpr StateFunc StateOf()
+	{
+		if constexpr (std::is_pointer<T>::value)
+			return &InvokeState<typename std::remove_pointer<T>::type>;
+		else
+			return nullptr;
+	}
+
+	template <class T>
+	static constexpr GuardFunc GuardOf()
+	{
+		if constexpr (std::is_pointer<T>::value)
+			return &InvokeGuard<typename std::remove_pointer<T>::type>;
+		else
+			return nullptr;
+	}
+
+	template <class T>
+	static constexpr EntryFunc EntryOf()
+	{
+		if constexpr (std::is_pointer<T>::value)
+			return &InvokeEntry<typename std::remove_pointer<T>::type>;
+		else
+			return nullptr;
+	}
+
+	template <class T>
+	static constexpr ExitFunc ExitOf()
+	{
+		if constexpr (std::is_pointer<T>::value)
+			return &InvokeExit<typename std::remove_pointer<T>::type>;
+		else
+			return nullptr;
+	}
+};
+
+/// @brief StaticStateMachine implements a software-based state machine with
+/// compile-time state dispatch. SM is the derived state machine class.
+template <class SM>
+class StaticStateMachine
+{
+public:
+	enum : STATE_INDEX { EVENT_IGNORED = STATE_INDEX_MAX - 1, CANNOT_HAPPEN };
+
+	///	Constructor.
+	///	@param[in] maxStates - the maximum number of state machine states.
+	StaticStateMachine(STATE_INDEX maxStates, STATE_INDEX initialState = 0) :
+		MAX_STATES(maxStates),
+		m_currentState(initialState),
+		m_newState(FALSE),
+		m_eventGenerated(FALSE),
+		m_pEventData(NULL),
+		m_pEventDataTag(NULL),
+		m_hierarchy(NULL),
+		m_hierarchyResolved(FALSE)
+#if STATE_MACHINE_STATS
+		, m_stats(maxStates)
+#endif
+	{
+		ASSERT_TRUE(MAX_STATES < EVENT_IGNORED);
+	}
+
+	/// Gets the current state machine state.
+	/// @return Current state machine state.
+	STATE_INDEX GetCurrentState() { return m_currentState; }
+
+	/// Gets the maximum number of state machine states.
+	/// @return The maximum state machine states.
+	STATE_INDEX GetMaxStates() { return MAX_STATES; }
+
+	/// Copy the most recent state transitions, oldest first. Callable from any thread.
+	/// @param[out] records - the destination array.
+	/// @param[in] maxRecords - the destination array size.
+	/// @return The number of records copied. Always 0 if STATE_MACHINE_TRACE is 0.
+	UINT GetTrace(StateTraceRecord* records, UINT maxRecords) const
+	{
+#if STATE_MACHINE_TRACE
+		return m_trace.Snapshot(records, maxRecords);
+#else
+		return 0;
+#endif
+	}
+
+	/// Generate an external event by event ID. The state machine must define an 
+	/// event map using BEGIN_EVENT_MAP, EVENT_MAP_ROW and END_EVENT_MAP.
+	/// @param[in] event - the event ID. An index into the event map.
+	/// @param[in] pData - the event data sent to the state.
+	void Dispatch(EVENT_INDEX event, const EventData* pData = NULL)
+	{
+		ExternalEvent(SM::GetEventTransitionT(event, m_currentState), pData);
+	}
+
+	/// Copy the per state and transition statistics. Callable from any thread.
+	/// @param[out] stats - the destination.
+	/// @return TRUE if copied. FALSE if STATE_MACHINE_STATS is disabled.
+	BOOL GetStats(StateMachineStats& stats) const
+	{
+#if STATE_MACHINE_STATS
+		m_stats.Snapshot(stats);
+		return TRUE;
+#else
+		(void)stats;
+		return FALSE;
+#endif
+	}
+
+protected:
+	/// External state machine event.
+	/// @param[in] newState - the state machine state to transition to.
+	/// @param[in] pData - the event data sent to the state.
+	void ExternalEvent(STATE_INDEX newState, const EventData* pData = NULL)
+	{
+		ExternalEvent(newState, pData, &EventDataTag<EventData>::Id);
+	}
+
+	/// External state machine event. The Data type tag is captured at compile time.
+	/// @param[in] newState - the state machine state to transition to.
+	/// @param[in] pData - the event data sent to the state.
+	template <class Data>
+	void ExternalEvent(STATE_INDEX newState, const Data* pData)
+	{
+		static_assert(std::is_base_of<EventData, Data>::value, "Event data must derive from EventData");
+		ExternalEvent(newState, pData, &EventDataTag<Data>::Id);
+	}
+
+	/// Internal state machine event. These events are generated while executing
+	///	within a state machine state.
+	/// @param[in] newState - the state machine state to transition to.
+	/// @param[in] pData - the event data sent to the state.
+	void InternalEvent(STATE_INDEX newState, const EventData* pData = NULL)
+	{
+		InternalEvent(newState, pData, &EventDataTag<EventData>::Id);
+	}
+
+	/// Internal state machine event. The Data type tag is captured at compile time.
+	/// @param[in] newState - the state machine state to transition to.
+	/// @param[in] pData - the event data sent to the state.
+	template <class Data>
+	void InternalEvent(STATE_INDEX newState, const Data* pData)
+	{
+		static_assert(std::is_base_of<EventData, Data>::value, "Event data must derive from EventData");
+		InternalEvent(newState, pData, &EventDataTag<Data>::Id);
+	}
+
+private:
+	typedef StaticStateMapRowEx<SM> Row;
+
+	/// The maximum number of state machine states.
+	const STATE_INDEX MAX_STATES;
+
+	/// The current state machine state.
+	STATE_INDEX m_currentState;
+
+	/// The new state the state machine has yet to transition to.
+	STATE_INDEX m_newState;
+
+	/// Set to TRUE when an event is generated.
+	BOOL m_eventGenerated;
+
+	/// The state event data pointer.
+	const EventData* m_pEventData;
+
+	/// The state event data type tag.
+	const void* m_pEventDataTag;
+
+	/// The precomputed exit/entry paths, or NULL if the state map is not hierarchical.
+	const StateHierarchy* m_hierarchy;
+
+	/// Set to TRUE once m_hierarchy is resolved from the state map.
+	BOOL m_hierarchyResolved;
+
+#if STATE_MACHINE_TRACE
+	/// The recent transition history.
+	StateTrace m_trace;
+#endif
+
+#if STATE_MACHINE_STATS
+	/// The per state and transition statistics.
+	StateStats m_stats;
+#endif
+
+	/// Record a transition into the trace, if enabled.
+	void TraceTransition(BOOL guardResult, const EventData* pData)
+	{
+#if STATE_MACHINE_TRACE
+		m_trace.Record(m_currentState, m_newState, guardResult, pData ? &typeid(*pData) : NULL);
+#endif
+	}
+
+	void ExternalEvent(STATE_INDEX newState, const EventData* pData, const void* tag);
+	void InternalEvent(STATE_INDEX newState, const EventData* pData, const void* tag);
+
+	/// State machine engine that executes the external event and, optionally, all
+	/// internal events generated during state execution.
+	void StateEngine();
+};
+
+//----------------------------------------------------------------------------
+// ExternalEvent
+//----------------------------------------------------------------------------
+template <class SM>
+void StaticStateMachine<SM>::ExternalEvent(STATE_INDEX newState, const EventData* pData, const void* tag)
+{
+	// If we are supposed to ignore this event
+	if (newState == EVENT_IGNORED)
+	{
+#ifndef EXTERNAL_EVENT_NO_HEAP_DATA
+		// Just delete the event data, if any
+		if (pData != NULL && pData != &NO_EVENT_DATA)
+			delete pData;
+#endif
+	}
+	else
+	{
+#ifdef EXTERNAL_EVENT_NO_HEAP_DATA
+		if (pData == NULL)
+			pData = &NO_EVENT_DATA;
+#endif
+		// Generate the event
+		InternalEvent(newState, pData, tag);
+
+		// Execute the state engine. This function call will only return
+		// when all state machine events are processed.
+		StateEngine();
+	}
+}
+
+//----------------------------------------------------------------------------
+// InternalEvent
+//----------------------------------------------------------------------------
+template <class SM>
+void StaticStateMachine<SM>::InternalEvent(STATE_INDEX newState, const EventData* pData, const void* tag)
+{
+	if (pData == NULL)
+		pData = &NO_EVENT_DATA;
+
+	m_pEventData = pData;
+	m_pEventDataTag = tag;
+	m_eventGenerated = TRUE;
+	m_newState = newState;
+}
+
+//----------------------------------------------------------------------------
+// StateEngine
+//----------------------------------------------------------------------------
+template <class SM>
+void StaticStateMachine<SM>::StateEngine()
+{
+	// Resolved at compile time; no virtual call to locate the state map
+	const Row* const pStateMap = SM::template GetStateMapT<Row>();
+	SM* derivedSM = static_cast<SM*>(this);
+
+#if EXTERNAL_EVENT_NO_HEAP_DATA
+	BOOL externalEvent = TRUE;
+#endif
+	const EventData* pDataTemp = NULL;
+	const void* pDataTagTemp = NULL;
+
+	// Resolve the shared hierarchical exit/entry paths on first use
+	if (!m_hierarchyResolved)
+	{
+		m_hierarchy = StateHierarchy::Get(pStateMap, MAX_STATES);
+		m_hierarchyResolved = TRUE;
+	}
+
+	// While events are being generated keep executing states
+	while (m_eventGenerated)
+	{
+		// Error check that the new state is valid before proceeding
+		if (m_newState >= MAX_STATES)
+		{
+			TraceTransition(FALSE, m_pEventData);
+#if STATE_MACHINE_TRACE
+			m_trace.Print();
+#endif
+			ASSERT();
+		}
+
+		// Get the function pointers from the state map
+		const Row& newRow = pStateMap[m_newState];
+		typename Row::ExitFunc exit = pStateMap[m_currentState].Exit;
+
+		// Copy of event data pointer and type tag
+		pDataTemp = m_pEventData;
+		pDataTagTemp = m_pEventDataTag;
+
+		// Event data used up, reset the pointer
+		m_pEventData = NULL;
+		m_pEventDataTag = NULL;
+
+		// Event used up, reset the flag
+		m_eventGenerated = FALSE;
+
+#if STATE_MACHINE_STATS
+		STATE_INDEX fromState = m_currentState;
+		STATE_INDEX toState = m_newState;
+		m_stats.BeginEvent();
+#endif
+
+		// Execute the guard condition
+		BOOL guardResult = TRUE;
+		if (newRow.Guard != NULL)
+			guardResult = newRow.Guard(derivedSM, pDataTemp, pDataTagTemp);
+		TraceTransition(guardResult, pDataTemp);
+
+		// If the guard condition succeeds
+		if (guardResult == TRUE)
+		{
+			// Transitioning to a new state?
+			if (m_newState != m_currentState)
+			{
+				if (m_hierarchy != NULL)
+				{
+					// Walk the precomputed path out of and into each composite state
+					StateHierarchy::Path path = m_hierarchy->GetPath(m_currentState, m_newState);
+					for (STATE_INDEX i = 0; i < path.ExitCount; i++)
+					{
+						typename Row::ExitFunc pathExit = pStateMap[path.Exit[i]].Exit;
+						if (pathExit != NULL)
+						{
+#if STATE_MACHINE_STATS
+							m_stats.BeginExit();
+							pathExit(derivedSM);
+							m_stats.EndExit(path.Exit[i]);
+#else
+							pathExit(derivedSM);
+#endif
+						}
+					}
+					for (STATE_INDEX i = 0; i < path.EntryCount; i++)
+					{
+						typename Row::EntryFunc pathEntry = pStateMap[path.Entry[i]].Entry;
+						if (pathEntry != NULL)
+							pathEntry(derivedSM, pDataTemp, pDataTagTemp);
+					}
+				}
+				else
+				{
+					// Execute the state exit action on current state before switching to new state
+					if (exit != NULL)
+					{
+#if STATE_MACHINE_STATS
+						m_stats.BeginExit();
+						exit(derivedSM);
+						m_stats.EndExit(m_currentState);
+#else
+						exit(derivedSM);
+#endif
+					}
+
+					// Execute the state entry action on the new state
+					if (newRow.Entry != NULL)
+						newRow.Entry(derivedSM, pDataTemp, pDataTagTemp);
+				}
+
+				// Ensure exit/entry actions didn't call InternalEvent by accident
+				ASSERT_TRUE(m_eventGenerated == FALSE);
+			}
+
+			// Switch to the new current state
+			m_currentState = m_newState;
+
+			// Execute the state action passing in event data
+			ASSERT_TRUE(newRow.State != NULL);
+			newRow.State(derivedSM, pDataTemp, pDataTagTemp);
+		}
+
+#if STATE_MACHINE_STATS
+		m_stats.EndEvent(fromState, toState, guardResult);
+#endif
+
+		// If event data was used, then delete it
+#if EXTERNAL_EVENT_NO_HEAP_DATA
+		if (pDataTemp)
+		{
+			if (!externalEvent && pDataTemp != &NO_EVENT_DATA)
+				delete pDataTemp;
+			pDataTemp = NULL;
+		}
+		externalEvent = FALSE;
+#else
+		if (pDataTemp)
+		{
+			if (pDataTemp != &NO_EVENT_DATA)
+				delete pDataTemp;
+			pDataTemp = NULL;
+		}
+#endif
+	}
+}
+
+#endif // _STATIC_STATE_MACHINE_H
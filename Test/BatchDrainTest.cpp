@@ -0,0 +1,65 @@
+// Batch drain tests: Thread::SetMaxBatchSize() and GetBatchStats().
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+
+using namespace dmq;
+using namespace dmq::os;
+
+/// Fill a held thread with 20 messages and drain them.
+/// @return The batch statistics, including the batch holding the thread.
+static Thread::BatchStats DrainTwenty(Thread& thread)
+{
+    HoldThread(thread);
+    auto receive = MakeDelegate(&Receive, thread);
+    for (int i = 0; i < 20; i++)
+        receive(i);
+    ReleaseThread();
+
+    std::vector<int> received = TakeReceived(20);
+    bool ordered = received.size() == 20;
+    for (size_t i = 0; ordered && i < received.size(); i++)
+        ordered = received[i] == int(i);
+    CHECK(ordered);
+    return thread.GetBatchStats();
+}
+
+/// The MUTEX and RING modes drain up to the maximum batch size per lock acquisition.
+TEST_CASE(BatchDrain)
+{
+    for (QueueMode mode : { QueueMode::MUTEX, QueueMode::RING })
+    {
+        Thread thread("BatchDrain", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.SetMaxBatchSize(8);
+        thread.CreateThread();
+
+        // The hold message, then batches of 8, 8 and 4
+        Thread::BatchStats stats = DrainTwenty(thread);
+        CHECK(stats.batches == 4);
+        CHECK(stats.messages == 21);
+        CHECK(stats.maxBatch == 8);
+        CHECK(stats.histogram[0] == 1);
+        CHECK(stats.histogram[2] == 1);
+        CHECK(stats.histogram[3] == 2);
+        thread.ExitThread();
+    }
+}
+
+/// By default, and in LOCK_FREE mode, each message is its own batch.
+TEST_CASE(BatchDrainSingle)
+{
+    for (QueueMode mode : { QueueMode::MUTEX, QueueMode::LOCK_FREE })
+    {
+        Thread thread("BatchSingle", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        if (mode == QueueMode::LOCK_FREE)
+            thread.SetMaxBatchSize(8);
+        thread.CreateThread();
+
+        Thread::BatchStats stats = DrainTwenty(thread);
+        CHECK(stats.batches == 21);
+        CHECK(stats.messages == 21);
+        CHECK(stats.maxBatch == 1);
+        CHECK(stats.histogram[0] == 21);
+        thread.ExitThread();
+    }
+}
@@ -0,0 +1,57 @@
+// Batched event tests: AsyncEventBatch.
+
+#include "TestMachines.h"
+
+/// A batch reaches every state machine, keeping the order per state machine.
+TEST_CASE(BatchEvents)
+{
+    QueueMachine sm1, sm2;
+    sm1.CreateThread("Batch1");
+    sm1.CreateEventQueue(16);
+    sm2.CreateThread("Batch2");
+    sm2.CreateEventQueue(16);
+
+    AsyncEventBatch batch;
+    for (int i = 0; i < 10; i++)
+    {
+        batch.Add<&QueueMachine::Set>(sm1, new TestData(i));
+        batch.Add<&QueueMachine::Set>(sm2, new TestData(100 + i));
+    }
+    CHECK(batch.GetSize() == 20);
+    CHECK(batch.Post() == 20);
+    CHECK(batch.GetSize() == 0);
+
+    CHECK(WaitFor([&]() { return sm1.m_count.load() == 10 && sm2.m_count.load() == 10; }));
+    std::vector<int> order1 = sm1.TakeOrder(), order2 = sm2.TakeOrder();
+    bool ordered = order1.size() == 10 && order2.size() == 10;
+    for (size_t i = 0; ordered && i < 10; i++)
+        ordered = order1[i] == int(i) && order2[i] == int(100 + i);
+    CHECK(ordered);
+
+    // Events not fitting the event queue are discarded
+    sm1.Hold();
+    for (int i = 0; i < 20; i++)
+        batch.Add<&QueueMachine::Set>(sm1, new TestData(i));
+    CHECK(batch.Post() == 16);
+    CHECK(sm1.Release(16).size() == 16);
+}
+
+/// Clear() discards the events added since the last Post().
+TEST_CASE(BatchClear)
+{
+    QueueMachine sm;
+    sm.CreateThread("BatchClear");
+    sm.CreateEventQueue(16);
+
+    AsyncEventBatch batch;
+    for (int i = 0; i < 5; i++)
+        batch.Add<&QueueMachine::Set>(sm, new TestData(i));
+    batch.Clear();
+    CHECK(batch.GetSize() == 0);
+    CHECK(batch.Post() == 0);
+
+    batch.Add<&QueueMachine::Set>(sm, new TestData(7));
+    CHECK(batch.Post() == 1);
+    CHECK(WaitFor([&sm]() { return sm.m_count.load() == 1; }));
+    CHECK((sm.TakeOrder() == std::vector<int>{ 7 }));
+}
@@ -0,0 +1,73 @@
+// Coalescing event tests: PostLatestEvent() and ASYNC_INVOKE_LATEST.
+
+#include "TestMachines.h"
+#include <stdexcept>
+
+/// A coalescing event replaces only the last queued coalescing instance.
+TEST_CASE(CoalescingEvents)
+{
+    QueueMachine sm;
+    sm.CreateThread("Coalescing");
+    sm.CreateEventQueue(8);
+
+    sm.Hold();
+    for (int i = 1; i <= 10; i++)
+        sm.PostLatestEvent<&QueueMachine::Set>(new TestData(i));
+    CHECK((sm.Release(1) == std::vector<int>{ 10 }));
+
+    // Never moved ahead of a later event
+    sm.Hold();
+    sm.PostLatestEvent<&QueueMachine::Set>(new TestData(1));
+    sm.PostEvent<&QueueMachine::Halt>();
+    sm.PostLatestEvent<&QueueMachine::Set>(new TestData(2));
+    sm.PostLatestEvent<&QueueMachine::Set>(new TestData(3));
+    CHECK((sm.Release(3) == std::vector<int>{ 1, QueueMachine::HALTED, 3 }));
+
+    // Never replaces an event posted by PostEvent()
+    sm.Hold();
+    sm.PostEvent<&QueueMachine::Set>(new TestData(1));
+    sm.PostLatestEvent<&QueueMachine::Set>(new TestData(2));
+    CHECK((sm.Release(2) == std::vector<int>{ 1, 2 }));
+}
+
+/// ASYNC_INVOKE_LATEST coalesces calls and throws when the event is discarded.
+TEST_CASE(CoalescingInvoke)
+{
+    QueueMachine sm;
+    sm.CreateThread("CoalescingInvoke");
+    sm.CreateEventQueue(4);
+
+    sm.Hold();
+    for (int i = 1; i <= 10; i++)
+    {
+        TestData data(i);
+        sm.SetLatest(&data);
+    }
+    CHECK((sm.Release(1) == std::vector<int>{ 10 }));
+
+    // A full queue still coalesces into its last event
+    sm.Hold();
+    for (int i = 1; i <= 3; i++)
+        sm.PostEvent<&QueueMachine::Set>(new TestData(i));
+    TestData latest(4);
+    sm.SetLatest(&latest);
+    latest.value = 5;
+    sm.SetLatest(&latest);
+    CHECK((sm.Release(4) == std::vector<int>{ 1, 2, 3, 5 }));
+
+    // A full queue ending with another event discards the call
+    sm.Hold();
+    for (int i = 1; i <= 4; i++)
+        sm.PostEvent<&QueueMachine::Set>(new TestData(i));
+    bool thrown = false;
+    try
+    {
+        sm.SetLatest(&latest);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK((sm.Release(4) == std::vector<int>{ 1, 2, 3, 4 }));
+}
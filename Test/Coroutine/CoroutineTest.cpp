@@ -0,0 +1,157 @@
+// Coroutine state tests: a coroutine state activity is destroyed when its state exits,
+// including a self-transition, and a pending delay never resumes it afterwards.
+
+#include "TestMachines.h"
+#include "StateCoroutine.h"
+
+// ST_RUN starts Run(), a coroutine stepping on each EV_STEP, or after a delay. EV_STEP
+// reaches the event map only while the coroutine is not waiting for it.
+class CoroutineMachine : public StateMachine
+{
+public:
+    enum Events
+    {
+        EV_RUN,
+        EV_STEP,
+        EV_STOP,
+        EV_MAX_EVENTS
+    };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_RUN,
+        ST_MAX_STATES
+    };
+
+    enum { DELAY = 20 };
+
+    CoroutineMachine() : StateMachine(ST_MAX_STATES) { CreateEventQueue(4); }
+
+    /// Dispatch an event, then run the queued coroutine resumes.
+    void Send(EVENT_INDEX event)
+    {
+        Dispatch(event);
+        DispatchEvents();
+    }
+
+    BOOL m_delay = FALSE;
+    int m_started = 0;
+    int m_steps = 0;
+    int m_destroyed = 0;
+    int m_idle = 0;
+
+private:
+    // Counts the coroutine frames destroyed, whether finished or cancelled
+    struct FrameMarker
+    {
+        explicit FrameMarker(int& destroyed) : m_destroyed(destroyed) {}
+        ~FrameMarker() { m_destroyed++; }
+        int& m_destroyed;
+    };
+
+    StateTask Run();
+
+    STATE_DECLARE(CoroutineMachine, Idle, NoEventData)
+    STATE_DECLARE(CoroutineMachine, RunState, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&RunState)
+    END_STATE_MAP
+
+    BEGIN_EVENT_MAP
+        EVENT_MAP_ROW(EV_RUN)                               // - Current State -
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+        EVENT_MAP_ROW(EV_STEP)
+            TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+        EVENT_MAP_ROW(EV_STOP)
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_RUN
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+STATE_DEFINE(CoroutineMachine, Idle, NoEventData)
+{
+    m_idle++;
+}
+
+STATE_DEFINE(CoroutineMachine, RunState, NoEventData)
+{
+    Run();
+}
+
+StateTask CoroutineMachine::Run()
+{
+    FrameMarker marker(m_destroyed);
+    m_started++;
+    while (true)
+    {
+        if (m_delay)
+            co_await Delay(DELAY);
+        else
+            co_await WaitEvent(EV_STEP);
+        m_steps++;
+    }
+}
+
+/// Leaving the state destroys the suspended coroutine; its awaited event then
+/// reaches the event map.
+TEST_CASE(CoroutineCancelOnExit)
+{
+    CoroutineMachine sm;
+    sm.Send(CoroutineMachine::EV_RUN);
+    CHECK(sm.m_started == 1);
+
+    sm.Send(CoroutineMachine::EV_STEP);
+    sm.Send(CoroutineMachine::EV_STEP);
+    CHECK(sm.m_steps == 2);
+    CHECK(sm.m_destroyed == 0);
+
+    sm.Send(CoroutineMachine::EV_STOP);
+    CHECK(sm.m_destroyed == 1);
+    int idle = sm.m_idle;
+    sm.Send(CoroutineMachine::EV_STEP);
+    CHECK(sm.m_steps == 2);
+    CHECK(sm.m_idle == idle + 1);
+}
+
+/// A self-transition destroys the coroutine and starts a new one.
+TEST_CASE(CoroutineCancelOnReentry)
+{
+    CoroutineMachine sm;
+    sm.Send(CoroutineMachine::EV_RUN);
+    sm.Send(CoroutineMachine::EV_STEP);
+    sm.Send(CoroutineMachine::EV_RUN);
+    CHECK(sm.m_started == 2);
+    CHECK(sm.m_destroyed == 1);
+
+    // Only the new coroutine steps
+    sm.Send(CoroutineMachine::EV_STEP);
+    CHECK(sm.m_steps == 2);
+    CHECK(sm.m_destroyed == 1);
+}
+
+/// A coroutine destroyed during a delay stops the delay; a delay left running 
+/// resumes the coroutine.
+TEST_CASE(CoroutineCancelDelay)
+{
+    TimerDriver timers;
+    CoroutineMachine sm;
+    sm.m_delay = TRUE;
+
+    sm.Send(CoroutineMachine::EV_RUN);
+    sm.Send(CoroutineMachine::EV_STOP);
+    CHECK(sm.m_destroyed == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(CoroutineMachine::DELAY * 3));
+    sm.DispatchEvents();
+    CHECK(sm.m_steps == 0);
+
+    sm.Send(CoroutineMachine::EV_RUN);
+    std::this_thread::sleep_for(std::chrono::milliseconds(CoroutineMachine::DELAY * 3));
+    sm.DispatchEvents();
+    CHECK(sm.m_steps == 1);
+    CHECK(sm.m_destroyed == 1);
+}
@@ -0,0 +1,114 @@
+// Event map tests: Dispatch() by event ID, ignored events and invalid transitions.
+
+#include "TestMachines.h"
+
+class EventMapMachine : public StateMachine
+{
+public:
+    enum Events
+    {
+        EV_START,
+        EV_FINISH,
+        EV_RESET,
+        EV_MAX_EVENTS
+    };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_RUN,
+        ST_DONE,
+        ST_MAX_STATES
+    };
+
+    EventMapMachine() : StateMachine(ST_MAX_STATES) {}
+
+    int m_starts = 0;
+
+private:
+    STATE_DECLARE(EventMapMachine, Idle, NoEventData)
+    STATE_DECLARE(EventMapMachine, Run, TestData)
+    STATE_DECLARE(EventMapMachine, Done, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&Run)
+        STATE_MAP_ENTRY(&Done)
+    END_STATE_MAP
+
+    BEGIN_EVENT_MAP
+        EVENT_MAP_ROW(EV_START)
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_RUN
+            TRANSITION_MAP_ENTRY(CANNOT_HAPPEN)             // ST_DONE
+        EVENT_MAP_ROW(EV_FINISH)
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_DONE)                   // ST_RUN
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_DONE
+        EVENT_MAP_ROW(EV_RESET)
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_RUN
+            TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_DONE
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+STATE_DEFINE(EventMapMachine, Idle, NoEventData) {}
+STATE_DEFINE(EventMapMachine, Run, TestData) { m_starts++; }
+STATE_DEFINE(EventMapMachine, Done, NoEventData) {}
+
+/// Dispatch() looks up the transition by event ID and current state.
+TEST_CASE(EventMapDispatch)
+{
+    EventMapMachine sm;
+    TestData data(1);
+    sm.Dispatch(EventMapMachine::EV_START, &data);
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_RUN);
+    CHECK(sm.m_starts == 1);
+
+    sm.Dispatch(EventMapMachine::EV_FINISH);
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_DONE);
+
+    sm.Dispatch(EventMapMachine::EV_RESET);
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_IDLE);
+
+    sm.Dispatch(EventMapMachine::EV_START, &data);
+    CHECK(sm.m_starts == 2);
+}
+
+/// An EVENT_IGNORED entry keeps the current state without executing a state.
+TEST_CASE(EventMapIgnored)
+{
+    EventMapMachine sm;
+    sm.Dispatch(EventMapMachine::EV_FINISH);
+    sm.Dispatch(EventMapMachine::EV_RESET);
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_IDLE);
+
+    TestData data(1);
+    sm.Dispatch(EventMapMachine::EV_START, &data);
+    sm.Dispatch(EventMapMachine::EV_START, &data);
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_RUN);
+    CHECK(sm.m_starts == 1);
+
+    // Ignored events are not traced
+    StateTraceRecord records[4];
+    CHECK(sm.GetTrace(records, 4) == 1);
+}
+
+/// A CANNOT_HAPPEN entry and an event ID outside the event map fail an ASSERT.
+TEST_CASE(EventMapCannotHappen)
+{
+    EventMapMachine done;
+    TestData data(1);
+    done.Dispatch(EventMapMachine::EV_START, &data);
+    done.Dispatch(EventMapMachine::EV_FINISH);
+    CHECK_FAULT(done.Dispatch(EventMapMachine::EV_START));
+
+    // The invalid transition is recorded in the trace
+    StateTraceRecord record;
+    CHECK(done.GetTrace(&record, 1) == 1);
+    CHECK(record.fromState == EventMapMachine::ST_DONE && record.toState == EventMapMachine::CANNOT_HAPPEN);
+
+    EventMapMachine sm;
+    CHECK_FAULT(sm.Dispatch(EventMapMachine::EV_MAX_EVENTS));
+    CHECK(sm.GetCurrentState() == EventMapMachine::ST_IDLE);
+}
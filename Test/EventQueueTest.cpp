@@ -0,0 +1,30 @@
+// Event queue tests: posting order and capacity.
+
+#include "TestMachines.h"
+
+/// Events execute in posting order, and a full queue rejects normal events.
+TEST_CASE(EventQueue)
+{
+    QueueMachine sm;
+    sm.CreateThread("EventQueue");
+    sm.CreateEventQueue(4);
+
+    sm.Hold();
+    for (int i = 1; i <= 4; i++)
+        CHECK(sm.PostEvent<&QueueMachine::Set>(new TestData(i)));
+    CHECK(!sm.PostEvent<&QueueMachine::Set>(new TestData(5)));
+    CHECK((sm.Release(4) == std::vector<int>{ 1, 2, 3, 4 }));
+
+    // Events posted to an idle thread
+    for (int i = 0; i < 100; i++)
+    {
+        while (!sm.PostEvent<&QueueMachine::Set>(new TestData(i)))
+            std::this_thread::yield();
+    }
+    CHECK(WaitFor([&]() { return sm.m_count.load() == 100; }));
+    std::vector<int> order = sm.TakeOrder();
+    bool ordered = order.size() == 100;
+    for (size_t i = 0; ordered && i < order.size(); i++)
+        ordered = order[i] == int(i);
+    CHECK(ordered);
+}
@@ -0,0 +1,119 @@
+// Hierarchical state tests: exit and entry order through composite states.
+
+#include "TestMachines.h"
+#include <string>
+
+// Off and On are top level states. Fast and Slow are nested within On, and Turbo
+// is nested within Fast. Each entry and exit action is logged.
+class HierarchyMachine : public StateMachine
+{
+public:
+    enum States
+    {
+        ST_OFF,
+        ST_ON,
+        ST_FAST,
+        ST_SLOW,
+        ST_TURBO,
+        ST_MAX_STATES
+    };
+
+    HierarchyMachine() : StateMachine(ST_MAX_STATES) {}
+
+    /// Generate an external event to any state.
+    void GoTo(STATE_INDEX state) { ExternalEvent(state); }
+
+    /// Get the logged actions and clear them.
+    std::vector<std::string> TakeLog()
+    {
+        std::vector<std::string> log;
+        log.swap(m_log);
+        return log;
+    }
+
+private:
+    std::vector<std::string> m_log;
+
+    STATE_DECLARE(HierarchyMachine, Off, NoEventData)
+    STATE_DECLARE(HierarchyMachine, On, NoEventData)
+    STATE_DECLARE(HierarchyMachine, Fast, NoEventData)
+    STATE_DECLARE(HierarchyMachine, Slow, NoEventData)
+    STATE_DECLARE(HierarchyMachine, Turbo, NoEventData)
+
+    ENTRY_DECLARE(HierarchyMachine, EntryOn, NoEventData)
+    ENTRY_DECLARE(HierarchyMachine, EntryFast, NoEventData)
+    ENTRY_DECLARE(HierarchyMachine, EntrySlow, NoEventData)
+    ENTRY_DECLARE(HierarchyMachine, EntryTurbo, NoEventData)
+    EXIT_DECLARE(HierarchyMachine, ExitOn)
+    EXIT_DECLARE(HierarchyMachine, ExitFast)
+    EXIT_DECLARE(HierarchyMachine, ExitSlow)
+    EXIT_DECLARE(HierarchyMachine, ExitTurbo)
+
+    BEGIN_STATE_MAP_EX
+        STATE_MAP_ENTRY_EX(&Off)
+        STATE_MAP_ENTRY_ALL_EX(&On, 0, &EntryOn, &ExitOn)
+        STATE_MAP_ENTRY_CHILD_EX(&Fast, ST_ON, 0, &EntryFast, &ExitFast)
+        STATE_MAP_ENTRY_CHILD_EX(&Slow, ST_ON, 0, &EntrySlow, &ExitSlow)
+        STATE_MAP_ENTRY_CHILD_EX(&Turbo, ST_FAST, 0, &EntryTurbo, &ExitTurbo)
+    END_STATE_MAP_EX
+};
+
+STATE_DEFINE(HierarchyMachine, Off, NoEventData) { m_log.push_back("Off"); }
+STATE_DEFINE(HierarchyMachine, On, NoEventData) { m_log.push_back("On"); }
+STATE_DEFINE(HierarchyMachine, Fast, NoEventData) { m_log.push_back("Fast"); }
+STATE_DEFINE(HierarchyMachine, Slow, NoEventData) { m_log.push_back("Slow"); }
+STATE_DEFINE(HierarchyMachine, Turbo, NoEventData) { m_log.push_back("Turbo"); }
+
+ENTRY_DEFINE(HierarchyMachine, EntryOn, NoEventData) { m_log.push_back("+On"); }
+ENTRY_DEFINE(HierarchyMachine, EntryFast, NoEventData) { m_log.push_back("+Fast"); }
+ENTRY_DEFINE(HierarchyMachine, EntrySlow, NoEventData) { m_log.push_back("+Slow"); }
+ENTRY_DEFINE(HierarchyMachine, EntryTurbo, NoEventData) { m_log.push_back("+Turbo"); }
+EXIT_DEFINE(HierarchyMachine, ExitOn) { m_log.push_back("-On"); }
+EXIT_DEFINE(HierarchyMachine, ExitFast) { m_log.push_back("-Fast"); }
+EXIT_DEFINE(HierarchyMachine, ExitSlow) { m_log.push_back("-Slow"); }
+EXIT_DEFINE(HierarchyMachine, ExitTurbo) { m_log.push_back("-Turbo"); }
+
+typedef std::vector<std::string> Log;
+
+/// A transition exits up to the least common ancestor, innermost first, then enters
+/// down to the new state, outermost first.
+TEST_CASE(HierarchyOrder)
+{
+    HierarchyMachine sm;
+
+    sm.GoTo(HierarchyMachine::ST_FAST);
+    CHECK((sm.TakeLog() == Log{ "+On", "+Fast", "Fast" }));
+
+    // Siblings within On do not exit or enter On
+    sm.GoTo(HierarchyMachine::ST_SLOW);
+    CHECK((sm.TakeLog() == Log{ "-Fast", "+Slow", "Slow" }));
+
+    sm.GoTo(HierarchyMachine::ST_TURBO);
+    CHECK((sm.TakeLog() == Log{ "-Slow", "+Fast", "+Turbo", "Turbo" }));
+
+    sm.GoTo(HierarchyMachine::ST_OFF);
+    CHECK((sm.TakeLog() == Log{ "-Turbo", "-Fast", "-On", "Off" }));
+    CHECK(sm.GetCurrentState() == HierarchyMachine::ST_OFF);
+}
+
+/// A transition to an ancestor or descendant state does not exit and re-enter the 
+/// ancestor, and a self-transition executes only the state function.
+TEST_CASE(HierarchyAncestors)
+{
+    HierarchyMachine sm;
+
+    sm.GoTo(HierarchyMachine::ST_ON);
+    CHECK((sm.TakeLog() == Log{ "+On", "On" }));
+
+    sm.GoTo(HierarchyMachine::ST_TURBO);
+    CHECK((sm.TakeLog() == Log{ "+Fast", "+Turbo", "Turbo" }));
+
+    sm.GoTo(HierarchyMachine::ST_TURBO);
+    CHECK((sm.TakeLog() == Log{ "Turbo" }));
+
+    sm.GoTo(HierarchyMachine::ST_ON);
+    CHECK((sm.TakeLog() == Log{ "-Turbo", "-Fast", "On" }));
+
+    sm.GoTo(HierarchyMachine::ST_FAST);
+    CHECK((sm.TakeLog() == Log{ "+Fast", "Fast" }));
+}
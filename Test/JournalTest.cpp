@@ -0,0 +1,59 @@
+// Event journal tests: recording and replaying external events.
+
+#include "TestMachines.h"
+#include "StateJournal.h"
+#include <cstdio>
+
+/// Replaying a journal reproduces the recorded state machine, for events generated
+/// both by ID and by external event functions.
+TEST_CASE(JournalReplay)
+{
+    const char* path = "JournalTest.smj";
+    StateJournal journal;
+    CHECK(journal.Open(path, RecordMachine::ST_MAX_STATES));
+
+    RecordMachine sm;
+    sm.SetJournal(&journal);
+    for (int i = 0; i < 500; i++)
+    {
+        sm.Set(i);
+        if (i % 7 == 0)
+            sm.Dispatch(RecordMachine::EV_STOP);
+        if (i % 11 == 0)
+            sm.Reset();
+    }
+    sm.SetJournal(NULL);
+    uint64_t recorded = journal.GetRecordCount();
+    journal.Close();
+    CHECK(recorded > 500);
+
+    RecordMachine replay;
+    CHECK(StateJournal::Replay(replay, path) == recorded);
+    CHECK(replay.m_sum == sm.m_sum);
+    CHECK(replay.m_runs == sm.m_runs);
+    CHECK(replay.m_stops == sm.m_stops);
+    CHECK(replay.GetCurrentState() == sm.GetCurrentState());
+    remove(path);
+}
+
+/// A journal recorded by a state machine with a different number of states, or a
+/// buffer that is not a journal, replays nothing.
+TEST_CASE(JournalRejected)
+{
+    const char* path = "JournalRejected.smj";
+    StateJournal journal;
+    CHECK(journal.Open(path, RecordMachine::ST_MAX_STATES + 1));
+    RecordMachine sm;
+    sm.SetJournal(&journal);
+    sm.Set(1);
+    sm.SetJournal(NULL);
+    journal.Close();
+
+    RecordMachine replay;
+    CHECK(StateJournal::Replay(replay, path) == 0);
+    CHECK(replay.m_runs == 0);
+    remove(path);
+
+    alignas(8) char garbage[256] = {};
+    CHECK(StateJournal::Replay(replay, garbage, sizeof(garbage)) == 0);
+}
@@ -0,0 +1,111 @@
+// Linux thread tests: dmq::os::LinuxThread.
+
+#if defined(__linux__)
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+#include <cerrno>
+
+using namespace dmq;
+using namespace dmq::os;
+
+// Globals, as DelegateMQ copies pointer arguments
+static LinuxThread* g_thread = nullptr;
+static std::atomic<bool> g_onThread(false);
+
+static void CheckCurrentThread(int)
+{
+    g_onThread = g_thread->IsCurrentThread();
+}
+
+/// CreateThread() starts a named worker that invokes delegates.
+TEST_CASE(LinuxThreadCreate)
+{
+    LinuxThread thread("LinuxCreate");
+    CHECK(!thread.IsCurrentThread());
+    CHECK(thread.CreateThread());
+    CHECK(thread.CreateThread());
+    CHECK(thread.GetCreateError() == 0);
+    CHECK(WaitFor([&]() { return thread.GetNativeThreadId() != 0; }));
+    CHECK(!thread.IsCurrentThread());
+
+    g_thread = &thread;
+    MakeDelegate(&CheckCurrentThread, thread)(0);
+    auto receive = MakeDelegate(&Receive, thread);
+    receive(1);
+    receive(2);
+    CHECK((TakeReceived(2) == std::vector<int>{ 1, 2 }));
+    CHECK(g_onThread.load());
+    thread.ExitThread();
+}
+
+/// CreateThread() reports attributes the system rejects.
+TEST_CASE(LinuxThreadAttributes)
+{
+    ThreadAttributes attributes;
+    attributes.cpus = { 0 };
+    attributes.stackSize = 1;
+    LinuxThread pinned("LinuxPinned", attributes);
+    CHECK(pinned.CreateThread());
+    auto receive = MakeDelegate(&Receive, pinned);
+    receive(1);
+    CHECK((TakeReceived(1) == std::vector<int>{ 1 }));
+    pinned.ExitThread();
+
+    attributes.cpus = { -1 };
+    LinuxThread invalid("LinuxInvalid", attributes);
+    CHECK(!invalid.CreateThread());
+    CHECK(invalid.GetCreateError() == EINVAL);
+    CHECK(invalid.GetNativeThreadId() == 0);
+}
+
+/// ExitThread() invokes the queued messages first, and the thread can be created
+/// again.
+TEST_CASE(LinuxThreadExit)
+{
+    LinuxThread thread("LinuxExit");
+    thread.CreateThread();
+
+    HoldThread(thread);
+    auto receive = MakeDelegate(&Receive, thread);
+    for (int i = 0; i < 10; i++)
+        receive(i);
+    ReleaseThread();
+    thread.ExitThread();
+    CHECK(TakeReceived(10).size() == 10);
+    CHECK(thread.GetNativeThreadId() == 0);
+    CHECK(thread.GetQueueSize() == 0);
+    thread.ExitThread();
+
+    CHECK(thread.CreateThread());
+    receive(100);
+    CHECK((TakeReceived(1) == std::vector<int>{ 100 }));
+    thread.ExitThread();
+}
+
+/// A batch is invoked by priority level, highest first, FIFO within a level.
+TEST_CASE(LinuxThreadPriority)
+{
+    LinuxThread thread("LinuxPriority", ThreadAttributes(), 16);
+    thread.CreateThread();
+
+    HoldThread(thread);
+    auto lowest = MakeDelegate(&Receive, thread);
+    auto normal = MakeDelegate(&Receive, thread);
+    auto high = MakeDelegate(&Receive, thread);
+    auto highest = MakeDelegate(&Receive, thread);
+    lowest.SetPriority(Priority::LOWEST);
+    high.SetPriority(Priority::HIGH);
+    highest.SetPriority(Priority::HIGHEST);
+    lowest(1);
+    normal(10);
+    high(100);
+    normal(11);
+    highest(1000);
+    high(101);
+    ReleaseThread();
+    CHECK((TakeReceived(6) == std::vector<int>{ 1000, 100, 101, 10, 11, 1 }));
+    thread.ExitThread();
+}
+
+#endif
@@ -0,0 +1,82 @@
+// Lock-free thread queue tests: QueueMode::LOCK_FREE.
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+#include <thread>
+
+using namespace dmq;
+using namespace dmq::os;
+
+/// State machine events flow through a LOCK_FREE thread queue in order.
+TEST_CASE(LockFreeEvents)
+{
+    AsyncStateMachine::ThreadOptions options;
+    options.queueMode = QueueMode::LOCK_FREE;
+    options.maxQueueSize = 64;
+
+    QueueMachine sm;
+    sm.CreateThread("LockFreeEvents", options);
+    sm.CreateEventQueue(1024);
+    for (int i = 0; i < 1000; i++)
+        CHECK(sm.PostEvent<&QueueMachine::Set>(new TestData(i)));
+    CHECK(WaitFor([&]() { return sm.m_count.load() == 1000; }));
+    std::vector<int> order = sm.TakeOrder();
+    bool ordered = order.size() == 1000;
+    for (size_t i = 0; ordered && i < order.size(); i++)
+        ordered = order[i] == int(i);
+    CHECK(ordered);
+}
+
+/// Concurrent producers waiting on a full queue lose no message, and each
+/// producer's messages arrive in order.
+TEST_CASE(LockFreeProducers)
+{
+    const int PRODUCERS = 4, COUNT = 2000;
+    Thread thread("LockFreeProducers", 64, FullPolicy::TIMEOUT, std::chrono::seconds(5), "", 
+        QueueMode::LOCK_FREE);
+    thread.CreateThread();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&thread, p]() {
+            auto receive = MakeDelegate(&Receive, thread);
+            for (int i = 0; i < COUNT; i++)
+                receive(p * COUNT + i);
+        });
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+
+    std::vector<int> received = TakeReceived(PRODUCERS * COUNT);
+    CHECK(received.size() == size_t(PRODUCERS * COUNT));
+    std::vector<int> next(PRODUCERS, 0);
+    bool ordered = true;
+    for (int value : received)
+    {
+        int p = value / COUNT;
+        ordered = ordered && value % COUNT == next[p]++;
+    }
+    CHECK(ordered);
+    thread.ExitThread();
+}
+
+/// A LOCK_FREE thread serves higher priority messages first.
+TEST_CASE(LockFreePriority)
+{
+    Thread thread("LockFreePriority", 16, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", 
+        QueueMode::LOCK_FREE);
+    thread.CreateThread();
+
+    HoldThread(thread);
+    auto normal = MakeDelegate(&Receive, thread);
+    auto high = MakeDelegate(&Receive, thread);
+    high.SetPriority(Priority::HIGH);
+    normal(1);
+    normal(2);
+    high(100);
+    high(101);
+    ReleaseThread();
+    CHECK((TakeReceived(4) == std::vector<int>{ 100, 101, 1, 2 }));
+    thread.ExitThread();
+}
@@ -0,0 +1,150 @@
+// Move-only event data tests: ASYNC_INVOKE_MOVE with std::unique_ptr event data.
+
+#include "TestMachines.h"
+#include <memory>
+#include <stdexcept>
+
+// Event data that cannot be copied, counting the live instances
+class BufferData : public EventData
+{
+public:
+    explicit BufferData(int v = 0) : value(v) { s_alive++; }
+    BufferData(const BufferData&) = delete;
+    BufferData& operator=(const BufferData&) = delete;
+    ~BufferData() { s_alive--; }
+
+    int value;
+    static std::atomic<int> s_alive;
+};
+
+std::atomic<int> BufferData::s_alive{0};
+
+// Records the address of each loaded buffer. A HOLD buffer parks the thread inside
+// ST_LOAD until m_hold is cleared.
+class BufferMachine : public AsyncStateMachine
+{
+public:
+    enum { HOLD = -1 };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_LOAD,
+        ST_MAX_STATES
+    };
+
+    BufferMachine() : AsyncStateMachine(ST_MAX_STATES) {}
+
+    void Load(std::unique_ptr<BufferData> data);
+    void Clear();
+
+    /// Load a HOLD buffer and wait until the state machine thread executes it.
+    void Hold()
+    {
+        m_hold = true;
+        m_held = false;
+        Load(std::unique_ptr<BufferData>(new BufferData(HOLD)));
+        WaitFor([this]() { return m_held.load(); });
+    }
+
+    std::atomic<bool> m_hold{false};
+    std::atomic<bool> m_held{false};
+    std::atomic<int> m_loads{0};
+    std::atomic<int> m_clears{0};
+    std::atomic<const BufferData*> m_loaded{nullptr};
+
+private:
+    STATE_DECLARE(BufferMachine, Idle, NoEventData)
+    STATE_DECLARE(BufferMachine, LoadState, BufferData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&LoadState)
+    END_STATE_MAP
+};
+
+void BufferMachine::Load(std::unique_ptr<BufferData> data)
+{
+    ASYNC_INVOKE_MOVE(BufferMachine, Load, data);
+
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_LOAD)                   // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_LOAD)                   // ST_LOAD
+    END_TRANSITION_MAP(data)
+}
+
+void BufferMachine::Clear()
+{
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_LOAD
+    END_TRANSITION_MAP(NULL)
+}
+
+STATE_DEFINE(BufferMachine, Idle, NoEventData)
+{
+    m_clears++;
+}
+
+STATE_DEFINE(BufferMachine, LoadState, BufferData)
+{
+    if (data->value == HOLD)
+    {
+        m_held = true;
+        while (m_hold)
+            std::this_thread::yield();
+        return;
+    }
+    m_loaded = data;
+    m_loads++;
+}
+
+/// The state action receives the caller's instance, never a copy, and the instance
+/// is deleted once the state action completes.
+TEST_CASE(MoveData)
+{
+    BufferMachine sm;
+    sm.CreateThread("MoveData");
+    sm.CreateEventQueue(4);
+
+    std::unique_ptr<BufferData> data(new BufferData(1));
+    const BufferData* sent = data.get();
+    sm.Load(std::move(data));
+    CHECK(data == nullptr);
+    CHECK(WaitFor([&sm]() { return sm.m_loads.load() == 1; }));
+    CHECK(sm.m_loaded.load() == sent);
+    CHECK(WaitFor([]() { return BufferData::s_alive.load() == 0; }));
+}
+
+/// Event data of purged or rejected events is deleted without executing. Calling
+/// the event function with a full queue throws.
+TEST_CASE(MoveDataDiscarded)
+{
+    BufferMachine sm;
+    sm.CreateThread("MoveDataDiscarded");
+    sm.CreateEventQueue(4);
+
+    sm.Hold();
+    for (int i = 1; i <= 4; i++)
+        sm.Load(std::unique_ptr<BufferData>(new BufferData(i)));
+    CHECK(!sm.PostEvent<&BufferMachine::Load>(new BufferData(5)));
+    CHECK(BufferData::s_alive == 5);
+    bool thrown = false;
+    try
+    {
+        sm.Load(std::unique_ptr<BufferData>(new BufferData(6)));
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(BufferData::s_alive == 5);
+
+    CHECK((sm.PostPriorityEvent<&BufferMachine::Clear, const EventData>(NULL, TRUE)));
+    CHECK(BufferData::s_alive == 1);
+    sm.m_hold = false;
+    CHECK(WaitFor([&sm]() { return sm.m_clears.load() == 1; }));
+    CHECK(WaitFor([]() { return BufferData::s_alive.load() == 0; }));
+    CHECK(sm.m_loads == 0);
+}
@@ -0,0 +1,110 @@
+// Thread priority level tests: dmq::Priority and Thread::SetPriorityAging().
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+
+using namespace dmq;
+using namespace dmq::os;
+
+static const QueueMode MODES[] = { QueueMode::MUTEX, QueueMode::LOCK_FREE, QueueMode::RING };
+
+/// NORMAL and HIGH keep their original values, and the levels index in order.
+TEST_CASE(PriorityValues)
+{
+    CHECK(static_cast<int>(Priority::NORMAL) == 0);
+    CHECK(static_cast<int>(Priority::HIGH) == 1);
+    CHECK(GetPriorityLevel(Priority::LOWEST) == 0);
+    CHECK(GetPriorityLevel(Priority::NORMAL) == 2);
+    CHECK(GetPriorityLevel(Priority::HIGHEST) == PRIORITY_LEVELS - 1);
+    CHECK(Priority::LOWEST < Priority::NORMAL && Priority::HIGHEST > Priority::HIGH);
+}
+
+/// The thread serves the highest level holding a message, FIFO within a level.
+TEST_CASE(PriorityLevels)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("PriorityLevels", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.CreateThread();
+
+        HoldThread(thread);
+        const Priority priorities[] = { Priority::LOWEST, Priority::LOW, Priority::NORMAL, 
+            Priority::HIGH, Priority::HIGHEST };
+        for (int i = 0; i < 2; i++)
+        {
+            for (Priority priority : priorities)
+            {
+                auto receive = MakeDelegate(&Receive, thread);
+                receive.SetPriority(priority);
+                receive(int(GetPriorityLevel(priority)) * 10 + i);
+            }
+        }
+        ReleaseThread();
+        CHECK((TakeReceived(10) == std::vector<int>{ 40, 41, 30, 31, 20, 21, 10, 11, 0, 1 }));
+        thread.ExitThread();
+    }
+}
+
+/// With aging, a LOWEST message that waited outranks newly queued HIGHEST messages.
+TEST_CASE(PriorityAging)
+{
+    for (QueueMode mode : MODES)
+    {
+        for (bool aging : { false, true })
+        {
+            Thread thread("PriorityAging", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+            if (aging)
+                thread.SetPriorityAging(std::chrono::milliseconds(1));
+            thread.CreateThread();
+
+            HoldThread(thread);
+            auto low = MakeDelegate(&Receive, thread);
+            auto high = MakeDelegate(&Receive, thread);
+            low.SetPriority(Priority::LOWEST);
+            high.SetPriority(Priority::HIGHEST);
+            low(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            high(100);
+            high(101);
+            ReleaseThread();
+            if (aging)
+                CHECK((TakeReceived(3) == std::vector<int>{ 1, 100, 101 }));
+            else
+                CHECK((TakeReceived(3) == std::vector<int>{ 100, 101, 1 }));
+            thread.ExitThread();
+        }
+    }
+}
+
+/// The exit message queues at LOWEST, so ExitThread() invokes every queued message.
+TEST_CASE(PriorityExitLowest)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("PriorityExit", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.CreateThread();
+
+        HoldThread(thread);
+        auto lowest = MakeDelegate(&Receive, thread);
+        lowest.SetPriority(Priority::LOWEST);
+        for (int i = 0; i < 10; i++)
+            lowest(i);
+        ReleaseThread();
+        thread.ExitThread();
+        CHECK(TakeReceived(10).size() == 10);
+    }
+
+#if defined(__linux__)
+    LinuxThread thread("LinuxExitLowest");
+    thread.CreateThread();
+
+    HoldThread(thread);
+    auto lowest = MakeDelegate(&Receive, thread);
+    lowest.SetPriority(Priority::LOWEST);
+    for (int i = 0; i < 10; i++)
+        lowest(i);
+    ReleaseThread();
+    thread.ExitThread();
+    CHECK(TakeReceived(10).size() == 10);
+#endif
+}
@@ -0,0 +1,102 @@
+// Priority event tests: PostPriorityEvent(), purging, and the queued event function 
+// macros on a full event queue.
+
+#include "TestMachines.h"
+#include "Motor.h"
+#include "StateJournal.h"
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+/// Priority events run ahead of queued events, and a purge discards them. One
+/// priority event fits in a full queue.
+TEST_CASE(PriorityEvents)
+{
+    QueueMachine sm;
+    sm.CreateThread("Priority");
+    sm.CreateEventQueue(4);
+
+    sm.Hold();
+    for (int i = 1; i <= 3; i++)
+        sm.PostEvent<&QueueMachine::Set>(new TestData(i));
+    sm.PostPriorityEvent<&QueueMachine::Set>(new TestData(100));
+    sm.PostPriorityEvent<&QueueMachine::Set>(new TestData(101));
+    CHECK((sm.Release(5) == std::vector<int>{ 100, 101, 1, 2, 3 }));
+
+    // Purge
+    sm.Hold();
+    for (int i = 1; i <= 3; i++)
+        sm.PostEvent<&QueueMachine::Set>(new TestData(i));
+    CHECK((sm.PostPriorityEvent<&QueueMachine::Halt, const EventData>(NULL, TRUE)));
+    sm.PostEvent<&QueueMachine::Set>(new TestData(4));
+    CHECK((sm.Release(2) == std::vector<int>{ QueueMachine::HALTED, 4 }));
+
+    // Full queue
+    sm.Hold();
+    for (int i = 1; i <= 4; i++)
+        sm.PostEvent<&QueueMachine::Set>(new TestData(i));
+    CHECK(sm.PostPriorityEvent<&QueueMachine::Set>(new TestData(100)));
+    CHECK(!sm.PostPriorityEvent<&QueueMachine::Set>(new TestData(101)));
+    CHECK((sm.Release(5) == std::vector<int>{ 100, 1, 2, 3, 4 }));
+}
+
+/// A queued event function called with a full event queue throws.
+TEST_CASE(QueuedInvokeFull)
+{
+    QueueMachine sm;
+    sm.CreateThread("QueuedInvokeFull");
+    sm.CreateEventQueue(4);
+
+    sm.Hold();
+    TestData data(1);
+    for (int i = 1; i <= 4; i++)
+        sm.SetQueued(&data);
+    bool thrown = false;
+    try
+    {
+        sm.SetQueued(&data);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(sm.Release(4).size() == 4);
+}
+
+/// Motor::Halt() runs ahead of a full queue of speed changes and discards them.
+TEST_CASE(MotorHaltPurges)
+{
+    const STATE_INDEX MOTOR_IDLE = 0;   // Motor::ST_IDLE
+
+    Motor motor;
+    MotorData data;
+    data.speed = 100;
+    motor.SetSpeed(&data);
+    CHECK(WaitFor([&motor]() { return motor.GetCurrentState() != MOTOR_IDLE; }));
+    STATE_INDEX running = motor.GetCurrentState();
+
+    // Record the events that execute from here on
+    const char* path = "MotorHaltPurges.smj";
+    StateJournal journal;
+    CHECK(journal.Open(path));
+    motor.SetJournal(&journal);
+
+    HoldThread(*motor.GetThread());
+    for (int i = 1; i <= 8; i++)
+    {
+        MotorData* speed = new MotorData();
+        speed->speed = 100 + i;
+        CHECK(motor.PostEvent<&Motor::SetSpeed>(speed));
+    }
+    motor.Halt();
+    ReleaseThread();
+
+    CHECK(WaitFor([&motor, running]() { return motor.GetCurrentState() != running; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    motor.SetJournal(NULL);
+    CHECK(journal.GetRecordCount() == 1);
+    CHECK(motor.GetCurrentState() == MOTOR_IDLE);
+    journal.Close();
+    remove(path);
+}
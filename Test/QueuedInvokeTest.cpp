@@ -0,0 +1,36 @@
+// Queued external event tests: ASYNC_INVOKE_QUEUED.
+
+#include "TestMachines.h"
+
+/// Queued event functions execute in calling order with a copy of the event data,
+/// interleaved in order with events posted by PostEvent().
+TEST_CASE(QueuedInvoke)
+{
+    QueueMachine sm;
+    sm.CreateThread("QueuedInvoke");
+    sm.CreateEventQueue(8);
+
+    // The caller's data may change or go out of scope once the call returns
+    sm.Hold();
+    TestData data(1);
+    sm.SetQueued(&data);
+    data.value = 2;
+    sm.SetQueued(&data);
+    sm.PostEvent<&QueueMachine::Set>(new TestData(3));
+    data.value = 4;
+    sm.SetQueued(&data);
+    CHECK((sm.Release(4) == std::vector<int>{ 1, 2, 3, 4 }));
+
+    // Calls to an idle thread
+    for (int i = 0; i < 100; i++)
+    {
+        TestData value(i);
+        sm.SetQueued(&value);
+        WaitFor([&sm, i]() { return sm.m_count.load() == size_t(i + 1); });
+    }
+    std::vector<int> order = sm.TakeOrder();
+    bool ordered = order.size() == 100;
+    for (size_t i = 0; ordered && i < order.size(); i++)
+        ordered = order[i] == int(i);
+    CHECK(ordered);
+}
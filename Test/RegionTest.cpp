@@ -0,0 +1,170 @@
+// Orthogonal region tests: fork and join on a thread pool, and the inline fallbacks.
+
+#include "TestHarness.h"
+#include "StateRegions.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+using namespace dmq;
+using namespace dmq::os;
+
+// A region recording the thread that executes each EV_GO. The state action takes 
+// long enough for the regions to overlap when they execute concurrently.
+class RegionMachine : public StateMachine
+{
+public:
+    enum Events
+    {
+        EV_GO,
+        EV_MAX_EVENTS
+    };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_DONE,
+        ST_MAX_STATES
+    };
+
+    RegionMachine() : StateMachine(ST_MAX_STATES) {}
+
+    std::thread::id m_thread;
+    std::atomic<bool> m_done{false};
+
+private:
+    STATE_DECLARE(RegionMachine, Idle, NoEventData)
+    STATE_DECLARE(RegionMachine, Done, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&Done)
+    END_STATE_MAP
+
+    BEGIN_EVENT_MAP
+        EVENT_MAP_ROW(EV_GO)
+            TRANSITION_MAP_ENTRY(ST_DONE)                   // ST_IDLE
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_DONE
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+STATE_DEFINE(RegionMachine, Idle, NoEventData)
+{
+}
+
+STATE_DEFINE(RegionMachine, Done, NoEventData)
+{
+    m_thread = std::this_thread::get_id();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    m_done = true;
+}
+
+const size_t REGIONS = 3;
+
+/// @return true if every region completed EV_GO, each on one of threads.
+static bool RegionsDone(RegionMachine* regions, const std::set<std::thread::id>& threads)
+{
+    for (size_t i = 0; i < REGIONS; i++)
+    {
+        if (!regions[i].m_done || regions[i].GetCurrentState() != RegionMachine::ST_DONE ||
+            threads.count(regions[i].m_thread) == 0)
+            return false;
+    }
+    return true;
+}
+
+/// Get the threads that executed the regions.
+static std::set<std::thread::id> RegionThreads(RegionMachine* regions)
+{
+    std::set<std::thread::id> threads;
+    for (size_t i = 0; i < REGIONS; i++)
+        threads.insert(regions[i].m_thread);
+    return threads;
+}
+
+/// Without a pool, the regions execute one after another on the calling thread.
+TEST_CASE(RegionsSerial)
+{
+    RegionMachine regions[REGIONS];
+    StateRegions composite;
+    for (size_t i = 0; i < REGIONS; i++)
+        composite.AddRegion(regions[i]);
+
+    composite.Dispatch(RegionMachine::EV_GO);
+    CHECK(RegionsDone(regions, { std::this_thread::get_id() }));
+}
+
+/// With a pool, the regions fork onto their strands, the caller executes the first
+/// region, and Dispatch() returns once every region has completed.
+TEST_CASE(RegionsJoin)
+{
+    ThreadPool pool("Regions", 4);
+    CHECK(pool.CreateThreads());
+
+    RegionMachine regions[REGIONS];
+    StateRegions composite(&pool);
+    for (size_t i = 0; i < REGIONS; i++)
+        composite.AddRegion(regions[i]);
+
+    composite.Dispatch(RegionMachine::EV_GO);
+    std::set<std::thread::id> threads = RegionThreads(regions);
+    CHECK(RegionsDone(regions, threads));
+    CHECK(regions[0].m_thread == std::this_thread::get_id());
+    CHECK(threads.size() >= 2);
+
+    // The regions keep their states; a second event is ignored by each
+    composite.Dispatch(RegionMachine::EV_GO);
+    CHECK(RegionsDone(regions, threads));
+}
+
+static StateRegions* g_composite = nullptr;
+static std::atomic<bool> g_dispatched{false};
+
+static void DispatchRegions(int)
+{
+    g_composite->Dispatch(RegionMachine::EV_GO);
+    g_dispatched = true;
+}
+
+/// A pool worker dispatching to the regions executes them itself, rather than wait
+/// on strands possibly queued behind it.
+TEST_CASE(RegionsInlineOnWorker)
+{
+    ThreadPool pool("RegionsWorker", 2);
+    CHECK(pool.CreateThreads());
+
+    RegionMachine regions[REGIONS];
+    StateRegions composite(&pool);
+    for (size_t i = 0; i < REGIONS; i++)
+        composite.AddRegion(regions[i]);
+
+    // Delegates copy pointer arguments, so the regions are reached through a global
+    g_composite = &composite;
+    g_dispatched = false;
+    std::shared_ptr<Strand> strand = pool.CreateStrand();
+    MakeDelegate(&DispatchRegions, *strand)(0);
+    CHECK(WaitFor([]() { return g_dispatched.load(); }));
+
+    std::set<std::thread::id> threads = RegionThreads(regions);
+    CHECK(RegionsDone(regions, threads));
+    CHECK(threads.size() == 1);
+    CHECK(threads.count(std::this_thread::get_id()) == 0);
+}
+
+/// Regions whose strands reject the work, because the pool is exiting, execute on
+/// the calling thread.
+TEST_CASE(RegionsInlineOnExit)
+{
+    ThreadPool pool("RegionsExit", 2);
+    CHECK(pool.CreateThreads());
+
+    RegionMachine regions[REGIONS];
+    StateRegions composite(&pool);
+    for (size_t i = 0; i < REGIONS; i++)
+        composite.AddRegion(regions[i]);
+
+    pool.ExitThreads();
+    composite.Dispatch(RegionMachine::EV_GO);
+    CHECK(RegionsDone(regions, { std::this_thread::get_id() }));
+}
@@ -0,0 +1,77 @@
+// Ring thread queue tests: QueueMode::RING.
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+
+using namespace dmq;
+using namespace dmq::os;
+
+/// State machine events flow through a RING thread queue in order, with batches 
+/// drained under one lock.
+TEST_CASE(RingEvents)
+{
+    AsyncStateMachine::ThreadOptions options;
+    options.queueMode = QueueMode::RING;
+    options.maxQueueSize = 64;
+    options.maxBatchSize = 8;
+
+    QueueMachine sm;
+    sm.CreateThread("RingEvents", options);
+    sm.CreateEventQueue(1024);
+    for (int i = 0; i < 1000; i++)
+        CHECK(sm.PostEvent<&QueueMachine::Set>(new TestData(i)));
+    CHECK(WaitFor([&]() { return sm.m_count.load() == 1000; }));
+    std::vector<int> order = sm.TakeOrder();
+    bool ordered = order.size() == 1000;
+    for (size_t i = 0; ordered && i < order.size(); i++)
+        ordered = order[i] == int(i);
+    CHECK(ordered);
+}
+
+/// A RING thread serves higher priority messages first.
+TEST_CASE(RingPriority)
+{
+    Thread thread("RingPriority", 16, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", QueueMode::RING);
+    thread.CreateThread();
+
+    HoldThread(thread);
+    auto normal = MakeDelegate(&Receive, thread);
+    auto high = MakeDelegate(&Receive, thread);
+    high.SetPriority(Priority::HIGH);
+    normal(1);
+    normal(2);
+    high(100);
+    high(101);
+    ReleaseThread();
+    CHECK((TakeReceived(4) == std::vector<int>{ 100, 101, 1, 2 }));
+    thread.ExitThread();
+}
+
+/// A ring holds at most maxQueueSize messages. A full ring applies the FullPolicy,
+/// and a ring needs a queue size.
+TEST_CASE(RingFull)
+{
+    Thread drop("RingDrop", 4, FullPolicy::DROP, DEFAULT_DISPATCH_TIMEOUT, "", QueueMode::RING);
+    drop.CreateThread();
+    HoldThread(drop);
+    auto receive = MakeDelegate(&Receive, drop);
+    for (int i = 0; i < 6; i++)
+        receive(i);
+    CHECK(drop.GetQueueSize() == 4);
+    ReleaseThread();
+    CHECK((TakeReceived(4) == std::vector<int>{ 0, 1, 2, 3 }));
+    drop.ExitThread();
+
+    Thread fault("RingFault", 4, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", QueueMode::RING);
+    fault.CreateThread();
+    HoldThread(fault);
+    auto post = MakeDelegate(&Receive, fault);
+    for (int i = 0; i < 4; i++)
+        post(i);
+    CHECK_FAULT(post(4));
+    ReleaseThread();
+    CHECK(TakeReceived(4).size() == 4);
+    fault.ExitThread();
+
+    CHECK_FAULT(Thread("RingUnbounded", 0, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", QueueMode::RING));
+}
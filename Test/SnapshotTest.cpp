@@ -0,0 +1,54 @@
+// Snapshot tests: saving and restoring the state and extended state variables.
+
+#include "TestMachines.h"
+#include "StateSnapshot.h"
+
+/// A snapshot restores the state and the extended state variables.
+TEST_CASE(Snapshot)
+{
+    RecordMachine sm;
+    sm.Set(7);
+    sm.Set(8);
+
+    std::vector<uint64_t> buffer((sm.GetSnapshotSize() + 7) / 8);
+    UINT size = sm.SaveSnapshot(buffer.data(), UINT(buffer.size() * 8));
+    CHECK(size == sm.GetSnapshotSize());
+    CHECK(sm.SaveSnapshot(buffer.data(), 4) == 0);
+
+    RecordMachine restored;
+    CHECK(restored.RestoreSnapshot(buffer.data(), size));
+    CHECK(restored.GetCurrentState() == RecordMachine::ST_RUN);
+    CHECK(restored.m_sum == sm.m_sum);
+    CHECK(restored.m_runs == 2);
+
+    // The restored state machine continues from the snapshot
+    restored.Dispatch(RecordMachine::EV_STOP);
+    CHECK(restored.GetCurrentState() == RecordMachine::ST_IDLE);
+
+    // A truncated or corrupted snapshot is rejected and leaves the state machine 
+    // unchanged. The snapshot size is padded to 8 bytes.
+    RecordMachine rejected;
+    CHECK(!rejected.RestoreSnapshot(buffer.data(), size - 8));
+    std::vector<uint64_t> corrupted(buffer);
+    reinterpret_cast<BYTE*>(corrupted.data())[0] ^= 0xFF;
+    CHECK(!rejected.RestoreSnapshot(corrupted.data(), size));
+    CHECK(rejected.GetCurrentState() == RecordMachine::ST_IDLE && rejected.m_runs == 0);
+}
+
+/// A fleet of state machines saved into and restored from one buffer.
+TEST_CASE(SnapshotFleet)
+{
+    RecordMachine sm, idle;
+    sm.Set(7);
+    StateMachine* const fleet[] = { &sm, &idle };
+    size_t fleetSize = StateSnapshot::GetSize(fleet, 2);
+    std::vector<uint64_t> fleetBuffer((fleetSize + 7) / 8);
+    size_t written = StateSnapshot::Save(fleet, 2, fleetBuffer.data(), fleetBuffer.size() * 8);
+    CHECK(written == fleetSize);
+
+    RecordMachine r1, r2;
+    StateMachine* const restoredFleet[] = { &r1, &r2 };
+    CHECK(StateSnapshot::Restore(restoredFleet, 2, fleetBuffer.data(), written) == 2);
+    CHECK(r1.GetCurrentState() == RecordMachine::ST_RUN && r1.m_sum == sm.m_sum);
+    CHECK(r2.GetCurrentState() == RecordMachine::ST_IDLE && r2.m_runs == 0);
+}
@@ -0,0 +1,157 @@
+// Wide state and event index tests: more than 254 states and 256 events. Built into
+// StateIndexTest with STATE_INDEX_TYPE defined as uint16_t.
+
+#include "StateMachine.h"
+#include "TestHarness.h"
+
+static_assert(sizeof(STATE_INDEX) == 2, "StateIndexTest.cpp requires a 16-bit STATE_INDEX_TYPE");
+static_assert(sizeof(EVENT_INDEX) == 2, "EVENT_INDEX_TYPE defaults to the STATE_INDEX_TYPE width");
+
+// Repeat a state map, transition map or event map entry macro
+#define REPEAT_10(m) m() m() m() m() m() m() m() m() m() m()
+#define REPEAT_100(m) \
+    REPEAT_10(m) REPEAT_10(m) REPEAT_10(m) REPEAT_10(m) REPEAT_10(m) \
+    REPEAT_10(m) REPEAT_10(m) REPEAT_10(m) REPEAT_10(m) REPEAT_10(m)
+
+// A transition map entry to the state following the state at the current 
+// __COUNTER__ position, and a state map entry
+#define ADVANCE_ENTRY() TRANSITION_MAP_ENTRY((__COUNTER__ - BASE + 1) % ST_MAX_STATES)
+#define STEP_ENTRY() STATE_MAP_ENTRY(&Step)
+
+// 300 states sharing one state function. Advance() moves to the next state and 
+// wraps from the last state to the first.
+class WideMachine : public StateMachine
+{
+public:
+    enum { ST_MAX_STATES = 300 };
+
+    WideMachine() : StateMachine(ST_MAX_STATES) {}
+
+    void GoTo(STATE_INDEX state) { ExternalEvent(state); }
+
+    void Advance()
+    {
+        enum { BASE = __COUNTER__ + 1 };
+        BEGIN_TRANSITION_MAP
+            REPEAT_100(ADVANCE_ENTRY) REPEAT_100(ADVANCE_ENTRY) REPEAT_100(ADVANCE_ENTRY)
+        END_TRANSITION_MAP(NULL)
+    }
+
+    STATE_INDEX m_lastState = 0;
+    int m_steps = 0;
+
+private:
+    STATE_DECLARE(WideMachine, Step, NoEventData)
+
+    BEGIN_STATE_MAP
+        REPEAT_100(STEP_ENTRY) REPEAT_100(STEP_ENTRY) REPEAT_100(STEP_ENTRY)
+    END_STATE_MAP
+};
+
+STATE_DEFINE(WideMachine, Step, NoEventData)
+{
+    m_lastState = GetCurrentState();
+    m_steps++;
+}
+
+/// State indexes above 255 are neither truncated nor mistaken for EVENT_IGNORED or
+/// CANNOT_HAPPEN.
+TEST_CASE(WideStates)
+{
+    CHECK(WideMachine::EVENT_IGNORED == 0xFFFE && WideMachine::CANNOT_HAPPEN == 0xFFFF);
+    CHECK(sizeof(TransitionEntry<WideMachine::ST_MAX_STATES>::Type) == 2);
+
+    WideMachine sm;
+    CHECK(sm.GetMaxStates() == 300);
+    sm.GoTo(299);
+    CHECK(sm.GetCurrentState() == 299 && sm.m_lastState == 299);
+    sm.GoTo(255);
+    CHECK(sm.GetCurrentState() == 255);
+    sm.GoTo(254);
+    CHECK(sm.GetCurrentState() == 254 && sm.m_steps == 3);
+
+    // Walk every state through the transition map
+    sm.GoTo(0);
+    bool walked = true;
+    for (int i = 1; i <= WideMachine::ST_MAX_STATES; i++)
+    {
+        sm.Advance();
+        walked = walked && sm.GetCurrentState() == i % WideMachine::ST_MAX_STATES;
+    }
+    CHECK(walked);
+    CHECK(sm.GetCurrentState() == 0);
+}
+
+// Three states and 300 events. Event n transitions to state n % 3.
+class WideEventMachine : public StateMachine
+{
+public:
+    enum { EV_MAX_EVENTS = 300 };
+
+    enum States
+    {
+        ST_A,
+        ST_B,
+        ST_C,
+        ST_MAX_STATES
+    };
+
+    WideEventMachine() : StateMachine(ST_MAX_STATES) {}
+
+    int m_count = 0;
+
+private:
+    STATE_DECLARE(WideEventMachine, Alpha, NoEventData)
+    STATE_DECLARE(WideEventMachine, Beta, NoEventData)
+    STATE_DECLARE(WideEventMachine, Gamma, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Alpha)
+        STATE_MAP_ENTRY(&Beta)
+        STATE_MAP_ENTRY(&Gamma)
+    END_STATE_MAP
+
+    // __COUNTER__ expands once per row, numbering the rows from 0
+    enum { BASE = __COUNTER__ + 1 };
+    #define EVENT_ROW_N(n) \
+        EVENT_MAP_ROW(n) \
+            TRANSITION_MAP_ENTRY((n) % 3) TRANSITION_MAP_ENTRY((n) % 3) TRANSITION_MAP_ENTRY((n) % 3)
+    #define EVENT_ROW() EVENT_ROW_N(__COUNTER__ - BASE)
+
+    BEGIN_EVENT_MAP
+        REPEAT_100(EVENT_ROW) REPEAT_100(EVENT_ROW) REPEAT_100(EVENT_ROW)
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+STATE_DEFINE(WideEventMachine, Alpha, NoEventData) { m_count++; }
+STATE_DEFINE(WideEventMachine, Beta, NoEventData) { m_count++; }
+STATE_DEFINE(WideEventMachine, Gamma, NoEventData) { m_count++; }
+
+/// Event IDs above 255 reach their own event map row through Dispatch() and the
+/// event queue.
+TEST_CASE(WideEvents)
+{
+    WideEventMachine sm;
+    sm.CreateEventQueue(8);
+
+    // 256 and 299 truncated to a byte would select the rows of events 0 and 43
+    const EVENT_INDEX events[] = { 256, 299, 4, 298, 257 };
+    bool dispatched = true;
+    for (EVENT_INDEX event : events)
+    {
+        sm.Dispatch(event);
+        dispatched = dispatched && sm.GetCurrentState() == event % 3;
+    }
+    CHECK(dispatched);
+    CHECK(sm.m_count == 5);
+
+    bool posted = true;
+    for (EVENT_INDEX event : events)
+    {
+        CHECK(sm.PostEvent(event));
+        CHECK(sm.DispatchEvents() == 1);
+        posted = posted && sm.GetCurrentState() == event % 3;
+    }
+    CHECK(posted);
+    CHECK(sm.m_count == 10);
+}
@@ -0,0 +1,14 @@
+// State machine behavior tests. Each test file drives a small state machine through
+// one feature and checks the observable result. Tests that depend on queue contents
+// first hold the state machine thread inside a state, so the events are queued 
+// deterministically before any of them executes.
+//
+// Usage: StateMachineTest [test name]
+// Returns 0 if every test passes.
+
+#include "TestHarness.h"
+
+int main(int argc, char* argv[])
+{
+    return RunTests(argc > 1 ? argv[1] : NULL);
+}
@@ -0,0 +1,109 @@
+// State statistics tests: entry and transition counts, dwell time and CPU time.
+// Built into StateStatsTest with STATE_MACHINE_STATS enabled.
+
+#include "StateMachine.h"
+#include "TestHarness.h"
+
+#if !STATE_MACHINE_STATS
+#error "StatsTest.cpp requires STATE_MACHINE_STATS"
+#endif
+
+// ST_RUN busy-waits for the requested time. The guard of ST_STOP rejects the 
+// transition while m_locked is set.
+class StatsMachine : public StateMachine
+{
+public:
+    enum States
+    {
+        ST_IDLE,
+        ST_RUN,
+        ST_STOP,
+        ST_MAX_STATES
+    };
+
+    StatsMachine() : StateMachine(ST_MAX_STATES) {}
+
+    void GoTo(STATE_INDEX state) { ExternalEvent(state); }
+
+    BOOL m_locked = FALSE;
+    std::chrono::milliseconds m_busy{0};
+
+private:
+    STATE_DECLARE(StatsMachine, Idle, NoEventData)
+    STATE_DECLARE(StatsMachine, Run, NoEventData)
+    STATE_DECLARE(StatsMachine, Stop, NoEventData)
+    GUARD_DECLARE(StatsMachine, GuardStop, NoEventData)
+
+    BEGIN_STATE_MAP_EX
+        STATE_MAP_ENTRY_EX(&Idle)
+        STATE_MAP_ENTRY_EX(&Run)
+        STATE_MAP_ENTRY_ALL_EX(&Stop, &GuardStop, 0, 0)
+    END_STATE_MAP_EX
+};
+
+STATE_DEFINE(StatsMachine, Idle, NoEventData) {}
+
+STATE_DEFINE(StatsMachine, Run, NoEventData)
+{
+    auto end = std::chrono::steady_clock::now() + m_busy;
+    while (std::chrono::steady_clock::now() < end)
+        ;
+}
+
+STATE_DEFINE(StatsMachine, Stop, NoEventData) {}
+
+GUARD_DEFINE(StatsMachine, GuardStop, NoEventData) { return !m_locked; }
+
+const uint64_t MS = 1000000;
+
+/// Entry counts exclude self-transitions, transition counts include them, and a 
+/// rejected guard condition counts neither.
+TEST_CASE(StatsCounts)
+{
+    StatsMachine sm;
+    sm.GoTo(StatsMachine::ST_RUN);
+    sm.GoTo(StatsMachine::ST_RUN);
+    sm.m_locked = TRUE;
+    sm.GoTo(StatsMachine::ST_STOP);
+    sm.m_locked = FALSE;
+    sm.GoTo(StatsMachine::ST_STOP);
+    sm.GoTo(StatsMachine::ST_IDLE);
+    sm.GoTo(StatsMachine::ST_RUN);
+
+    StateMachineStats stats;
+    CHECK(sm.GetStats(stats));
+    CHECK(stats.states.size() == StatsMachine::ST_MAX_STATES);
+    CHECK(stats.states[StatsMachine::ST_IDLE].entryCount == 1);
+    CHECK(stats.states[StatsMachine::ST_RUN].entryCount == 2);
+    CHECK(stats.states[StatsMachine::ST_STOP].entryCount == 1);
+    CHECK(stats.GetTransitionCount(StatsMachine::ST_IDLE, StatsMachine::ST_RUN) == 2);
+    CHECK(stats.GetTransitionCount(StatsMachine::ST_RUN, StatsMachine::ST_RUN) == 1);
+    CHECK(stats.GetTransitionCount(StatsMachine::ST_RUN, StatsMachine::ST_STOP) == 1);
+    CHECK(stats.GetTransitionCount(StatsMachine::ST_STOP, StatsMachine::ST_IDLE) == 1);
+    CHECK(stats.GetTransitionCount(StatsMachine::ST_RUN, StatsMachine::ST_IDLE) == 0);
+}
+
+/// Dwell time covers each completed visit, including the time between events. The
+/// state action CPU time is charged to the target state.
+TEST_CASE(StatsDwell)
+{
+    StatsMachine sm;
+    sm.m_busy = std::chrono::milliseconds(5);
+    sm.GoTo(StatsMachine::ST_RUN);
+    sm.m_busy = std::chrono::milliseconds(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sm.GoTo(StatsMachine::ST_STOP);
+    sm.GoTo(StatsMachine::ST_RUN);
+    sm.GoTo(StatsMachine::ST_STOP);
+
+    StateMachineStats stats;
+    CHECK(sm.GetStats(stats));
+    const StateStatsRecord& run = stats.states[StatsMachine::ST_RUN];
+    CHECK(run.entryCount == 2);
+    CHECK(run.dwellMax >= 25 * MS);
+    CHECK(run.dwellTotal >= run.dwellMax);
+    CHECK(run.cpuTime > 0);
+
+    // The current state has no completed visit
+    CHECK(stats.states[StatsMachine::ST_STOP].dwellTotal < run.dwellMax);
+}
@@ -0,0 +1,37 @@
+// Replaces the DelegateMQ fault handler (port/fault/Fault.cpp) for the tests. A 
+// failed ASSERT throws TestFault so CHECK_FAULT can verify it, instead of waiting
+// for console input and terminating. An ASSERT outside CHECK_FAULT still terminates
+// the test program as an unhandled exception.
+
+#include "TestHarness.h"
+#include "extras/util/Fault.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace dmq::util {
+
+DMQ_NORETURN void FaultHandler(const char* file, unsigned short line)
+{
+    throw TestFault(file, line);
+}
+
+void InstallCrashHandlers()
+{
+}
+
+} // namespace dmq::util
+
+extern "C" DMQ_NORETURN void FaultHandler(const char* file, unsigned short line)
+{
+    dmq::util::FaultHandler(file, line);
+}
+
+extern "C" DMQ_NORETURN void WatchdogHandler(const char* threadName)
+{
+    printf("WatchdogHandler: %s\n", threadName);
+    abort();
+}
+
+extern "C" void InstallCrashHandlers()
+{
+}
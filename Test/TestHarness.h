@@ -0,0 +1,120 @@
+#ifndef _TEST_HARNESS_H
+#define _TEST_HARNESS_H
+
+// A minimal behavior test harness. Each test file defines its tests with TEST_CASE,
+// which registers the test before main() runs, and checks results with CHECK. A
+// failed CHECK is recorded and the test continues. CHECK_FAULT checks that a 
+// statement fails an ASSERT. RunTests() runs the registered tests and prints one
+// PASS/FAIL line per test.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Define and register a test function.
+#define TEST_CASE(name) \
+    static void Test##name(); \
+    static TestRegistrar g_testRegistrar##name(#name, &Test##name); \
+    static void Test##name()
+
+/// Record a failed check without stopping the test.
+#define CHECK(expr) CheckResult((expr), #expr, __FILE__, __LINE__)
+
+/// Check that a statement fails an ASSERT. See TestFault.cpp.
+#define CHECK_FAULT(statement) \
+    do { \
+        bool faulted = false; \
+        try { statement; } \
+        catch (const TestFault&) { faulted = true; } \
+        CheckResult(faulted, "ASSERT in " #statement, __FILE__, __LINE__); \
+    } while (0)
+
+/// @brief Thrown by the test FaultHandler() when an ASSERT fails.
+struct TestFault : std::runtime_error
+{
+    TestFault(const char* file, unsigned short line) :
+        std::runtime_error(std::string(file) + ":" + std::to_string(line)) {}
+};
+
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+/// Get the registered tests, in registration order.
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+/// Get the number of failed checks.
+inline int& GetCheckFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+/// @brief Registers a test at static initialization. Use TEST_CASE.
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*run)())
+    {
+        GetTestCases().push_back({ name, run });
+    }
+};
+
+inline void CheckResult(bool pass, const char* expr, const char* file, int line)
+{
+    if (!pass)
+    {
+        printf("    CHECK failed, %s:%d: %s\n", file, line, expr);
+        GetCheckFailures()++;
+    }
+}
+
+/// Wait until a condition is true, up to 5 seconds.
+/// @return true if the condition became true.
+template <class Pred>
+bool WaitFor(Pred pred)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!pred())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
+
+/// Run the registered tests.
+/// @param[in] filter - run only the test with this name, or NULL to run all tests.
+/// @return 0 if every test passes.
+inline int RunTests(const char* filter = NULL)
+{
+    int failed = 0, run = 0;
+    for (const TestCase& test : GetTestCases())
+    {
+        if (filter && strcmp(filter, test.name) != 0)
+            continue;
+
+        int failures = GetCheckFailures();
+        test.run();
+        bool pass = GetCheckFailures() == failures;
+        printf("%-24s %s\n", test.name, pass ? "PASS" : "FAIL");
+        if (!pass)
+            failed++;
+        run++;
+    }
+
+    printf("%d of %d tests failed\n", failed, run);
+    return (failed == 0 && run > 0) ? 0 : 1;
+}
+
+#endif
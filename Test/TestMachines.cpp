@@ -0,0 +1,175 @@
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+#include <chrono>
+#include <thread>
+
+//----------------------------------------------------------------------------
+// HoldThread
+//----------------------------------------------------------------------------
+static std::atomic<bool> g_hold(false);
+static std::atomic<bool> g_held(false);
+
+static void Hold(int)
+{
+    g_held = true;
+    while (g_hold)
+        std::this_thread::yield();
+}
+
+void HoldThread(dmq::IThread& thread)
+{
+    g_hold = true;
+    g_held = false;
+    dmq::MakeDelegate(&Hold, thread)(0);
+    WaitFor([]() { return g_held.load(); });
+}
+
+void ReleaseThread()
+{
+    g_hold = false;
+}
+
+//----------------------------------------------------------------------------
+// Receive
+//----------------------------------------------------------------------------
+static std::vector<int> g_received;
+static std::atomic<size_t> g_receivedCount(0);
+
+void Receive(int value)
+{
+    g_received.push_back(value);
+    g_receivedCount++;
+}
+
+std::vector<int> TakeReceived(size_t count)
+{
+    WaitFor([count]() { return g_receivedCount.load() >= count; });
+    std::vector<int> received;
+    received.swap(g_received);
+    g_receivedCount = 0;
+    return received;
+}
+
+//----------------------------------------------------------------------------
+// QueueMachine
+//----------------------------------------------------------------------------
+void QueueMachine::Set(TestData* data)
+{
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_HALT
+    END_TRANSITION_MAP(data)
+}
+
+void QueueMachine::Halt()
+{
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_HALT)                   // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_HALT)                   // ST_RUN
+        TRANSITION_MAP_ENTRY(ST_HALT)                   // ST_HALT
+    END_TRANSITION_MAP(NULL)
+}
+
+void QueueMachine::SetLatest(const TestData* data)
+{
+    ASYNC_INVOKE_LATEST(QueueMachine, SetLatest, data);
+
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_HALT
+    END_TRANSITION_MAP(data)
+}
+
+void QueueMachine::SetQueued(const TestData* data)
+{
+    ASYNC_INVOKE_QUEUED(QueueMachine, SetQueued, data);
+
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+        TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_HALT
+    END_TRANSITION_MAP(data)
+}
+
+void QueueMachine::Hold()
+{
+    m_hold = true;
+    m_held = false;
+    PostEvent<&QueueMachine::Set>(new TestData(HOLD));
+    WaitFor([this]() { return m_held.load(); });
+}
+
+std::vector<int> QueueMachine::Release(size_t count)
+{
+    m_hold = false;
+    WaitFor([this, count]() { return m_count.load() >= count; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return TakeOrder();
+}
+
+std::vector<int> QueueMachine::TakeOrder()
+{
+    std::vector<int> order;
+    order.swap(m_order);
+    m_count = 0;
+    return order;
+}
+
+STATE_DEFINE(QueueMachine, Idle, NoEventData)
+{
+}
+
+STATE_DEFINE(QueueMachine, Run, TestData)
+{
+    if (data->value == HOLD)
+    {
+        m_held = true;
+        while (m_hold)
+            std::this_thread::yield();
+        return;
+    }
+    m_order.push_back(data->value);
+    m_count++;
+}
+
+STATE_DEFINE(QueueMachine, Halted, NoEventData)
+{
+    m_order.push_back(HALTED);
+    m_count++;
+}
+
+//----------------------------------------------------------------------------
+// RecordMachine
+//----------------------------------------------------------------------------
+RecordMachine::RecordMachine() : StateMachine(ST_MAX_STATES)
+{
+    RegisterSnapshotVariable(m_sum);
+    RegisterSnapshotVariable(m_runs);
+}
+
+void RecordMachine::Reset()
+{
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_RUN
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_STOP
+    END_TRANSITION_MAP(NULL)
+}
+
+STATE_DEFINE(RecordMachine, Idle, NoEventData)
+{
+}
+
+STATE_DEFINE(RecordMachine, Run, TestData)
+{
+    m_sum = m_sum * 31 + data->value;
+    m_runs++;
+}
+
+STATE_DEFINE(RecordMachine, Stop, NoEventData)
+{
+    m_stops++;
+    InternalEvent(ST_IDLE);
+}
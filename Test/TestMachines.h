@@ -0,0 +1,189 @@
+#ifndef _TEST_MACHINES_H
+#define _TEST_MACHINES_H
+
+// State machines shared by the behavior tests.
+
+#include "AsyncStateMachine.h"
+#include "TestHarness.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Calls StateTimerWheel::ProcessTimers() on its own thread, as main() does
+class TimerDriver
+{
+public:
+    TimerDriver() : m_thread([this]() {
+        while (!m_exit)
+        {
+            StateTimerWheel::ProcessTimers();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }) {}
+
+    ~TimerDriver()
+    {
+        m_exit = true;
+        m_thread.join();
+    }
+
+private:
+    std::atomic<bool> m_exit{false};
+    std::thread m_thread;
+};
+
+/// Hold a thread inside a message until ReleaseThread(), so a test can fill its 
+/// queues before any queued message executes.
+void HoldThread(dmq::IThread& thread);
+
+/// Let the thread held by HoldThread() continue.
+void ReleaseThread();
+
+/// Record a value, as the target of delegates sent to a thread under test. One
+/// receiving thread at a time.
+void Receive(int value);
+
+/// Wait for a number of received values, then clear them.
+/// @return The received values, in receive order.
+std::vector<int> TakeReceived(size_t count);
+
+class TestData : public EventData
+{
+public:
+    TestData() = default;
+    explicit TestData(int v) : value(v) {}
+
+    int value = 0;
+
+    virtual UINT Serialize(void* buffer) const override
+    {
+        if (buffer)
+            memcpy(buffer, &value, sizeof(value));
+        return sizeof(value);
+    }
+
+    virtual BOOL Deserialize(const void* buffer, UINT size) override
+    {
+        if (size != sizeof(value))
+            return FALSE;
+        memcpy(&value, buffer, sizeof(value));
+        return TRUE;
+    }
+};
+
+// Records the value of each executed event. A HOLD event parks the state machine
+// thread inside ST_Run until Release(), so a test can fill the event queue before 
+// any of the queued events executes.
+class QueueMachine : public AsyncStateMachine
+{
+public:
+    enum { HOLD = -1, HALTED = 1000 };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_RUN,
+        ST_HALT,
+        ST_MAX_STATES
+    };
+
+    QueueMachine() : AsyncStateMachine(ST_MAX_STATES) {}
+
+    // External events, posted by the tests using PostEvent() and its variants
+    void Set(TestData* data);
+    void Halt();
+
+    // External events using ASYNC_INVOKE_LATEST and ASYNC_INVOKE_QUEUED
+    void SetLatest(const TestData* data);
+    void SetQueued(const TestData* data);
+
+    /// Post a HOLD event and wait until the state machine thread executes it.
+    void Hold();
+
+    /// Let the held thread continue, then wait for a number of recorded events.
+    /// @return The recorded values, in execution order.
+    std::vector<int> Release(size_t count);
+
+    /// Get the recorded values and clear them. Call while the thread is idle.
+    std::vector<int> TakeOrder();
+
+    std::atomic<size_t> m_count{0};
+
+private:
+    std::atomic<bool> m_hold{false};
+    std::atomic<bool> m_held{false};
+    std::vector<int> m_order;
+
+    STATE_DECLARE(QueueMachine, Idle, NoEventData)
+    STATE_DECLARE(QueueMachine, Run, TestData)
+    STATE_DECLARE(QueueMachine, Halted, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&Run)
+        STATE_MAP_ENTRY(&Halted)
+    END_STATE_MAP
+};
+
+// A synchronous state machine generating events by ID. The extended state variables
+// are registered for snapshots.
+class RecordMachine : public StateMachine
+{
+public:
+    enum Events
+    {
+        EV_SET,
+        EV_STOP,
+        EV_MAX_EVENTS
+    };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_RUN,
+        ST_STOP,
+        ST_MAX_STATES
+    };
+
+    RecordMachine();
+
+    // External event without an event ID
+    void Reset();
+
+    /// Dispatch EV_SET with a value.
+    void Set(int value)
+    {
+        TestData data(value);
+        Dispatch(EV_SET, &data);
+    }
+
+    int64_t m_sum = 0;
+    int m_runs = 0;
+    int m_stops = 0;
+
+private:
+    STATE_DECLARE(RecordMachine, Idle, NoEventData)
+    STATE_DECLARE(RecordMachine, Run, TestData)
+    STATE_DECLARE(RecordMachine, Stop, NoEventData)
+
+    BEGIN_STATE_MAP
+        STATE_MAP_ENTRY(&Idle)
+        STATE_MAP_ENTRY(&Run)
+        STATE_MAP_ENTRY(&Stop)
+    END_STATE_MAP
+
+    BEGIN_EVENT_MAP
+        EVENT_MAP_ROW(EV_SET)
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_RUN)                    // ST_RUN
+            TRANSITION_MAP_ENTRY(CANNOT_HAPPEN)             // ST_STOP
+        EVENT_MAP_ROW(EV_STOP)
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+            TRANSITION_MAP_ENTRY(ST_STOP)                   // ST_RUN
+            TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_STOP
+    END_EVENT_MAP(EV_MAX_EVENTS)
+};
+
+#endif
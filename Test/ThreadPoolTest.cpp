@@ -0,0 +1,208 @@
+// Work-stealing thread pool tests: strand ordering, mutual exclusion and stealing.
+
+#include "TestHarness.h"
+#include "DelegateMQ.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+
+using namespace dmq;
+using namespace dmq::os;
+
+// Records the values invoked on one strand and detects concurrent invocations
+class StrandRecorder
+{
+public:
+    void Record(int value)
+    {
+        if (m_active.fetch_add(1) != 0)
+            m_overlapped = true;
+        m_values.push_back(value);
+        {
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            m_threads.insert(std::this_thread::get_id());
+        }
+        m_active.fetch_sub(1);
+        m_count++;
+    }
+
+    /// @return true if the values were invoked in order, one at a time.
+    bool IsSerial(int count) const
+    {
+        if (m_overlapped || m_values.size() != size_t(count))
+            return false;
+        for (int i = 0; i < count; i++)
+        {
+            if (m_values[i] != i)
+                return false;
+        }
+        return true;
+    }
+
+    std::atomic<int> m_count{0};
+    std::vector<int> m_values;
+    std::set<std::thread::id> m_threads;
+    std::mutex m_threadsMutex;
+
+private:
+    std::atomic<int> m_active{0};
+    std::atomic<bool> m_overlapped{false};
+};
+
+/// Each strand invokes its delegates in FIFO order and never concurrently, while 
+/// the strands together spread over the workers.
+TEST_CASE(StrandSerialOrder)
+{
+    ThreadPool pool("StrandOrder", 4);
+    CHECK(pool.CreateThreads());
+
+    const int STRANDS = 16, COUNT = 2000;
+    std::vector<std::shared_ptr<Strand>> strands;
+    std::vector<StrandRecorder> recorders(STRANDS);
+    for (int s = 0; s < STRANDS; s++)
+        strands.push_back(pool.CreateStrand());
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        for (int s = 0; s < STRANDS; s++)
+            MakeDelegate(&recorders[s], &StrandRecorder::Record, *strands[s])(i);
+    }
+
+    CHECK(WaitFor([&]() {
+        for (auto& recorder : recorders)
+        {
+            if (recorder.m_count.load() != COUNT)
+                return false;
+        }
+        return true;
+    }));
+
+    std::set<std::thread::id> workers;
+    bool serial = true;
+    for (auto& recorder : recorders)
+    {
+        serial = serial && recorder.IsSerial(COUNT);
+        workers.insert(recorder.m_threads.begin(), recorder.m_threads.end());
+    }
+    CHECK(serial);
+    CHECK(workers.size() > 1);
+    CHECK(workers.size() <= pool.GetThreadCount());
+    pool.ExitThreads();
+}
+
+static std::atomic<bool> g_blockWorker(false);
+static std::atomic<bool> g_workerBlocked(false);
+static std::thread::id g_blockedWorker;
+static std::vector<std::shared_ptr<Strand>>* g_stealStrands = nullptr;
+static std::vector<StrandRecorder>* g_stealRecorders = nullptr;
+
+// Schedules the strands from a worker, so they queue on that worker, then blocks it.
+// Delegate pointer arguments are copied, so the strands are passed in globals.
+static void ScheduleAndBlock(int)
+{
+    g_blockedWorker = std::this_thread::get_id();
+    for (size_t s = 0; s < g_stealStrands->size(); s++)
+        MakeDelegate(&(*g_stealRecorders)[s], &StrandRecorder::Record, *(*g_stealStrands)[s])(0);
+
+    g_workerBlocked = true;
+    while (g_blockWorker)
+        std::this_thread::yield();
+}
+
+/// Strands queued on a busy worker are stolen and run by the other workers.
+TEST_CASE(StrandWorkStealing)
+{
+    ThreadPool pool("StrandSteal", 4);
+    CHECK(pool.CreateThreads());
+
+    const size_t STRANDS = 8;
+    auto blocker = pool.CreateStrand();
+    std::vector<std::shared_ptr<Strand>> strands;
+    std::vector<StrandRecorder> recorders(STRANDS);
+    for (size_t s = 0; s < STRANDS; s++)
+        strands.push_back(pool.CreateStrand());
+
+    g_blockWorker = true;
+    g_workerBlocked = false;
+    g_stealStrands = &strands;
+    g_stealRecorders = &recorders;
+    MakeDelegate(&ScheduleAndBlock, *blocker)(0);
+
+    // Every strand runs while its own worker is still blocked
+    CHECK(WaitFor([&]() {
+        for (auto& recorder : recorders)
+        {
+            if (recorder.m_count.load() != 1)
+                return false;
+        }
+        return true;
+    }));
+    CHECK(g_workerBlocked.load());
+
+    bool stolen = true;
+    for (auto& recorder : recorders)
+        stolen = stolen && recorder.m_threads.count(g_blockedWorker) == 0;
+    CHECK(stolen);
+
+    g_blockWorker = false;
+    pool.ExitThreads();
+}
+
+/// Many producers dispatching to strands that reschedule themselves at full load.
+/// Every delegate runs once, in order, and the idle workers park afterwards.
+TEST_CASE(StrandStress)
+{
+    ThreadPool pool("StrandStress", 4);
+    CHECK(pool.CreateThreads());
+
+    const int STRANDS = 64, COUNT = 1000, PRODUCERS = 4;
+    std::vector<std::shared_ptr<Strand>> strands;
+    std::vector<StrandRecorder> recorders(STRANDS);
+    for (int s = 0; s < STRANDS; s++)
+        strands.push_back(pool.CreateStrand());
+
+    // Each producer owns a disjoint set of strands so per strand order is defined
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < COUNT; i++)
+            {
+                for (int s = p; s < STRANDS; s += PRODUCERS)
+                    MakeDelegate(&recorders[s], &StrandRecorder::Record, *strands[s])(i);
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& producer : producers)
+        producer.join();
+
+    CHECK(WaitFor([&]() {
+        for (auto& recorder : recorders)
+        {
+            if (recorder.m_count.load() != COUNT)
+                return false;
+        }
+        return true;
+    }));
+
+    bool serial = true;
+    for (auto& recorder : recorders)
+        serial = serial && recorder.IsSerial(COUNT);
+    CHECK(serial);
+
+    // A drained pool still runs new work
+    for (int s = 0; s < STRANDS; s++)
+        MakeDelegate(&recorders[s], &StrandRecorder::Record, *strands[s])(COUNT);
+    CHECK(WaitFor([&]() {
+        for (auto& recorder : recorders)
+        {
+            if (recorder.m_count.load() != COUNT + 1)
+                return false;
+        }
+        return true;
+    }));
+    pool.ExitThreads();
+}
@@ -0,0 +1,258 @@
+// State timeout tests: expiry, cancellation, stale expiries and a full thread queue.
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+#include <chrono>
+#include <thread>
+
+using namespace dmq;
+
+// ST_WAIT times out into ST_EXPIRED after TIMEOUT milliseconds
+class TimeoutMachine : public AsyncStateMachine
+{
+public:
+    enum { TIMEOUT = 20 };
+
+    enum States
+    {
+        ST_IDLE,
+        ST_WAIT,
+        ST_EXPIRED,
+        ST_MAX_STATES
+    };
+
+    TimeoutMachine() : AsyncStateMachine(ST_MAX_STATES) {}
+
+    void Start();
+    void Stop();
+
+    std::atomic<int> m_waits{0};
+    std::atomic<int> m_expired{0};
+    std::chrono::steady_clock::time_point m_expiredTime;
+
+private:
+    STATE_DECLARE(TimeoutMachine, Idle, NoEventData)
+    STATE_DECLARE(TimeoutMachine, Wait, NoEventData)
+    STATE_DECLARE(TimeoutMachine, Expired, NoEventData)
+
+    BEGIN_STATE_MAP_EX
+        STATE_MAP_ENTRY_EX(&Idle)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&Wait, 0, 0, 0, TIMEOUT, ST_EXPIRED)
+        STATE_MAP_ENTRY_EX(&Expired)
+    END_STATE_MAP_EX
+};
+
+void TimeoutMachine::Start()
+{
+    ASYNC_INVOKE(TimeoutMachine, Start);
+
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(ST_WAIT)                   // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_WAIT)                   // ST_WAIT
+        TRANSITION_MAP_ENTRY(ST_WAIT)                   // ST_EXPIRED
+    END_TRANSITION_MAP(NULL)
+}
+
+void TimeoutMachine::Stop()
+{
+    ASYNC_INVOKE(TimeoutMachine, Stop);
+
+    BEGIN_TRANSITION_MAP                                // - Current State -
+        TRANSITION_MAP_ENTRY(EVENT_IGNORED)             // ST_IDLE
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_WAIT
+        TRANSITION_MAP_ENTRY(ST_IDLE)                   // ST_EXPIRED
+    END_TRANSITION_MAP(NULL)
+}
+
+STATE_DEFINE(TimeoutMachine, Idle, NoEventData)
+{
+}
+
+STATE_DEFINE(TimeoutMachine, Wait, NoEventData)
+{
+    m_waits++;
+}
+
+STATE_DEFINE(TimeoutMachine, Expired, NoEventData)
+{
+    m_expiredTime = std::chrono::steady_clock::now();
+    m_expired++;
+}
+
+// A synchronous state machine with a timeout state and no event queue
+class UnqueuedTimeoutMachine : public StateMachine
+{
+public:
+    enum States
+    {
+        ST_IDLE,
+        ST_WAIT,
+        ST_MAX_STATES
+    };
+
+    UnqueuedTimeoutMachine() : StateMachine(ST_MAX_STATES) {}
+
+    void Start() { ExternalEvent(ST_WAIT); }
+
+private:
+    STATE_DECLARE(UnqueuedTimeoutMachine, Idle, NoEventData)
+    STATE_DECLARE(UnqueuedTimeoutMachine, Wait, NoEventData)
+
+    BEGIN_STATE_MAP_EX
+        STATE_MAP_ENTRY_EX(&Idle)
+        STATE_MAP_ENTRY_TIMEOUT_EX(&Wait, 0, 0, 0, 10, ST_IDLE)
+    END_STATE_MAP_EX
+};
+
+STATE_DEFINE(UnqueuedTimeoutMachine, Idle, NoEventData)
+{
+}
+
+STATE_DEFINE(UnqueuedTimeoutMachine, Wait, NoEventData)
+{
+}
+
+// Delegates copy pointer arguments, so the blocked machine and its actions are globals
+static TimeoutMachine* g_blocked = nullptr;
+static std::atomic<bool> g_release{false};
+static std::atomic<bool> g_blocking{false};
+static std::chrono::steady_clock::time_point g_restartTime;
+
+enum BlockAction { BLOCK_ONLY, BLOCK_THEN_IDLE, BLOCK_THEN_RESTART };
+
+/// Occupy the state machine thread until g_release, while the timeout expires, then
+/// run an event inline before the expiry reaches the state machine.
+static void BlockThread(int action)
+{
+    g_blocking = true;
+    while (!g_release)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    if (action == BLOCK_THEN_IDLE)
+        g_blocked->Stop();
+    else if (action == BLOCK_THEN_RESTART)
+    {
+        g_restartTime = std::chrono::steady_clock::now();
+        g_blocked->Start();
+    }
+    g_blocking = false;
+}
+
+static void Nop()
+{
+}
+
+/// Hold the state machine thread until its timeout has expired, then run action.
+static void BlockPastTimeout(TimeoutMachine& sm, BlockAction action)
+{
+    g_blocked = &sm;
+    g_release = false;
+    MakeDelegate(&BlockThread, *sm.GetThread())(action);
+    WaitFor([]() { return g_blocking.load(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMachine::TIMEOUT * 3));
+    g_release = true;
+    WaitFor([]() { return !g_blocking.load(); });
+}
+
+/// A timeout started on entry expires into the timeout state.
+TEST_CASE(TimeoutExpires)
+{
+    TimerDriver timers;
+    TimeoutMachine sm;
+    sm.CreateThread("TimeoutExpires");
+    sm.CreateEventQueue(4);
+
+    auto start = std::chrono::steady_clock::now();
+    sm.Start();
+    CHECK(WaitFor([&sm]() { return sm.m_expired.load() == 1; }));
+    CHECK(sm.m_expiredTime - start >= std::chrono::milliseconds(TimeoutMachine::TIMEOUT - 1));
+    CHECK(sm.GetCurrentState() == TimeoutMachine::ST_EXPIRED);
+}
+
+/// Leaving the state stops the timeout.
+TEST_CASE(TimeoutCancelled)
+{
+    TimerDriver timers;
+    TimeoutMachine sm;
+    sm.CreateThread("TimeoutCancelled");
+    sm.CreateEventQueue(4);
+
+    sm.Start();
+    sm.Stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMachine::TIMEOUT * 3));
+    CHECK(sm.m_waits == 1);
+    CHECK(sm.m_expired == 0);
+}
+
+/// An expiry queued before the state machine left the state, or restarted the 
+/// timeout, is discarded.
+TEST_CASE(TimeoutStale)
+{
+    TimerDriver timers;
+    TimeoutMachine sm;
+    sm.CreateThread("TimeoutStale");
+    sm.CreateEventQueue(4);
+
+    sm.Start();
+    WaitFor([&sm]() { return sm.m_waits.load() == 1; });
+    BlockPastTimeout(sm, BLOCK_THEN_IDLE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMachine::TIMEOUT * 3));
+    CHECK(sm.m_expired == 0);
+    CHECK(sm.GetCurrentState() == TimeoutMachine::ST_IDLE);
+
+    // The restarted timeout expires a full timeout after the restart
+    sm.Start();
+    WaitFor([&sm]() { return sm.m_waits.load() == 2; });
+    BlockPastTimeout(sm, BLOCK_THEN_RESTART);
+    CHECK(WaitFor([&sm]() { return sm.m_expired.load() == 1; }));
+    CHECK(sm.m_expiredTime - g_restartTime >= std::chrono::milliseconds(TimeoutMachine::TIMEOUT - 1));
+}
+
+/// An expiry never waits on a full thread queue. Other timeouts still expire, the 
+/// state machine thread may stop the timeout, and the expiry is retried until the
+/// thread accepts it.
+TEST_CASE(TimeoutQueueFull)
+{
+    TimerDriver timers;
+    TimeoutMachine sm, other;
+    sm.CreateThread("TimeoutFull", dmq::os::QueueMode::MUTEX, 2);
+    sm.CreateEventQueue(4);
+    other.CreateThread("TimeoutOther");
+    other.CreateEventQueue(4);
+
+    // Stop the timeout while the expiry cannot reach the full thread queue
+    sm.Start();
+    WaitFor([&sm]() { return sm.m_waits.load() == 1; });
+    g_blocked = &sm;
+    g_release = false;
+    MakeDelegate(&BlockThread, *sm.GetThread())(BLOCK_THEN_IDLE);
+    WaitFor([]() { return g_blocking.load(); });
+    MakeDelegate(&Nop, *sm.GetThread())();
+    MakeDelegate(&Nop, *sm.GetThread())();
+    other.Start();
+    CHECK(WaitFor([&other]() { return other.m_expired.load() == 1; }));
+    g_release = true;
+    CHECK(WaitFor([]() { return !g_blocking.load(); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMachine::TIMEOUT * 3));
+    CHECK(sm.m_expired == 0);
+
+    // Deliver the expiry once the thread queue drains
+    sm.Start();
+    WaitFor([&sm]() { return sm.m_waits.load() == 2; });
+    g_release = false;
+    MakeDelegate(&BlockThread, *sm.GetThread())(BLOCK_ONLY);
+    WaitFor([]() { return g_blocking.load(); });
+    MakeDelegate(&Nop, *sm.GetThread())();
+    MakeDelegate(&Nop, *sm.GetThread())();
+    std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMachine::TIMEOUT * 3));
+    CHECK(sm.m_expired == 0);
+    g_release = true;
+    CHECK(WaitFor([&sm]() { return sm.m_expired.load() == 1; }));
+}
+
+/// Entering a timeout state without an event queue fails an ASSERT.
+TEST_CASE(TimeoutNeedsQueue)
+{
+    UnqueuedTimeoutMachine sm;
+    CHECK_FAULT(sm.Start());
+}
@@ -0,0 +1,82 @@
+// Transition trace tests: the ring keeps the most recent transitions, oldest first.
+
+#include "TestMachines.h"
+
+// Alternates between two states. The guard of ST_B rejects negative values.
+class TraceMachine : public StateMachine
+{
+public:
+    enum States
+    {
+        ST_A,
+        ST_B,
+        ST_MAX_STATES
+    };
+
+    TraceMachine() : StateMachine(ST_MAX_STATES) {}
+
+    void GoTo(STATE_INDEX state, const TestData* data) { ExternalEvent(state, data); }
+
+private:
+    STATE_DECLARE(TraceMachine, Alpha, TestData)
+    STATE_DECLARE(TraceMachine, Beta, TestData)
+    GUARD_DECLARE(TraceMachine, GuardBeta, TestData)
+
+    BEGIN_STATE_MAP_EX
+        STATE_MAP_ENTRY_EX(&Alpha)
+        STATE_MAP_ENTRY_ALL_EX(&Beta, &GuardBeta, 0, 0)
+    END_STATE_MAP_EX
+};
+
+STATE_DEFINE(TraceMachine, Alpha, TestData) {}
+STATE_DEFINE(TraceMachine, Beta, TestData) {}
+GUARD_DEFINE(TraceMachine, GuardBeta, TestData) { return data->value >= 0; }
+
+/// After more transitions than the trace depth, the trace holds the last DEPTH 
+/// transitions, oldest first.
+TEST_CASE(TraceWraparound)
+{
+    TraceMachine sm;
+    StateTraceRecord records[StateTrace::DEPTH * 2];
+    CHECK(sm.GetTrace(records, StateTrace::DEPTH * 2) == 0);
+
+    // Transition i goes to ST_B for odd i and to ST_A for even i
+    const UINT total = StateTrace::DEPTH * 3 + 5;
+    for (UINT i = 0; i < total; i++)
+        sm.GoTo(i % 2 ? TraceMachine::ST_B : TraceMachine::ST_A, new TestData(int(i)));
+
+    UINT count = sm.GetTrace(records, StateTrace::DEPTH * 2);
+    CHECK(count == StateTrace::DEPTH);
+
+    bool ordered = true;
+    for (UINT i = 0; i < count; i++)
+    {
+        UINT transition = total - count + i;
+        STATE_INDEX to = transition % 2 ? TraceMachine::ST_B : TraceMachine::ST_A;
+        STATE_INDEX from = transition % 2 ? TraceMachine::ST_A : TraceMachine::ST_B;
+        ordered = ordered && records[i].toState == to && records[i].fromState == from &&
+            records[i].guardResult == TRUE && records[i].dataType == &typeid(TestData);
+        if (i > 0)
+            ordered = ordered && records[i].timestamp >= records[i - 1].timestamp;
+    }
+    CHECK(ordered);
+
+    // A smaller destination gets the most recent records
+    StateTraceRecord recent[3];
+    CHECK(sm.GetTrace(recent, 3) == 3);
+    CHECK(recent[2].timestamp == records[count - 1].timestamp);
+    CHECK(recent[0].timestamp == records[count - 3].timestamp);
+}
+
+/// A rejected guard condition is recorded with a FALSE guard result.
+TEST_CASE(TraceGuardResult)
+{
+    TraceMachine sm;
+    sm.GoTo(TraceMachine::ST_B, new TestData(-1));
+    CHECK(sm.GetCurrentState() == TraceMachine::ST_A);
+
+    StateTraceRecord records[StateTrace::DEPTH];
+    CHECK(sm.GetTrace(records, StateTrace::DEPTH) == 1);
+    CHECK(records[0].fromState == TraceMachine::ST_A && records[0].toState == TraceMachine::ST_B);
+    CHECK(records[0].guardResult == FALSE);
+}
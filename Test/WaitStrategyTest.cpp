@@ -0,0 +1,103 @@
+// Wait strategy tests: Thread::SetWaitStrategy().
+
+#include "TestMachines.h"
+#include "DelegateMQ.h"
+
+using namespace dmq;
+using namespace dmq::os;
+
+static const QueueMode MODES[] = { QueueMode::MUTEX, QueueMode::LOCK_FREE, QueueMode::RING };
+
+/// Post one message at a time, each after the previous message is received and an 
+/// optional pause, so the thread is in the same wait phase at every post.
+/// @return true if every message is received, in order.
+static bool PostEach(Thread& thread, int count, std::chrono::milliseconds pause)
+{
+    auto receive = MakeDelegate(&Receive, thread);
+    for (int i = 0; i < count; i++)
+    {
+        std::this_thread::sleep_for(pause);
+        receive(i);
+        std::vector<int> received = TakeReceived(1);
+        if (received.size() != 1 || received[0] != i)
+            return false;
+    }
+    return true;
+}
+
+/// A message posted while the thread spins is received.
+TEST_CASE(WaitSpin)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("WaitSpin", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.SetWaitStrategy(200000, 0);
+        thread.CreateThread();
+        CHECK(PostEach(thread, 1000, std::chrono::milliseconds(0)));
+        thread.ExitThread();
+    }
+}
+
+/// A message posted while the thread yields is received.
+TEST_CASE(WaitYield)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("WaitYield", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.SetWaitStrategy(0, 20000);
+        thread.CreateThread();
+        CHECK(PostEach(thread, 1000, std::chrono::milliseconds(0)));
+        thread.ExitThread();
+    }
+}
+
+/// A message posted after the thread spins, yields and parks wakes the thread.
+TEST_CASE(WaitPark)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("WaitPark", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.SetWaitStrategy(100, 10);
+        thread.CreateThread();
+        CHECK(PostEach(thread, 20, std::chrono::milliseconds(5)));
+        thread.ExitThread();
+    }
+}
+
+/// ExitThread() stops a spinning thread without a message to wake it.
+TEST_CASE(WaitSpinExit)
+{
+    for (QueueMode mode : MODES)
+    {
+        Thread thread("WaitSpinExit", 32, FullPolicy::FAULT, DEFAULT_DISPATCH_TIMEOUT, "", mode);
+        thread.SetWaitStrategy(1000000000, 0);
+        thread.CreateThread();
+        CHECK(PostEach(thread, 1, std::chrono::milliseconds(0)));
+
+        auto start = std::chrono::steady_clock::now();
+        thread.ExitThread();
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+    }
+}
+
+/// ThreadOptions passes the wait strategy to a state machine thread.
+TEST_CASE(WaitStateMachine)
+{
+    AsyncStateMachine::ThreadOptions options;
+    options.spinCount = 200000;
+    options.yieldCount = 100;
+
+    QueueMachine sm;
+    sm.CreateThread("WaitStateMachine", options);
+    sm.CreateEventQueue(16);
+    for (int i = 0; i < 100; i++)
+    {
+        CHECK(sm.PostEvent<&QueueMachine::Set>(new TestData(i)));
+        CHECK(WaitFor([&]() { return sm.m_count.load() == size_t(i + 1); }));
+    }
+    std::vector<int> order = sm.TakeOrder();
+    bool ordered = order.size() == 100;
+    for (size_t i = 0; ordered && i < order.size(); i++)
+        ordered = order[i] == int(i);
+    CHECK(ordered);
+}
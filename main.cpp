@@ -37,6 +37,7 @@
 #include <iostream>
 #include "DataTypes.h"
 #include "Motor.h"
+#include "StaticMotor.h"
 #include <atomic>
 #include <chrono>
 
@@ -59,6 +60,10 @@ static void ProcessTimers()
 	{
 		// Process all delegate-based timers
 		dmq::util::Timer::ProcessTimers();
+
+		// Process all state machine state timeouts
+		StateTimerWheel::ProcessTimers();
+
 		std::this_thread::sleep_for(std::chrono::microseconds(50));
 	}
 }
@@ -93,6 +98,20 @@ int main(void)
 		// Create the worker thread
 		userInterfaceThread.CreateThread();
 
+		// *** Begin static Motor test ***
+		// StaticMotor executes each event synchronously on this thread
+		StaticMotor staticMotor;
+
+		MotorData staticData;
+		staticData.speed = 100;
+		staticMotor.SetSpeed(&staticData);
+
+		staticData.speed = 200;
+		staticMotor.SetSpeed(&staticData);
+
+		staticMotor.Halt();
+		// *** End static Motor test ***
+
 		// *** Begin async Motor test ***
 		Motor motor;
 
@@ -100,10 +119,12 @@ int main(void)
 		data->speed = 100;
 		motor.SetSpeed(data);
 
+		// SetSpeed() coalesces. If speed 100 is still queued, 200 replaces it.
 		data = new MotorData();
 		data->speed = 200;
 		motor.SetSpeed(data);
 
+		// Halt() discards any speed change still queued
 		motor.Halt();
 		// *** End async Motor test ***
 